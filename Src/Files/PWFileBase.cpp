@@ -10,6 +10,8 @@
 #include "PWFileBase.h"
 #include "../OS/PWOs.h"
 
+#include <filesystem>
+
 namespace pw {
 
 	CFileBase::~CFileBase() {}
@@ -158,6 +160,51 @@ namespace pw {
 #endif	// #ifdef PW_WINDOWS
 	}
 
+	/**
+	 * Determines whether two paths name the same existing file, following links and resolving relative paths.
+	 *
+	 * \param _pcPathA The first path.
+	 * \param _pcPathB The second path.
+	 * \return Returns true if both paths exist and name the same file.
+	 */
+	bool CFileBase::IsSameFile( const char16_t * _pcPathA, const char16_t * _pcPathB ) {
+		try {
+			std::error_code ecError;
+			return std::filesystem::equivalent( std::filesystem::path( std::u16string( _pcPathA ) ), std::filesystem::path( std::u16string( _pcPathB ) ), ecError ) && !ecError;
+		}
+		catch ( ... ) { return false; }
+	}
+
+	/**
+	 * Deletes a file.  The path is given in UTF-8.
+	 *
+	 * \param _pcPath The path of the file to delete.
+	 * \return Returns true if the file was deleted.
+	 */
+	bool CFileBase::RemoveFile( const char8_t * _pcPath ) {
+		try {
+			std::error_code ecError;
+			return std::filesystem::remove( std::filesystem::path( std::u8string( _pcPath ) ), ecError ) && !ecError;
+		}
+		catch ( ... ) { return false; }
+	}
+
+	/**
+	 * Gets the time at which a file was last written.  The path is given in UTF-8.  The value is only meant to be compared with
+	 *	another returned by this function.
+	 *
+	 * \param _pcPath The path of the file.
+	 * \return Returns the time at which the file was last written, or 0 if it could not be read.
+	 */
+	int64_t CFileBase::LastWriteTime( const char8_t * _pcPath ) {
+		try {
+			std::error_code ecError;
+			auto ftTime = std::filesystem::last_write_time( std::filesystem::path( std::u8string( _pcPath ) ), ecError );
+			return ecError ? 0 : int64_t( ftTime.time_since_epoch().count() );
+		}
+		catch ( ... ) { return 0; }
+	}
+
 	/**
 	 * Compares the extention from a given file path to a given extension string.
 	 * 
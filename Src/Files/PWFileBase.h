@@ -108,6 +108,32 @@ namespace pw {
 		 **/
 		static std::vector<std::u16string> &				FindFiles( const char16_t * _pcFolderPath, const char16_t * _pcSearchString, bool _bIncludeFolders, std::vector<std::u16string> &_vResult );
 
+		/**
+		 * Determines whether two paths name the same existing file, following links and resolving relative paths.
+		 *
+		 * \param _pcPathA The first path.
+		 * \param _pcPathB The second path.
+		 * \return Returns true if both paths exist and name the same file.
+		 */
+		static bool											IsSameFile( const char16_t * _pcPathA, const char16_t * _pcPathB );
+
+		/**
+		 * Deletes a file.  The path is given in UTF-8.
+		 *
+		 * \param _pcPath The path of the file to delete.
+		 * \return Returns true if the file was deleted.
+		 */
+		static bool											RemoveFile( const char8_t * _pcPath );
+
+		/**
+		 * Gets the time at which a file was last written.  The path is given in UTF-8.  The value is only meant to be compared with
+		 *	another returned by this function.
+		 *
+		 * \param _pcPath The path of the file.
+		 * \return Returns the time at which the file was last written, or 0 if it could not be read.
+		 */
+		static int64_t										LastWriteTime( const char8_t * _pcPath );
+
 		/**
 		 * Gets the extension from a file path.
 		 *
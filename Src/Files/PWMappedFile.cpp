@@ -0,0 +1,147 @@
+/**
+ * Copyright L. Spiro 2024
+ *
+ * Written by: Shawn (L. Spiro) Wilcoxen
+ *
+ * Description: A read-only memory-mapped file.
+ */
+
+
+#include "PWMappedFile.h"
+
+#include <cstring>
+
+#ifndef PW_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif	// #ifndef PW_WINDOWS
+
+namespace pw {
+
+	CMappedFile::CMappedFile() :
+#ifdef PW_WINDOWS
+		m_hFile( INVALID_HANDLE_VALUE ),
+		m_hMap( NULL ),
+#else
+		m_iFile( -1 ),
+#endif	// #ifdef PW_WINDOWS
+		m_pui8Map( nullptr ),
+		m_ui64Size( 0 ) {
+	}
+	CMappedFile::~CMappedFile() {
+		Close();
+	}
+
+	// == Functions.
+#ifdef PW_WINDOWS
+	/**
+	 * Opens a file.  The path is given in UTF-16.
+	 *
+	 * \param _pcPath Path to the file to open.
+	 * \return Returns true if the file was opened, false otherwise.
+	 */
+	bool CMappedFile::Open( const char16_t * _pcFile ) {
+		Close();
+
+		m_hFile = ::CreateFileW( reinterpret_cast<LPCWSTR>(_pcFile), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+		if ( INVALID_HANDLE_VALUE == m_hFile ) { return false; }
+
+		LARGE_INTEGER liSize;
+		if ( !::GetFileSizeEx( m_hFile, &liSize ) || liSize.QuadPart == 0 ) {
+			Close();
+			return false;
+		}
+		m_ui64Size = static_cast<uint64_t>(liSize.QuadPart);
+
+		m_hMap = ::CreateFileMappingW( m_hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+		if ( NULL == m_hMap ) {
+			Close();
+			return false;
+		}
+		m_pui8Map = static_cast<const uint8_t *>(::MapViewOfFile( m_hMap, FILE_MAP_READ, 0, 0, 0 ));
+		if ( nullptr == m_pui8Map ) {
+			Close();
+			return false;
+		}
+		return true;
+	}
+#else
+	/**
+	 * Opens a file.  The path is given in UTF-8.
+	 *
+	 * \param _pcPath Path to the file to open.
+	 * \return Returns true if the file was opened, false otherwise.
+	 */
+	bool CMappedFile::Open( const char8_t * _pcFile ) {
+		Close();
+
+		m_iFile = ::open( reinterpret_cast<const char *>(_pcFile), O_RDONLY );
+		if ( m_iFile < 0 ) { return false; }
+
+		struct stat sStat;
+		if ( ::fstat( m_iFile, &sStat ) != 0 || sStat.st_size <= 0 ) {
+			Close();
+			return false;
+		}
+		m_ui64Size = static_cast<uint64_t>(sStat.st_size);
+
+		void * pvMap = ::mmap( nullptr, size_t( m_ui64Size ), PROT_READ, MAP_PRIVATE, m_iFile, 0 );
+		if ( MAP_FAILED == pvMap ) {
+			Close();
+			return false;
+		}
+		::madvise( pvMap, size_t( m_ui64Size ), MADV_SEQUENTIAL );
+		m_pui8Map = static_cast<const uint8_t *>(pvMap);
+		return true;
+	}
+#endif	// #ifdef PW_WINDOWS
+
+	/**
+	 * Closes the opened file.
+	 */
+	void CMappedFile::Close() {
+#ifdef PW_WINDOWS
+		if ( m_pui8Map != nullptr ) {
+			::UnmapViewOfFile( m_pui8Map );
+		}
+		if ( m_hMap != NULL ) {
+			::CloseHandle( m_hMap );
+			m_hMap = NULL;
+		}
+		if ( m_hFile != INVALID_HANDLE_VALUE ) {
+			::CloseHandle( m_hFile );
+			m_hFile = INVALID_HANDLE_VALUE;
+		}
+#else
+		if ( m_pui8Map != nullptr ) {
+			::munmap( const_cast<uint8_t *>(m_pui8Map), size_t( m_ui64Size ) );
+		}
+		if ( m_iFile >= 0 ) {
+			::close( m_iFile );
+			m_iFile = -1;
+		}
+#endif	// #ifdef PW_WINDOWS
+		m_pui8Map = nullptr;
+		m_ui64Size = 0;
+	}
+
+	/**
+	 * Loads the opened file to memory, storing the result in _vResult.
+	 *
+	 * \param _vResult The location where to store the file in memory.
+	 * \return Returns true if the file was successfully loaded into memory.
+	 */
+	bool CMappedFile::LoadToMemory( std::vector<uint8_t> &_vResult ) const {
+		if ( m_pui8Map == nullptr ) { return false; }
+		try {
+			_vResult.resize( size_t( m_ui64Size ) );
+		}
+		catch ( ... ) { return false; }
+		std::memcpy( _vResult.data(), m_pui8Map, _vResult.size() );
+		return true;
+	}
+
+}	// namespace pw
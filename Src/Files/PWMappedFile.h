@@ -0,0 +1,110 @@
+/**
+ * Copyright L. Spiro 2024
+ *
+ * Written by: Shawn (L. Spiro) Wilcoxen
+ *
+ * Description: A read-only memory-mapped file.
+ */
+
+
+#pragma once
+
+#include "../OS/PWOs.h"
+#include "PWFileBase.h"
+
+namespace pw {
+
+	/**
+	 * Class CMappedFile
+	 * \brief A read-only memory-mapped file.
+	 *
+	 * Description: A read-only memory-mapped file.  The whole file is mapped into the address space and pages are brought in by the OS
+	 *	as they are touched, so nothing is copied until it is actually read.
+	 */
+	class CMappedFile : public CFileBase {
+	public :
+		CMappedFile();
+		CMappedFile( const CMappedFile & ) = delete;
+		virtual ~CMappedFile();
+
+
+		// == Operators.
+		CMappedFile &										operator = ( const CMappedFile & ) = delete;
+
+
+		// == Functions.
+#ifdef PW_WINDOWS
+		/**
+		 * Opens a file.  The path is given in UTF-8.
+		 *
+		 * \param _pcPath Path to the file to open.
+		 * \return Returns true if the file was opened, false otherwise.
+		 */
+		virtual bool										Open( const char8_t * _pcFile ) { return CFileBase::Open( _pcFile ); }
+
+		/**
+		 * Opens a file.  The path is given in UTF-16.
+		 *
+		 * \param _pcPath Path to the file to open.
+		 * \return Returns true if the file was opened, false otherwise.
+		 */
+		virtual bool										Open( const char16_t * _pcFile );
+#else
+		/**
+		 * Opens a file.  The path is given in UTF-8.
+		 *
+		 * \param _pcPath Path to the file to open.
+		 * \return Returns true if the file was opened, false otherwise.
+		 */
+		virtual bool										Open( const char8_t * _pcFile );
+
+		/**
+		 * Opens a file.  The path is given in UTF-16.
+		 *
+		 * \param _pcPath Path to the file to open.
+		 * \return Returns true if the file was opened, false otherwise.
+		 */
+		virtual bool										Open( const char16_t * _pcFile ) { return CFileBase::Open( _pcFile ); }
+#endif	// #ifdef PW_WINDOWS
+
+		/**
+		 * Closes the opened file.
+		 */
+		virtual void										Close();
+
+		/**
+		 * Loads the opened file to memory, storing the result in _vResult.
+		 *
+		 * \param _vResult The location where to store the file in memory.
+		 * \return Returns true if the file was successfully loaded into memory.
+		 */
+		virtual bool										LoadToMemory( std::vector<uint8_t> &_vResult ) const;
+
+		/**
+		 * Gets a pointer to the mapped bytes.
+		 *
+		 * \return Returns a pointer to the mapped bytes or nullptr if no file is mapped.
+		 */
+		inline const uint8_t *								Data() const { return m_pui8Map; }
+
+		/**
+		 * Gets the size of the mapped file.
+		 *
+		 * \return Returns the size of the mapped file in bytes.
+		 */
+		inline uint64_t										Size() const { return m_ui64Size; }
+
+
+	protected :
+		// == Members.
+#ifdef PW_WINDOWS
+		HANDLE												m_hFile;							/**< The file handle. */
+		HANDLE												m_hMap;								/**< The file-mapping handle. */
+#else
+		int													m_iFile;							/**< The file descriptor. */
+#endif	// #ifdef PW_WINDOWS
+		const uint8_t *										m_pui8Map;							/**< The mapped view of the file. */
+		uint64_t											m_ui64Size;							/**< The file size. */
+	};
+
+}	// namespace pw
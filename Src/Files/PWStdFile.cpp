@@ -9,8 +9,45 @@
 
 #include "PWStdFile.h"
 
+#include <algorithm>
+#include <filesystem>
+
+#ifdef __linux__
+#include <linux/fs.h>
+#include <linux/magic.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+#endif	// #ifdef __linux__
+
 namespace pw {
 
+#ifdef __linux__
+	/**
+	 * Copies a range between two file descriptors inside the kernel with copy_file_range().  Neither descriptor's file offset is
+	 *	changed.
+	 *
+	 * \param _iSrc The descriptor from which to copy.
+	 * \param _ui64SrcOffset The offset in _iSrc of the range to copy.
+	 * \param _iDst The descriptor to which to copy.
+	 * \param _ui64DstOffset The offset in _iDst to which to copy.
+	 * \param _ui64Size The number of bytes to copy.
+	 * \return Returns the number of bytes copied, which is less than _ui64Size if the kernel or file system cannot do the copy.
+	 */
+	static uint64_t KernelCopy( int _iSrc, uint64_t _ui64SrcOffset, int _iDst, uint64_t _ui64DstOffset, uint64_t _ui64Size ) {
+		loff_t lSrc = loff_t( _ui64SrcOffset ), lDst = loff_t( _ui64DstOffset );
+		uint64_t ui64Done = 0;
+		while ( ui64Done < _ui64Size ) {
+			ssize_t sCopied = ::copy_file_range( _iSrc, &lSrc, _iDst, &lDst, size_t( std::min<uint64_t>( _ui64Size - ui64Done, 1 << 30 ) ), 0 );
+			// EXDEV, ENOSYS, EINVAL, etc. on older kernels or across file systems, or 0 at the end of the source.
+			if ( sCopied <= 0 ) { break; }
+			ui64Done += uint64_t( sCopied );
+		}
+		return ui64Done;
+	}
+#endif	// #ifdef __linux__
+
 	CStdFile::CStdFile() :
 		m_pfFile( nullptr ),
 		m_ui64Size( 0 ) {
@@ -191,6 +228,134 @@ namespace pw {
 		return false;
 	}
 
+	/**
+	 * Moves the file pointer to the given position from the start of the file.
+	 *
+	 * \param _ui64Pos The position to which to move the file pointer.
+	 * \return Returns true if the file pointer was moved.
+	 */
+	bool CStdFile::Seek( uint64_t _ui64Pos ) {
+		if ( m_pfFile != nullptr ) {
+#ifdef PW_WINDOWS
+			return ::_fseeki64( m_pfFile, static_cast<__int64>(_ui64Pos), SEEK_SET ) == 0;
+#else
+			return ::fseeko( m_pfFile, static_cast<off_t>(_ui64Pos), SEEK_SET ) == 0;
+#endif	// #ifdef PW_WINDOWS
+		}
+		return false;
+	}
+
+	/**
+	 * Gets the position of the file pointer.
+	 *
+	 * \return Returns the position of the file pointer from the start of the file.
+	 */
+	uint64_t CStdFile::Tell() const {
+		if ( m_pfFile != nullptr ) {
+#ifdef PW_WINDOWS
+			return static_cast<uint64_t>(::_ftelli64( m_pfFile ));
+#else
+			return static_cast<uint64_t>(::ftello( m_pfFile ));
+#endif	// #ifdef PW_WINDOWS
+		}
+		return 0;
+	}
+
+	/**
+	 * Appends a range of another opened file to this created file at the current file pointer.  On Linux the range is cloned
+	 *	(FICLONERANGE) where the file system supports sharing extents and the offsets allow it, otherwise it is copied inside the
+	 *	kernel with copy_file_range().  Anything those cannot handle is copied through a buffer.
+	 *
+	 * \param _sfSrc The opened file from which to copy.
+	 * \param _ui64SrcOffset The offset in _sfSrc of the range to copy.
+	 * \param _ui64Size The number of bytes to copy.
+	 * \return Returns true if the whole range was copied.  On return the file pointer is at the end of the copied range.
+	 */
+	bool CStdFile::CopyRangeFrom( CStdFile &_sfSrc, uint64_t _ui64SrcOffset, uint64_t _ui64Size ) {
+		if ( m_pfFile == nullptr || _sfSrc.m_pfFile == nullptr ) { return false; }
+		uint64_t ui64DstOffset = Tell();
+		uint64_t ui64Done = 0;
+
+#ifdef __linux__
+		if ( std::fflush( m_pfFile ) == 0 ) {
+			int iSrc = ::fileno( _sfSrc.m_pfFile );
+			int iDst = ::fileno( m_pfFile );
+
+			// Only whole blocks can be cloned, and only if both files agree on where the blocks start.  The unaligned head is copied
+			//	first so that the clone always extends the end of the file.
+			uint64_t ui64Head = _ui64Size, ui64Body = 0;
+			struct stat sStat;
+			if ( ::fstat( iDst, &sStat ) == 0 && sStat.st_blksize > 0 ) {
+				uint64_t ui64Block = uint64_t( sStat.st_blksize );
+				if ( _ui64SrcOffset % ui64Block == ui64DstOffset % ui64Block ) {
+					ui64Head = std::min( (ui64Block - _ui64SrcOffset % ui64Block) % ui64Block, _ui64Size );
+					ui64Body = (_ui64Size - ui64Head) / ui64Block * ui64Block;
+				}
+			}
+
+			ui64Done = KernelCopy( iSrc, _ui64SrcOffset, iDst, ui64DstOffset, ui64Head );
+			if ( ui64Done == ui64Head ) {
+				if ( ui64Body ) {
+					file_clone_range fcrRange = {};
+					fcrRange.src_fd = iSrc;
+					fcrRange.src_offset = _ui64SrcOffset + ui64Done;
+					fcrRange.src_length = ui64Body;
+					fcrRange.dest_offset = ui64DstOffset + ui64Done;
+					if ( ::ioctl( iDst, FICLONERANGE, &fcrRange ) == 0 ) { ui64Done += ui64Body; }
+				}
+				ui64Done += KernelCopy( iSrc, _ui64SrcOffset + ui64Done, iDst, ui64DstOffset + ui64Done, _ui64Size - ui64Done );
+			}
+		}
+		// The copies above bypass the FILE, so its position has to be set explicitly.
+		if ( !Seek( ui64DstOffset + ui64Done ) ) { return false; }
+#endif	// #ifdef __linux__
+
+		// Copy whatever is left through a buffer.
+		if ( ui64Done < _ui64Size ) {
+			std::vector<uint8_t> vBuffer;
+			try {
+				vBuffer.resize( size_t( std::min<uint64_t>( _ui64Size - ui64Done, 1024 * 1024 ) ) );
+			}
+			catch ( ... ) { return false; }
+			if ( !_sfSrc.Seek( _ui64SrcOffset + ui64Done ) ) { return false; }
+			while ( ui64Done < _ui64Size ) {
+				size_t stThis = size_t( std::min<uint64_t>( _ui64Size - ui64Done, vBuffer.size() ) );
+				if ( std::fread( vBuffer.data(), stThis, 1, _sfSrc.m_pfFile ) != 1 ) { return false; }
+				if ( !WriteToFile( vBuffer.data(), stThis ) ) { return false; }
+				ui64Done += stThis;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Determines whether CopyRangeFrom() can clone blocks from one file into a new file instead of copying them.  Only Linux file
+	 *	systems that support FICLONERANGE (Btrfs and XFS) qualify, and the new file must be created on the same one.
+	 *
+	 * \param _pcSrc The UTF-8 path of the file from which blocks would be cloned.
+	 * \param _pcDst The UTF-8 path of the file that will be created.
+	 * \return Returns true if blocks can be cloned from _pcSrc into a file created at _pcDst.
+	 */
+	bool CStdFile::CanCloneRange( const char8_t * _pcSrc, const char8_t * _pcDst ) {
+#ifdef __linux__
+		try {
+			// The new file does not exist yet, so check the directory in which it will be created.
+			std::filesystem::path pDir = std::filesystem::path( std::u8string( _pcDst ) ).parent_path();
+			if ( pDir.empty() ) { pDir = "."; }
+			struct statfs sfsSrc;
+			if ( ::statfs( reinterpret_cast<const char *>(_pcSrc), &sfsSrc ) != 0 ) { return false; }
+			if ( sfsSrc.f_type != BTRFS_SUPER_MAGIC && sfsSrc.f_type != XFS_SUPER_MAGIC ) { return false; }
+			struct stat sSrc, sDir;
+			return ::stat( reinterpret_cast<const char *>(_pcSrc), &sSrc ) == 0 && ::stat( pDir.c_str(), &sDir ) == 0 &&
+				sSrc.st_dev == sDir.st_dev;
+		}
+		catch ( ... ) { return false; }
+#else
+		// CopyRangeFrom() clones only on Linux.
+		return false;
+#endif	// #ifdef __linux__
+	}
+
 	/**
 	 * Performs post-loading operations after a successful loading of the file.  m_pfFile will be valid when this is called.  Override to perform additional loading operations on m_pfFile.
 	 */
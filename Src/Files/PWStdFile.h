@@ -123,6 +123,50 @@ namespace pw {
 		 */
 		virtual bool										WriteToFile( const uint8_t * _pui8Data, size_t _tsSize );
 
+		/**
+		 * Moves the file pointer to the given position from the start of the file.
+		 *
+		 * \param _ui64Pos The position to which to move the file pointer.
+		 * \return Returns true if the file pointer was moved.
+		 */
+		virtual bool										Seek( uint64_t _ui64Pos );
+
+		/**
+		 * Gets the position of the file pointer.
+		 *
+		 * \return Returns the position of the file pointer from the start of the file.
+		 */
+		virtual uint64_t									Tell() const;
+
+		/**
+		 * Gets the size of the file when it was opened.
+		 *
+		 * \return Returns the size of the opened file, or 0 for a created file.
+		 */
+		inline uint64_t										Size() const { return m_ui64Size; }
+
+		/**
+		 * Appends a range of another opened file to this created file at the current file pointer.  On Linux the range is cloned
+		 *	(FICLONERANGE) where the file system supports sharing extents and the offsets allow it, otherwise it is copied inside the
+		 *	kernel with copy_file_range().  Anything those cannot handle is copied through a buffer.
+		 *
+		 * \param _sfSrc The opened file from which to copy.
+		 * \param _ui64SrcOffset The offset in _sfSrc of the range to copy.
+		 * \param _ui64Size The number of bytes to copy.
+		 * \return Returns true if the whole range was copied.  On return the file pointer is at the end of the copied range.
+		 */
+		virtual bool										CopyRangeFrom( CStdFile &_sfSrc, uint64_t _ui64SrcOffset, uint64_t _ui64Size );
+
+		/**
+		 * Determines whether CopyRangeFrom() can clone blocks from one file into a new file instead of copying them.  Only Linux file
+		 *	systems that support FICLONERANGE (Btrfs and XFS) qualify, and the new file must be created on the same one.
+		 *
+		 * \param _pcSrc The UTF-8 path of the file from which blocks would be cloned.
+		 * \param _pcDst The UTF-8 path of the file that will be created.
+		 * \return Returns true if blocks can be cloned from _pcSrc into a file created at _pcDst.
+		 */
+		static bool											CanCloneRange( const char8_t * _pcSrc, const char8_t * _pcDst );
+
 		/**
 		 * Loads the opened file to memory, storing the result in _vResult.
 		 *
@@ -106,6 +106,7 @@ namespace pw {
         static bool                     INVPCID() { return m_iiCpuRep.m_bEbx7[10]; }
         static bool                     RTM() { return m_iiCpuRep.m_bIsIntel && m_iiCpuRep.m_bEbx7[11]; }
         static bool                     AVX512F() { return m_iiCpuRep.m_bEbx7[16]; }
+        static bool                     AVX512DQ() { return m_iiCpuRep.m_bEbx7[17]; }
         static bool                     RDSEED() { return m_iiCpuRep.m_bEbx7[18]; }
         static bool                     ADX() { return m_iiCpuRep.m_bEbx7[19]; }
         static bool                     AVX512PF() { return m_iiCpuRep.m_bEbx7[26]; }
@@ -116,6 +117,7 @@ namespace pw {
         static bool                     AVX512VL() { return m_iiCpuRep.m_bEbx7[31]; }
 
         static bool                     PREFETCHWT1() { return m_iiCpuRep.m_bEcx7[0]; }
+        static bool                     AVX512VBMI() { return m_iiCpuRep.m_bEcx7[1]; }
 
         static bool                     LAHF() { return m_iiCpuRep.m_bEcx81[0]; }
         static bool                     LZCNT() { return m_iiCpuRep.m_bIsIntel && m_iiCpuRep.m_bEcx81[5]; }
@@ -130,6 +132,11 @@ namespace pw {
         static bool                     _3DNOWEXT() { return m_iiCpuRep.m_bIsAmd && m_iiCpuRep.m_bEdx81[30]; }
         static bool                     _3DNOW() { return m_iiCpuRep.m_bIsAmd && m_iiCpuRep.m_bEdx81[31]; }
 
+        // The OS saves the YMM registers (XCR0 bits 1 and 2) on context switches.
+        static bool                     OSAVX() { return (m_iiCpuRep.m_ui64Xcr0 & 0x06) == 0x06; }
+        // The OS saves the YMM, ZMM, and opmask registers (XCR0 bits 1, 2, and 5 to 7) on context switches.
+        static bool                     OSAVX512() { return (m_iiCpuRep.m_ui64Xcr0 & 0xE6) == 0xE6; }
+
     private :
         // == Members.
         static const                    CInstructionSet_Internal m_iiCpuRep;
@@ -149,6 +156,7 @@ namespace pw {
                 m_bEcx7{ 0 },
                 m_bEcx81{ 0 },
                 m_bEdx81{ 0 },
+                m_ui64Xcr0{ 0 },
                 m_vData{},
                 m_vExtData{} {
                 //int cpuInfo[4] = {-1};
@@ -184,6 +192,11 @@ namespace pw {
                     m_bEdx1 = m_vData[1][3];
                 }
 
+                // XGETBV exists only if the OS has enabled it (OSXSAVE).  XCR0 tells which registers the OS saves.
+                if ( m_bEcx1[27] ) {
+                    m_ui64Xcr0 = _xgetbv( 0 );
+                }
+
                 // load bitset with flags for function 0x00000007
                 if ( m_iNumIds >= 7 ) {
                     m_bEbx7 = m_vData[7][1];
@@ -232,6 +245,7 @@ namespace pw {
             std::bitset<32>                 m_bEcx7;
             std::bitset<32>                 m_bEcx81;
             std::bitset<32>                 m_bEdx81;
+            unsigned long long              m_ui64Xcr0;
             std::vector<std::array<int, 4>> m_vData;
             std::vector<std::array<int, 4>> m_vExtData;
         };
@@ -10,6 +10,7 @@
 #include "PWParticleWav.h"
 #include "Files/PWStdFile.h"
 #include "Utilities/PWUtilities.h"
+#include "Wav/PWSampleConverter.h"
 #include "Wav/PWWavFile.h"
 
 
@@ -44,6 +45,82 @@ int wmain( int _iArgC, wchar_t const * _wcpArgV[] ) {
                 catch ( ... ) { PW_ERROR( PW_E_OUTOFMEMORY ); }
                 PW_ADV( 2 );
             }
+            if ( PW_CHECK( 1, mmap ) ) {
+                oOptions.bMapFiles = true;
+                PW_ADV( 1 );
+            }
+            if ( PW_CHECK( 1, huge_pages ) ) {
+                pw::CAlignmentAllocatorBase::SetHugePages( true );
+                PW_ADV( 1 );
+            }
+            if ( PW_CHECK( 2, threads ) ) {
+                if ( !pw::ParseThreadCount( _wcpArgV[1], oOptions.stThreads ) ) {
+                    PW_ERRORT( std::format( L"Invalid thread count: \"{}\".  Expected a number from 0 to 65535, where 0 uses every core.", _wcpArgV[1] ).c_str(), PW_E_INVALIDCALL );
+                }
+                PW_ADV( 2 );
+            }
+            if ( PW_CHECK( 2, file_threads ) ) {
+                if ( !pw::ParseThreadCount( _wcpArgV[1], oOptions.stFileThreads ) ) {
+                    PW_ERRORT( std::format( L"Invalid thread count: \"{}\".  Expected a number from 0 to 65535, where 0 uses every core.", _wcpArgV[1] ).c_str(), PW_E_INVALIDCALL );
+                }
+                PW_ADV( 2 );
+            }
+            if ( PW_CHECK( 2, max_simd ) ) {
+                uint32_t ui32Tier = 0;
+                while ( ui32Tier < pw::CSampleConverter::PW_T_TOTAL &&
+                    ::_wcsicmp( _wcpArgV[1], pw::CSampleConverter::TierName( pw::CSampleConverter::PW_TIER( ui32Tier ) ) ) != 0 ) { ++ui32Tier; }
+                if ( ui32Tier == pw::CSampleConverter::PW_T_TOTAL ) {
+                    PW_ERRORT( std::format( L"Invalid SIMD tier: \"{}\".  Expected scalar, sse4, avx2, avx512, or vbmi.", _wcpArgV[1] ).c_str(), PW_E_INVALIDCALL );
+                }
+                pw::CSampleConverter::SetMaxTier( pw::CSampleConverter::PW_TIER( ui32Tier ) );
+                PW_ADV( 2 );
+            }
+            if ( PW_CHECK( 2, bits ) ) {
+                int iBits = ::_wtoi( _wcpArgV[1] );
+                if ( iBits != 8 && iBits != 16 && iBits != 24 && iBits != 32 && iBits != 64 ) {
+                    PW_ERRORT( std::format( L"Invalid bits per sample: \"{}\".  Expected 8, 16, 24, 32, or 64.", _wcpArgV[1] ).c_str(), PW_E_INVALIDCALL );
+                }
+                oOptions.sdSave.uiBitsPerSample = uint16_t( iBits );
+                PW_ADV( 2 );
+            }
+            if ( PW_CHECK( 2, format ) ) {
+                if ( ::_wcsicmp( _wcpArgV[1], L"pcm" ) == 0 ) {
+                    oOptions.sdSave.fFormat = pw::CWavFile::PW_F_PCM;
+                }
+                else if ( ::_wcsicmp( _wcpArgV[1], L"float" ) == 0 ) {
+                    oOptions.sdSave.fFormat = pw::CWavFile::PW_F_IEEE_FLOAT;
+                }
+                else {
+                    PW_ERRORT( std::format( L"Invalid format: \"{}\".  Expected pcm or float.", _wcpArgV[1] ).c_str(), PW_E_INVALIDCALL );
+                }
+                PW_ADV( 2 );
+            }
+            if ( PW_CHECK( 2, narrowing ) ) {
+                static const wchar_t * s_pwcNarrowing[pw::CSampleConverter::PW_N_TOTAL] = { L"truncate", L"round", L"dither" };
+                uint32_t ui32Narrowing = 0;
+                while ( ui32Narrowing < pw::CSampleConverter::PW_N_TOTAL && ::_wcsicmp( _wcpArgV[1], s_pwcNarrowing[ui32Narrowing] ) != 0 ) { ++ui32Narrowing; }
+                if ( ui32Narrowing == pw::CSampleConverter::PW_N_TOTAL ) {
+                    PW_ERRORT( std::format( L"Invalid narrowing: \"{}\".  Expected truncate, round, or dither.", _wcpArgV[1] ).c_str(), PW_E_INVALIDCALL );
+                }
+                oOptions.sdSave.nNarrowing = pw::CSampleConverter::PW_NARROWING( ui32Narrowing );
+                PW_ADV( 2 );
+            }
+            if ( PW_CHECK( 2, precision ) ) {
+                if ( ::_wcsicmp( _wcpArgV[1], L"auto" ) == 0 ) {
+                    oOptions.bDoublePrecision = false;
+                }
+                else if ( ::_wcsicmp( _wcpArgV[1], L"double" ) == 0 ) {
+                    oOptions.bDoublePrecision = true;
+                }
+                else {
+                    PW_ERRORT( std::format( L"Invalid precision: \"{}\".  Expected auto or double.", _wcpArgV[1] ).c_str(), PW_E_INVALIDCALL );
+                }
+                PW_ADV( 2 );
+            }
+            if ( PW_CHECK( 1, verify_conversions ) ) {
+                oOptions.bVerifyConversions = true;
+                PW_ADV( 1 );
+            }
             if ( PW_CHECK( 2, outfile ) || PW_CHECK( 2, out_file ) ) {
                 // Make sure the output list has at least 1 fewer entries than the input list.
 				if ( oOptions.vOutputs.size() >= oOptions.vInputs.size() ) {
@@ -108,7 +185,7 @@ int wmain( int _iArgC, wchar_t const * _wcpArgV[] ) {
 
             if ( PW_CHECK( 1, set_track_by_idx ) ) {
                 try {
-                    pw::PW_MODIFIER mMod = { .pfModifier = &pw::SetTrackNumber, .pcOperation = L"set_track_by_idx" };
+                    pw::PW_MODIFIER mMod = { .pfModifier = &pw::SetTrackNumber, .pcOperation = L"set_track_by_idx", .bTouchesSamples = false };
                     oOptions.vFuncs.push_back( mMod );
                 }
                 catch ( ... ) { PW_ERROR( PW_E_OUTOFMEMORY ); }
@@ -116,7 +193,7 @@ int wmain( int _iArgC, wchar_t const * _wcpArgV[] ) {
             }
             if ( PW_CHECK( 3, set_meta_string ) ) {
                 try {
-                    pw::PW_MODIFIER mMod = { .pfModifier = &pw::SetMeta, .pcOperation = L"set_meta_string" };
+                    pw::PW_MODIFIER mMod = { .pfModifier = &pw::SetMeta, .pcOperation = L"set_meta_string", .bTouchesSamples = false };
                     mMod.ui32Parm0 = ::_wtoi( _wcpArgV[1] );
                     mMod.sParm5 = pw::CUtilities::ToString( _wcpArgV[2] );
                     oOptions.vFuncs.push_back( mMod );
@@ -142,48 +219,165 @@ int wmain( int _iArgC, wchar_t const * _wcpArgV[] ) {
             oOptions.vInputs.size(), oOptions.vOutputs.size() ).c_str(), PW_E_INVALIDCALL );
     }
 
-    std::vector<std::u16string>::size_type sSuccess = 0;
-    for ( std::vector<std::u16string>::size_type I = 0; I < oOptions.vInputs.size(); ++I ) {
-        pw::CWavFile wfWav;
-        if ( !wfWav.Open( oOptions.vInputs[I].c_str() ) ) {
-            std::wcout << std::format( L"Failed to load file: \"{}\"", reinterpret_cast<const wchar_t *>(oOptions.vInputs[I].c_str()) ) << std::endl;
-            continue;
+    if ( oOptions.sdSave.fFormat == pw::CWavFile::PW_F_IEEE_FLOAT ) {
+        if ( oOptions.sdSave.uiBitsPerSample && oOptions.sdSave.uiBitsPerSample != 32 && oOptions.sdSave.uiBitsPerSample != 64 ) {
+            PW_ERRORT( std::format( L"Invalid bits per sample for float output: \"{}\".  Expected 32 or 64.", oOptions.sdSave.uiBitsPerSample ).c_str(), PW_E_INVALIDCALL );
         }
+    }
+    else if ( oOptions.sdSave.uiBitsPerSample == 64 ) {
+        PW_ERRORT( u"64 bits per sample requires \"-format float\".", PW_E_INVALIDCALL );
+    }
 
-        pw::CWavFile::lwaudio aSamples;
-        if ( !wfWav.GetAllSamples( aSamples ) ) {
-            std::wcout << std::format( L"Failed to get all samples from file: \"{}\"", reinterpret_cast<const wchar_t *>(oOptions.vInputs[I].c_str()) ) << std::endl;
-            continue;
+    if ( oOptions.bVerifyConversions ) {
+        std::wstring wsLog;
+        bool bMatched = pw::CSampleConverter::VerifyTiers( wsLog );
+        std::wcout << wsLog;
+        std::wcout.flush();
+        if ( !bMatched ) {
+            PW_ERRORT( u"SIMD conversions do not match the scalar conversions.", PW_E_INTERNALERROR );
         }
+    }
 
+    // Each worker gets its own copy of the modifiers because stIdx, stTotal, and paSamples are written per file, and its own arena so
+    //  that the buffers of one file are reused by the next instead of being allocated and freed for every file.
+    size_t stThreads = std::min( pw::CUtilities::ThreadCount( oOptions.stThreads ), std::max<size_t>( oOptions.vInputs.size(), 1 ) );
+    std::vector<std::vector<pw::PW_MODIFIER>> vWorkerFuncs;
+    std::vector<pw::CWavFile::PW_ARENA> vArenas;
+    std::vector<std::wstring> vLogs;
+    std::vector<uint8_t> vDone;
+    try {
+        vWorkerFuncs.resize( stThreads, oOptions.vFuncs );
+        vArenas.resize( stThreads );
+        vLogs.resize( oOptions.vInputs.size() );
+        vDone.resize( oOptions.vInputs.size() );
+    }
+    catch ( ... ) { PW_ERROR( PW_E_OUTOFMEMORY ); }
 
-        for ( std::vector<pw::PW_MODIFIER>::size_type J = 0; J < oOptions.vFuncs.size(); ++J ) {
-            oOptions.vFuncs[J].stIdx = I;
-            oOptions.vFuncs[J].stTotal = oOptions.vInputs.size();
-            oOptions.vFuncs[J].paSamples = &aSamples;
-            if ( !(oOptions.vFuncs[J].pfModifier)( wfWav, oOptions.vFuncs[J], oOptions ) ) {
-                std::wcout << std::format( L"Operation {} failed on file: \"{}\"",
-                    oOptions.vFuncs[J].pcOperation,
-                    reinterpret_cast<const wchar_t *>(oOptions.vOutputs[I].c_str()) ) << std::endl;
-                continue;  
-            }
+    // Messages are printed in input order: whichever worker completes the next file in line prints it and any finished files after it.
+    std::mutex mLogMutex;
+    std::vector<std::u16string>::size_type sNextLog = 0;
+    std::vector<std::u16string>::size_type sSuccess = 0;
+    pw::CUtilities::ParallelFor( oOptions.vInputs.size(), stThreads, [&]( size_t _stIdx, size_t _stWorker ) {
+        std::wstring wsLog;
+        bool bSaved = pw::ProcessFile( _stIdx, oOptions, vWorkerFuncs[_stWorker], vArenas[_stWorker], wsLog );
+
+        std::lock_guard<std::mutex> lgLock( mLogMutex );
+        vLogs[_stIdx].swap( wsLog );
+        vDone[_stIdx] = 1;
+        if ( bSaved ) { ++sSuccess; }
+        while ( sNextLog < vDone.size() && vDone[sNextLog] ) {
+            std::wcout << vLogs[sNextLog];
+            std::wstring().swap( vLogs[sNextLog] );
+            ++sNextLog;
         }
+        std::wcout.flush();
+    } );
 
+    return 0;
+}
 
-        if ( !wfWav.SaveAsPcm( oOptions.vOutputs[I].c_str(), aSamples ) ) {
-            std::wcout << std::format( L"Failed to save file: \"{}\"", reinterpret_cast<const wchar_t *>(oOptions.vOutputs[I].c_str()) ) << std::endl;
-            continue;
-        }
 
-        std::wcout << std::format( L"Saved file: \"{}\"", reinterpret_cast<const wchar_t *>(oOptions.vOutputs[I].c_str()) ) << std::endl;
-        ++sSuccess;
+namespace pw {
+
+    /**
+     * Parses a thread count from the command line.  Only digits are accepted, because ::_wtoi() would read "abc" as 0, which means
+     *  one thread per core.
+     * 
+     * \param _pwcText The text to parse.
+     * \param _stCount Holds the thread count on success, where 0 uses every core.
+     * \return Returns true if _pwcText is a number from 0 to 65535.
+     **/
+    bool ParseThreadCount( const wchar_t * _pwcText, size_t &_stCount ) {
+        if ( !std::iswdigit( _pwcText[0] ) ) { return false; }
+        wchar_t * pwcEnd = nullptr;
+        unsigned long ulCount = std::wcstoul( _pwcText, &pwcEnd, 10 );
+        if ( (*pwcEnd) != L'\0' || ulCount > 0xFFFF ) { return false; }
+        _stCount = size_t( ulCount );
+        return true;
     }
 
-    return 0;
-}
+    /**
+     * Loads, modifies, and saves a single file.  Messages are appended to _wsLog rather than printed so that files processed in
+     *  parallel can be reported in order.
+     * 
+     * \param _stIdx The index of the file to process within _oOptions.vInputs.
+     * \param _oOptions The options.  Not modified.
+     * \param _vFuncs The modifiers to apply.  Each worker thread must have its own copy.
+     * \param _aArena The buffers reused from file to file.  Each worker thread must have its own.
+     * \param _wsLog Holds the messages for this file on return.
+     * \return Returns true if the file was saved.
+     **/
+    bool ProcessFile( std::vector<std::u16string>::size_type _stIdx, PW_OPTIONS &_oOptions, std::vector<PW_MODIFIER> &_vFuncs, CWavFile::PW_ARENA &_aArena, std::wstring &_wsLog ) {
+        try {
+            CWavFile wfWav;
+            wfWav.SetThreads( _oOptions.stFileThreads );
+            // Memory-mapped files are read from the mapping, so only the decoded and encoded buffers come from the arena.
+            wfWav.SetArena( &_aArena );
+            // Saving over a mapped input would truncate the file while its samples are still being read from the mapping.
+            if ( _oOptions.bMapFiles && CFileBase::IsSameFile( _oOptions.vInputs[_stIdx].c_str(), _oOptions.vOutputs[_stIdx].c_str() ) ) {
+                _wsLog += std::format( L"Cannot memory-map a file that is also its output: \"{}\"\n", reinterpret_cast<const wchar_t *>(_oOptions.vInputs[_stIdx].c_str()) );
+                return false;
+            }
+            if ( !(_oOptions.bMapFiles ? wfWav.OpenMapped( _oOptions.vInputs[_stIdx].c_str() ) : wfWav.Open( _oOptions.vInputs[_stIdx].c_str() )) ) {
+                _wsLog += std::format( L"Failed to load file: \"{}\"\n", reinterpret_cast<const wchar_t *>(_oOptions.vInputs[_stIdx].c_str()) );
+                return false;
+            }
 
+            // If no modifier touches the samples, the "data" chunk is copied (changing only its bit depth) rather than decoded.
+            bool bDecode = !wfWav.CanConvertSamples( &_oOptions.sdSave );
+            for ( std::vector<PW_MODIFIER>::size_type J = 0; J < _vFuncs.size() && !bDecode; ++J ) {
+                bDecode = _vFuncs[J].bTouchesSamples;
+            }
 
-namespace pw {
+            // Float holds 8-, 16-, and 24-bit PCM and 32-bit float losslessly in half the memory of double.
+            bool bFloat = bDecode && !_oOptions.bDoublePrecision && wfWav.FloatIsLossless( &_oOptions.sdSave );
+            // Every channel is decoded into one aligned block, which the arena keeps for the next file.
+            CWavFile::lwblock & aSamples = _aArena.bSamples;
+            CWavFile::lwblockf & aSamplesF = _aArena.bSamplesF;
+            if ( bDecode && !(bFloat ? wfWav.GetAllSamples( aSamplesF ) : wfWav.GetAllSamples( aSamples )) ) {
+                _wsLog += std::format( L"Failed to get all samples from file: \"{}\"\n", reinterpret_cast<const wchar_t *>(_oOptions.vInputs[_stIdx].c_str()) );
+                return false;
+            }
+            // Only the ranges the modifiers report as changed are re-encoded when saving; the rest is copied from the loaded file.
+            if ( bDecode ) { wfWav.MarkClean(); }
+
+
+            for ( std::vector<PW_MODIFIER>::size_type J = 0; J < _vFuncs.size(); ++J ) {
+                _vFuncs[J].stIdx = _stIdx;
+                _vFuncs[J].stTotal = _oOptions.vInputs.size();
+                _vFuncs[J].paSamples = bDecode && !bFloat ? &aSamples : nullptr;
+                _vFuncs[J].pafSamples = bFloat ? &aSamplesF : nullptr;
+                if ( _vFuncs[J].bTouchesSamples && !_vFuncs[J].bMarksDirty ) { wfWav.MarkAllDirty(); }
+                if ( !(_vFuncs[J].pfModifier)( wfWav, _vFuncs[J], _oOptions ) ) {
+                    _wsLog += std::format( L"Operation {} failed on file: \"{}\"\n",
+                        _vFuncs[J].pcOperation,
+                        reinterpret_cast<const wchar_t *>(_oOptions.vOutputs[_stIdx].c_str()) );
+                    continue;  
+                }
+            }
+
+
+            bool bSaved;
+            if ( !bDecode ) {
+                bSaved = wfWav.SaveAsPcmCopy( _oOptions.vOutputs[_stIdx].c_str(), &_oOptions.sdSave );
+            }
+            else {
+                bSaved = bFloat ? wfWav.SaveAsPcm( _oOptions.vOutputs[_stIdx].c_str(), aSamplesF, &_oOptions.sdSave ) :
+                    wfWav.SaveAsPcm( _oOptions.vOutputs[_stIdx].c_str(), aSamples, &_oOptions.sdSave );
+            }
+            if ( !bSaved ) {
+                _wsLog += std::format( L"Failed to save file: \"{}\"\n", reinterpret_cast<const wchar_t *>(_oOptions.vOutputs[_stIdx].c_str()) );
+                return false;
+            }
+
+            _wsLog += std::format( L"Saved file: \"{}\"\n", reinterpret_cast<const wchar_t *>(_oOptions.vOutputs[_stIdx].c_str()) );
+            return true;
+        }
+        catch ( ... ) {
+            _wsLog += std::format( L"Out of memory while processing file: \"{}\"\n", reinterpret_cast<const wchar_t *>(_oOptions.vInputs[_stIdx].c_str()) );
+            return false;
+        }
+    }
 
     /**
      * Fills in meta information in a string.
@@ -3,8 +3,11 @@
 #include "Wav/PWWavFile.h"
 
 #include <cstdint>
+#include <cwchar>
+#include <cwctype>
 #include <format>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -49,9 +52,12 @@ namespace pw {
 
         std::vector<std::u16string>::size_type                          stIdx = 0;                                                      /**< Item index. */
         std::vector<std::u16string>::size_type                          stTotal = 0;                                                    /**< The total number of files. */
-        pw::CWavFile::lwaudio *                                         paSamples = nullptr;                                            /**< a pointer to the samples. */
+        pw::CWavFile::lwblock *                                         paSamples = nullptr;                                            /**< a pointer to the samples, if they were decoded to double. */
+        pw::CWavFile::lwblockf *                                        pafSamples = nullptr;                                           /**< a pointer to the samples, if they were decoded to float. */
 
         const wchar_t *                                                 pcOperation = nullptr;                                          /**< The name of the operation. */
+        bool                                                            bTouchesSamples = true;                                         /**< If false, the modifier only changes metadata and paSamples and pafSamples may be nullptr. */
+        bool                                                            bMarksDirty = false;                                            /**< If true, the modifier reports the samples it changes with CWavFile::MarkDirty(); otherwise every sample is re-encoded. */
     };
 
 	/** Options. */
@@ -61,6 +67,12 @@ namespace pw {
         std::vector<PW_MODIFIER>                                        vFuncs;                                                         /**< The operations to perform on each file. */
         bool															bPause = false;													/**< If true, the program pauses before closing the command window. */
 		bool															bShowTime = true;												/**< If true, the time taken to perform the conversion is printed. */
+		bool															bMapFiles = false;												/**< If true, input files are memory-mapped instead of being read into memory.  Files that are also their own outputs are rejected. */
+		size_t															stThreads = 1;													/**< The number of files to process at once.  0 uses one thread per logical core. */
+		size_t															stFileThreads = 1;												/**< The number of threads used to decode and encode each file.  0 uses one thread per logical core. */
+		bool															bVerifyConversions = false;										/**< If true, every SIMD tier is checked against the scalar conversions before any files are processed. */
+		pw::CWavFile::PW_SAVE_DATA										sdSave;															/**< The output format, PCM or IEEE float.  Bit depth changes of unmodified PCM files are done without decoding. */
+		bool															bDoublePrecision = false;										/**< If true, samples are always decoded to double; otherwise float is used when it is lossless for the file. */
     };
 
 
@@ -143,6 +155,29 @@ namespace pw {
         }
     }
 
+    /**
+     * Parses a thread count from the command line.  Only digits are accepted, because ::_wtoi() would read "abc" as 0, which means
+     *  one thread per core.
+     * 
+     * \param _pwcText The text to parse.
+     * \param _stCount Holds the thread count on success, where 0 uses every core.
+     * \return Returns true if _pwcText is a number from 0 to 65535.
+     **/
+    bool                                                                ParseThreadCount( const wchar_t * _pwcText, size_t &_stCount );
+
+    /**
+     * Loads, modifies, and saves a single file.  Messages are appended to _wsLog rather than printed so that files processed in
+     *  parallel can be reported in order.
+     * 
+     * \param _stIdx The index of the file to process within _oOptions.vInputs.
+     * \param _oOptions The options.  Not modified.
+     * \param _vFuncs The modifiers to apply.  Each worker thread must have its own copy.
+     * \param _aArena The buffers reused from file to file.  Each worker thread must have its own.
+     * \param _wsLog Holds the messages for this file on return.
+     * \return Returns true if the file was saved.
+     **/
+    bool                                                                ProcessFile( std::vector<std::u16string>::size_type _stIdx, PW_OPTIONS &_oOptions, std::vector<PW_MODIFIER> &_vFuncs, CWavFile::PW_ARENA &_aArena, std::wstring &_wsLog );
+
     /**
      * Fills in meta information in a string.
      * 
@@ -9,12 +9,102 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstdlib>
+#include <new>
+#if defined( _WIN32 ) || defined( _WIN64 )
 #include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif	// #if defined( _WIN32 ) || defined( _WIN64 )
 
 
 namespace pw {
 
+	/**
+	 * Class CAlignmentAllocatorBase
+	 * \brief The allocation functions shared by every CAlignmentAllocator.
+	 *
+	 * Description: The allocation functions shared by every CAlignmentAllocator.  Memory comes from _aligned_malloc() on Windows and
+	 *	posix_memalign() elsewhere.  Huge pages can be enabled for the whole program, after which blocks of at least PW_HP_SIZE bytes are
+	 *	aligned and padded to whole huge pages and, on Linux, the kernel is asked to back them with transparent huge pages, cutting TLB
+	 *	misses when streaming through long tracks.  This needs transparent huge pages set to "madvise" or "always" in
+	 *	/sys/kernel/mm/transparent_hugepage/enabled; otherwise the blocks get normal pages.
+	 */
+	class CAlignmentAllocatorBase {
+	public :
+		// == Enumerations.
+		/** Huge pages. */
+		enum PW_HUGE_PAGES : size_t {
+			PW_HP_SIZE													= 2 * 1024 * 1024,		// The size of a huge page, and the smallest block that gets them.
+		};
+
+
+		// == Functions.
+		/**
+		 * Allocates aligned memory.
+		 *
+		 * \param _sSize The number of bytes to allocate.
+		 * \param _sAlign The alignment, which must be a power of 2.
+		 * \return Returns the allocated memory, to be freed with Free(), or nullptr.
+		 */
+		static inline void *											Allocate( size_t _sSize, size_t _sAlign ) {
+#if defined( _WIN32 ) || defined( _WIN64 )
+			return ::_aligned_malloc( _sSize, _sAlign );
+#else
+			const bool bHuge = m_bHugePages && _sSize >= PW_HP_SIZE;
+			if ( bHuge ) {
+				_sSize = (_sSize + PW_HP_SIZE - 1) / PW_HP_SIZE * PW_HP_SIZE;
+				_sAlign = std::max<size_t>( _sAlign, PW_HP_SIZE );
+			}
+			void * pvRet = nullptr;
+			// posix_memalign() needs at least the alignment of a pointer.
+			if ( ::posix_memalign( &pvRet, std::max( _sAlign, sizeof( void * ) ), _sSize ) != 0 ) { return nullptr; }
+#ifdef MADV_HUGEPAGE
+			// Only a hint; if it fails the block keeps normal pages.
+			if ( bHuge ) { ::madvise( pvRet, _sSize, MADV_HUGEPAGE ); }
+#endif	// #ifdef MADV_HUGEPAGE
+			return pvRet;
+#endif	// #if defined( _WIN32 ) || defined( _WIN64 )
+		}
+
+		/**
+		 * Frees memory allocated by Allocate().
+		 *
+		 * \param _pvMem The memory to free.  May be nullptr.
+		 */
+		static inline void												Free( void * _pvMem ) {
+#if defined( _WIN32 ) || defined( _WIN64 )
+			::_aligned_free( _pvMem );
+#else
+			::free( _pvMem );
+#endif	// #if defined( _WIN32 ) || defined( _WIN64 )
+		}
+
+		/**
+		 * Enables or disables huge pages for blocks allocated from now on.  Has no effect on Windows, where large pages need a privilege
+		 *	most accounts do not have.  Must not be called while other threads are allocating.
+		 *
+		 * \param _bHugePages If true, blocks of at least PW_HP_SIZE bytes are backed by huge pages where possible.
+		 */
+		static inline void												SetHugePages( bool _bHugePages ) { m_bHugePages = _bHugePages; }
+
+		/**
+		 * Determines whether huge pages are enabled.
+		 *
+		 * \return Returns true if huge pages were enabled by SetHugePages().
+		 */
+		static inline bool												HugePages() { return m_bHugePages; }
+
+
+	protected :
+		// == Members.
+		/** If true, large blocks are backed by huge pages. */
+		static inline bool												m_bHugePages = false;
+	};
+
     /**
 	 * Class CAlignmentAllocator
 	 * \brief An aligned allocator for std::vector.
@@ -64,16 +154,20 @@ namespace pw {
          * Performs an aligned allocation of _sN elements.
          * 
          * \param _sN The number of elements to allocate.
-         * \return Returns a pointer to the allocated _sN elements or nullptr.
+         * \return Returns a pointer to the allocated _sN elements.  Throws std::bad_alloc on failure.
          **/
-        inline pointer                                              allocate( size_type _sN ) { return reinterpret_cast<pointer>(::_aligned_malloc( _sN * sizeof( value_type ), N )); }
+        inline pointer                                              allocate( size_type _sN ) {
+            void * pvRet = CAlignmentAllocatorBase::Allocate( _sN * sizeof( value_type ), N );
+            if ( !pvRet ) { throw std::bad_alloc(); }
+            return reinterpret_cast<pointer>(pvRet);
+        }
 
         /**
          * Deallocation of the given pointer.
          * 
          * \param _pP The pointer to deallocate.
          **/
-        inline void                                                 deallocate( pointer _pP, size_type ) { ::_aligned_free( _pP ); }
+        inline void                                                 deallocate( pointer _pP, size_type ) { CAlignmentAllocatorBase::Free( _pP ); }
 
         /**
          * Constructs an object at the given pointer.
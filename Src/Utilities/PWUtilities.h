@@ -13,10 +13,12 @@
 #include "../OS/PWFeatureSet.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 //#include <intrin.h>
 #include <numbers>
 #include <string>
+#include <thread>
 #include <vector>
 
 
@@ -169,6 +171,57 @@ namespace pw {
 		 **/
 		static std::vector<std::string>						Tokenize( const std::string &_sString, std::string::value_type _vtDelimiter, bool _bAllowEmptyStrings );
 
+		/**
+		 * Resolves a requested number of worker threads.
+		 * 
+		 * \param _stRequested The requested number of threads, or 0 to use one thread per logical core.
+		 * \return Returns the number of threads to use, which is always at least 1.
+		 **/
+		static inline size_t								ThreadCount( size_t _stRequested ) {
+			if ( _stRequested ) { return _stRequested; }
+			return std::max<size_t>( std::thread::hardware_concurrency(), 1 );
+		}
+
+		/**
+		 * Calls _fFunc( _stIdx, _stWorker ) once for each index in [0, _stTotal), spreading the calls over up to _stThreads threads.  The
+		 *	calling thread is worker 0 and takes part in the work.  Each worker pulls the next unclaimed index, so the order in which
+		 *	indices complete is not defined, but a given worker index is never used by 2 threads at once, which lets callers keep
+		 *	per-worker state in an array indexed by _stWorker.
+		 * 
+		 * \param _stTotal The number of indices to process.
+		 * \param _stThreads The maximum number of threads to use, including the calling thread.
+		 * \param _fFunc The function to call for each index.
+		 * \return Returns false if any call to _fFunc threw an exception.  The remaining indices are still processed.
+		 **/
+		template <typename _tFunc>
+		static bool											ParallelFor( size_t _stTotal, size_t _stThreads, const _tFunc &_fFunc ) {
+			std::atomic<size_t> aNext( 0 );
+			std::atomic<bool> aFailed( false );
+			auto aWorker = [&]( size_t _stWorker ) {
+				for ( size_t I = aNext++; I < _stTotal; I = aNext++ ) {
+					try {
+						_fFunc( I, _stWorker );
+					}
+					catch ( ... ) { aFailed = true; }
+				}
+			};
+
+			std::vector<std::thread> vThreads;
+			size_t stThreads = std::min( std::max<size_t>( _stThreads, 1 ), _stTotal );
+			try {
+				vThreads.reserve( stThreads );
+				for ( size_t I = 1; I < stThreads; ++I ) {
+					vThreads.emplace_back( aWorker, I );
+				}
+			}
+			catch ( ... ) {}	// Fewer threads than requested; the ones that started share the work.
+			aWorker( 0 );
+			for ( auto & tThis : vThreads ) {
+				tThis.join();
+			}
+			return !aFailed;
+		}
+
 #ifdef __AVX512F__
 		/**
 		 * Horizontally adds all the floats in a given AVX-512 register.
@@ -527,11 +580,11 @@ namespace pw {
 		/**
 		 * Is AVX supported?
 		 *
-		 * \return Returns true if AVX is supported.
+		 * \return Returns true if AVX is supported by the CPU and OS.
 		 **/
 		static inline bool									IsAvxSupported() {
 #if defined( __i386__ ) || defined( __x86_64__ ) || defined( _MSC_VER )
-			return CFeatureSet::AVX();
+			return CFeatureSet::AVX() && CFeatureSet::OSAVX();
 #else
 			return false;
 #endif	// #if defined( __i386__ ) || defined( __x86_64__ )
@@ -540,11 +593,11 @@ namespace pw {
 		/**
 		 * Is AVX 2 supported?
 		 *
-		 * \return Returns true if AVX is supported.
+		 * \return Returns true if AVX is supported by the CPU and OS.
 		 **/
 		static inline bool									IsAvx2Supported() {
 #if defined( __i386__ ) || defined( __x86_64__ ) || defined( _MSC_VER )
-			return CFeatureSet::AVX2();
+			return CFeatureSet::AVX2() && CFeatureSet::OSAVX();
 #else
 			return false;
 #endif	// #if defined( __i386__ ) || defined( __x86_64__ )
@@ -553,11 +606,11 @@ namespace pw {
 		/**
 		 * Is AVX-512F supported?
 		 *
-		 * \return Returns true if AVX-512F is supported.
+		 * \return Returns true if AVX-512F is supported by the CPU and OS.
 		 **/
 		static inline bool									IsAvx512FSupported() {
 #if defined( __i386__ ) || defined( __x86_64__ ) || defined( _MSC_VER )
-			return CFeatureSet::AVX512F();
+			return CFeatureSet::AVX512F() && CFeatureSet::OSAVX512();
 #else
 			return false;
 #endif	// #if defined( __i386__ ) || defined( __x86_64__ )
@@ -566,11 +619,64 @@ namespace pw {
 		/**
 		 * Is AVX-512BW supported?
 		 *
-		 * \return Returns true if AVX-512BW is supported.
+		 * \return Returns true if AVX-512BW is supported by the CPU and OS.
 		 **/
 		static inline bool									IsAvx512BWSupported() {
 #if defined( __i386__ ) || defined( __x86_64__ ) || defined( _MSC_VER )
-			return CFeatureSet::AVX512BW();
+			return CFeatureSet::AVX512BW() && CFeatureSet::OSAVX512();
+#else
+			return false;
+#endif	// #if defined( __i386__ ) || defined( __x86_64__ )
+		}
+
+		/**
+		 * Is AVX-512CD supported?
+		 *
+		 * \return Returns true if AVX-512CD is supported by the CPU and OS.
+		 **/
+		static inline bool									IsAvx512CDSupported() {
+#if defined( __i386__ ) || defined( __x86_64__ ) || defined( _MSC_VER )
+			return CFeatureSet::AVX512CD() && CFeatureSet::OSAVX512();
+#else
+			return false;
+#endif	// #if defined( __i386__ ) || defined( __x86_64__ )
+		}
+
+		/**
+		 * Is AVX-512DQ supported?
+		 *
+		 * \return Returns true if AVX-512DQ is supported by the CPU and OS.
+		 **/
+		static inline bool									IsAvx512DQSupported() {
+#if defined( __i386__ ) || defined( __x86_64__ ) || defined( _MSC_VER )
+			return CFeatureSet::AVX512DQ() && CFeatureSet::OSAVX512();
+#else
+			return false;
+#endif	// #if defined( __i386__ ) || defined( __x86_64__ )
+		}
+
+		/**
+		 * Is AVX-512VL supported?
+		 *
+		 * \return Returns true if AVX-512VL is supported by the CPU and OS.
+		 **/
+		static inline bool									IsAvx512VLSupported() {
+#if defined( __i386__ ) || defined( __x86_64__ ) || defined( _MSC_VER )
+			return CFeatureSet::AVX512VL() && CFeatureSet::OSAVX512();
+#else
+			return false;
+#endif	// #if defined( __i386__ ) || defined( __x86_64__ )
+		}
+
+		/**
+		 * Is AVX-512 VBMI supported?  Also requires AVX-512BW, which every processor with VBMI has, since the VBMI paths use its
+		 *	byte-masked loads and stores.
+		 *
+		 * \return Returns true if AVX-512 VBMI and AVX-512BW are supported by the CPU and OS.
+		 **/
+		static inline bool									IsAvx512VbmiSupported() {
+#if defined( __i386__ ) || defined( __x86_64__ ) || defined( _MSC_VER )
+			return CFeatureSet::AVX512VBMI() && CFeatureSet::AVX512BW() && CFeatureSet::OSAVX512();
 #else
 			return false;
 #endif	// #if defined( __i386__ ) || defined( __x86_64__ )
@@ -0,0 +1,372 @@
+/**
+ * Copyright L. Spiro 2024
+ *
+ * Written by: Shawn (L. Spiro) Wilcoxen
+ *
+ * Description: Interleaved PCM samples in their native integer format, with edits that never convert to floating point.
+ */
+
+#include "PWPcmBuffer.h"
+#include "PWSampleConverter.h"
+#include "PWWavStreamWriter.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+namespace pw {
+
+	/**
+	 * Reads the signed code of a sample.
+	 *
+	 * \param _pui8Src The sample.
+	 * \return Returns the signed code of the sample.
+	 */
+	template <uint16_t _uiBytes>
+	static inline int32_t ReadCode( const uint8_t * _pui8Src ) {
+		if constexpr ( _uiBytes == 1 ) { return int32_t( _pui8Src[0] ) - 128; }
+		else if constexpr ( _uiBytes == 2 ) {
+			int16_t i16Val;
+			std::memcpy( &i16Val, _pui8Src, sizeof( i16Val ) );
+			return i16Val;
+		}
+		else if constexpr ( _uiBytes == 3 ) {
+			return int32_t( (uint32_t( _pui8Src[0] ) << 8) | (uint32_t( _pui8Src[1] ) << 16) | (uint32_t( _pui8Src[2] ) << 24) ) >> 8;
+		}
+		else {
+			int32_t i32Val;
+			std::memcpy( &i32Val, _pui8Src, sizeof( i32Val ) );
+			return i32Val;
+		}
+	}
+
+	/**
+	 * Writes a signed code to a sample, saturating it to the range of the format.
+	 *
+	 * \param _pui8Dst The sample.
+	 * \param _i64Code The signed code to write.
+	 */
+	template <uint16_t _uiBytes>
+	static inline void WriteCode( uint8_t * _pui8Dst, int64_t _i64Code ) {
+		constexpr int64_t i64Max = (int64_t( 1 ) << (_uiBytes * 8 - 1)) - 1;
+		int32_t i32Val = int32_t( std::clamp<int64_t>( _i64Code, -i64Max - 1, i64Max ) );
+		if constexpr ( _uiBytes == 1 ) { _pui8Dst[0] = uint8_t( i32Val + 128 ); }
+		else if constexpr ( _uiBytes == 2 ) {
+			int16_t i16Val = int16_t( i32Val );
+			std::memcpy( _pui8Dst, &i16Val, sizeof( i16Val ) );
+		}
+		else if constexpr ( _uiBytes == 3 ) {
+			_pui8Dst[0] = uint8_t( i32Val );
+			_pui8Dst[1] = uint8_t( i32Val >> 8 );
+			_pui8Dst[2] = uint8_t( i32Val >> 16 );
+		}
+		else { std::memcpy( _pui8Dst, &i32Val, sizeof( i32Val ) ); }
+	}
+
+	CPcmBuffer::CPcmBuffer() :
+		m_uiChannels( 0 ),
+		m_uiBitsPerSample( 0 ),
+		m_uiBytesPerSample( 0 ) {
+	}
+
+	// == Functions.
+	/**
+	 * Replaces every sample of a channel with the result of a function of its signed code, saturating the result.
+	 *
+	 * \param _uiChan The channel to modify.
+	 * \param _fFunc The function, taking and returning an int64_t.
+	 */
+	template <typename _tFunc>
+	void CPcmBuffer::Transform( uint16_t _uiChan, _tFunc _fFunc ) {
+		size_t stFrameSize = FrameSize();
+		uint8_t * pui8Sample = m_vData.data() + size_t( _uiChan ) * m_uiBytesPerSample;
+		size_t stFrames = Frames();
+		switch ( m_uiBytesPerSample ) {
+#define PW_TRANSFORM( BYTES )																											\
+			case BYTES : {																												\
+				for ( size_t I = stFrames; I--; pui8Sample += stFrameSize ) { WriteCode<BYTES>( pui8Sample, _fFunc( ReadCode<BYTES>( pui8Sample ) ) ); }	\
+				break;																													\
+			}
+			PW_TRANSFORM( 1 )
+			PW_TRANSFORM( 2 )
+			PW_TRANSFORM( 3 )
+			PW_TRANSFORM( 4 )
+#undef PW_TRANSFORM
+		}
+	}
+
+	/**
+	 * Copies the samples of a loaded PCM file.
+	 *
+	 * \param _wfFile The file whose samples are to be copied.  CWavFile::CanCopySamples() must return true for it.
+	 * \return Returns true if the samples were copied.
+	 */
+	bool CPcmBuffer::Set( const CWavFile &_wfFile ) {
+		Reset();
+		if ( _wfFile.m_fFormat != CWavFile::PW_F_PCM || !_wfFile.CanCopySamples() ) { return false; }
+		// Any partial frame at the end of the "data" chunk is dropped, just as it is when decoding.
+		size_t stSize = size_t( _wfFile.TotalSamples() ) * _wfFile.m_uiNumChannels * _wfFile.m_uiBytesPerSample;
+		try {
+			m_vData.assign( _wfFile.m_pui8Samples, _wfFile.m_pui8Samples + stSize );
+		}
+		catch ( ... ) { return false; }
+		m_uiChannels = _wfFile.m_uiNumChannels;
+		m_uiBitsPerSample = _wfFile.m_uiBitsPerSample;
+		m_uiBytesPerSample = _wfFile.m_uiBytesPerSample;
+		return true;
+	}
+
+	/**
+	 * Empties the buffer.
+	 */
+	void CPcmBuffer::Reset() {
+		m_vData.clear();
+		m_uiChannels = 0;
+		m_uiBitsPerSample = 0;
+		m_uiBytesPerSample = 0;
+	}
+
+	/**
+	 * Gets a sample.
+	 *
+	 * \param _stFrame The frame holding the sample.  Must be less than Frames().
+	 * \param _uiChan The channel of the sample.  Must be less than Channels().
+	 * \return Returns the signed code of the sample.
+	 */
+	int32_t CPcmBuffer::Sample( size_t _stFrame, uint16_t _uiChan ) const {
+		const uint8_t * pui8Src = m_vData.data() + _stFrame * FrameSize() + size_t( _uiChan ) * m_uiBytesPerSample;
+		switch ( m_uiBytesPerSample ) {
+			case 1 : { return ReadCode<1>( pui8Src ); }
+			case 2 : { return ReadCode<2>( pui8Src ); }
+			case 3 : { return ReadCode<3>( pui8Src ); }
+			case 4 : { return ReadCode<4>( pui8Src ); }
+		}
+		return 0;
+	}
+
+	/**
+	 * Sets a sample, saturating to the range of the format.
+	 *
+	 * \param _stFrame The frame holding the sample.  Must be less than Frames().
+	 * \param _uiChan The channel of the sample.  Must be less than Channels().
+	 * \param _i64Code The signed code to store.
+	 */
+	void CPcmBuffer::SetSample( size_t _stFrame, uint16_t _uiChan, int64_t _i64Code ) {
+		uint8_t * pui8Dst = m_vData.data() + _stFrame * FrameSize() + size_t( _uiChan ) * m_uiBytesPerSample;
+		switch ( m_uiBytesPerSample ) {
+			case 1 : { WriteCode<1>( pui8Dst, _i64Code ); break; }
+			case 2 : { WriteCode<2>( pui8Dst, _i64Code ); break; }
+			case 3 : { WriteCode<3>( pui8Dst, _i64Code ); break; }
+			case 4 : { WriteCode<4>( pui8Dst, _i64Code ); break; }
+		}
+	}
+
+	/**
+	 * Inverts the polarity of a channel.  The most negative code saturates to the most positive.
+	 *
+	 * \param _uiChan The channel to invert.
+	 * \return Returns true if the channel exists.
+	 */
+	bool CPcmBuffer::Invert( uint16_t _uiChan ) {
+		if ( _uiChan >= m_uiChannels ) { return false; }
+		Transform( _uiChan, []( int64_t _i64Code ) { return -_i64Code; } );
+		return true;
+	}
+
+	/**
+	 * Inverts the polarity of every channel.  The most negative code saturates to the most positive.
+	 */
+	void CPcmBuffer::Invert() {
+		for ( uint16_t C = 0; C < m_uiChannels; ++C ) { Invert( C ); }
+	}
+
+	/**
+	 * Swaps two channels.
+	 *
+	 * \param _uiChanA The first channel.
+	 * \param _uiChanB The second channel.
+	 * \return Returns true if both channels exist.
+	 */
+	bool CPcmBuffer::SwapChannels( uint16_t _uiChanA, uint16_t _uiChanB ) {
+		if ( _uiChanA >= m_uiChannels || _uiChanB >= m_uiChannels ) { return false; }
+		if ( _uiChanA == _uiChanB ) { return true; }
+		size_t stFrameSize = FrameSize();
+		uint8_t * pui8A = m_vData.data() + size_t( _uiChanA ) * m_uiBytesPerSample;
+		uint8_t * pui8B = m_vData.data() + size_t( _uiChanB ) * m_uiBytesPerSample;
+		for ( size_t I = Frames(); I--; pui8A += stFrameSize, pui8B += stFrameSize ) {
+			std::swap_ranges( pui8A, pui8A + m_uiBytesPerSample, pui8B );
+		}
+		return true;
+	}
+
+	/**
+	 * Multiplies a channel by a power of 2.  Positive powers saturate to the range of the format; negative powers round halves
+	 *	away from zero, as the encoders in CSampleConverter do.
+	 *
+	 * \param _uiChan The channel to scale.
+	 * \param _i32Power The power of 2 by which to multiply.
+	 * \return Returns true if the channel exists.
+	 */
+	bool CPcmBuffer::ScaleByPow2( uint16_t _uiChan, int32_t _i32Power ) {
+		if ( _uiChan >= m_uiChannels ) { return false; }
+		if ( _i32Power > 0 ) {
+			// Anything shifted 32 or more places saturates, so the shift can be capped there without overflowing.
+			int32_t i32Shift = std::min( _i32Power, 32 );
+			Transform( _uiChan, [i32Shift]( int64_t _i64Code ) { return _i64Code * (int64_t( 1 ) << i32Shift); } );
+		}
+		else if ( _i32Power < 0 ) {
+			// Codes are at most 2^31 in magnitude, so shifting 33 or more places always rounds to 0.
+			int32_t i32Shift = static_cast<int32_t>(std::min( -int64_t( _i32Power ), int64_t( 33 ) ));
+			int64_t i64Half = int64_t( 1 ) << (i32Shift - 1);
+			Transform( _uiChan, [i32Shift, i64Half]( int64_t _i64Code ) {
+				return _i64Code < 0 ? -((-_i64Code + i64Half) >> i32Shift) : (_i64Code + i64Half) >> i32Shift;
+			} );
+		}
+		return true;
+	}
+
+	/**
+	 * Multiplies every channel by a power of 2.  Positive powers saturate to the range of the format; negative powers round halves
+	 *	away from zero, as the encoders in CSampleConverter do.
+	 *
+	 * \param _i32Power The power of 2 by which to multiply.
+	 */
+	void CPcmBuffer::ScaleByPow2( int32_t _i32Power ) {
+		for ( uint16_t C = 0; C < m_uiChannels; ++C ) { ScaleByPow2( C, _i32Power ); }
+	}
+
+	/**
+	 * Reverses the order of a range of frames.
+	 *
+	 * \param _stFrom The first frame to reverse.
+	 * \param _stTo The frame after the last frame to reverse.
+	 * \return Returns true if the range is valid.
+	 */
+	bool CPcmBuffer::Reverse( size_t _stFrom, size_t _stTo ) {
+		if ( _stFrom > _stTo || _stTo > Frames() ) { return false; }
+		size_t stFrameSize = FrameSize();
+		uint8_t * pui8Lo = m_vData.data() + _stFrom * stFrameSize;
+		uint8_t * pui8Hi = m_vData.data() + _stTo * stFrameSize;
+		while ( pui8Hi - pui8Lo > ptrdiff_t( stFrameSize ) ) {
+			pui8Hi -= stFrameSize;
+			std::swap_ranges( pui8Lo, pui8Lo + stFrameSize, pui8Hi );
+			pui8Lo += stFrameSize;
+		}
+		return true;
+	}
+
+	/**
+	 * Copies a range of frames into another buffer, replacing its contents.
+	 *
+	 * \param _stFrom The first frame to copy.
+	 * \param _stTo The frame after the last frame to copy.
+	 * \param _pbDst The buffer to receive the frames.  Must not be this buffer.
+	 * \return Returns true if the range is valid and the frames were copied.
+	 */
+	bool CPcmBuffer::Copy( size_t _stFrom, size_t _stTo, CPcmBuffer &_pbDst ) const {
+		if ( &_pbDst == this || _stFrom > _stTo || _stTo > Frames() ) { return false; }
+		size_t stFrameSize = FrameSize();
+		try {
+			_pbDst.m_vData.assign( m_vData.begin() + _stFrom * stFrameSize, m_vData.begin() + _stTo * stFrameSize );
+		}
+		catch ( ... ) { return false; }
+		_pbDst.m_uiChannels = m_uiChannels;
+		_pbDst.m_uiBitsPerSample = m_uiBitsPerSample;
+		_pbDst.m_uiBytesPerSample = m_uiBytesPerSample;
+		return true;
+	}
+
+	/**
+	 * Removes a range of frames.
+	 *
+	 * \param _stFrom The first frame to remove.
+	 * \param _stTo The frame after the last frame to remove.
+	 * \param _ppbDst If not nullptr, receives the removed frames, replacing its contents.  Must not be this buffer.
+	 * \return Returns true if the range is valid and the frames were removed.
+	 */
+	bool CPcmBuffer::Cut( size_t _stFrom, size_t _stTo, CPcmBuffer * _ppbDst ) {
+		if ( _ppbDst == this || _stFrom > _stTo || _stTo > Frames() ) { return false; }
+		if ( _ppbDst && !Copy( _stFrom, _stTo, (*_ppbDst) ) ) { return false; }
+		size_t stFrameSize = FrameSize();
+		m_vData.erase( m_vData.begin() + _stFrom * stFrameSize, m_vData.begin() + _stTo * stFrameSize );
+		return true;
+	}
+
+	/**
+	 * Inserts the frames of another buffer before the given frame.  Both buffers must have the same number of channels and bits per
+	 *	sample, unless this buffer is empty.
+	 *
+	 * \param _stAt The frame before which to insert the frames.  Frames() appends them.
+	 * \param _pbSrc The buffer to insert.  May be this buffer.
+	 * \return Returns true if the frames were inserted.
+	 */
+	bool CPcmBuffer::Insert( size_t _stAt, const CPcmBuffer &_pbSrc ) {
+		if ( _stAt > Frames() ) { return false; }
+		if ( !_pbSrc.m_uiChannels ) { return true; }
+		if ( m_uiChannels && (m_uiChannels != _pbSrc.m_uiChannels || m_uiBitsPerSample != _pbSrc.m_uiBitsPerSample) ) { return false; }
+		try {
+			if ( &_pbSrc == this ) {
+				std::vector<uint8_t> vCopy( m_vData );
+				m_vData.insert( m_vData.begin() + _stAt * FrameSize(), vCopy.begin(), vCopy.end() );
+			}
+			else {
+				m_vData.insert( m_vData.begin() + _stAt * _pbSrc.FrameSize(), _pbSrc.m_vData.begin(), _pbSrc.m_vData.end() );
+			}
+		}
+		catch ( ... ) { return false; }
+		m_uiChannels = _pbSrc.m_uiChannels;
+		m_uiBitsPerSample = _pbSrc.m_uiBitsPerSample;
+		m_uiBytesPerSample = _pbSrc.m_uiBytesPerSample;
+		return true;
+	}
+
+	/**
+	 * Appends a range of decoded frames on every channel to an array of vectors, one per channel.
+	 *
+	 * \param _vResult The array of vectors to which to append the samples.  Resized to the number of channels.
+	 * \param _stFrom The first frame to get.
+	 * \param _stTo The frame after the last frame to get.
+	 * \return Returns true if the vectors were able to fit all samples.  Returns false if the sample format cannot be decoded.
+	 */
+	bool CPcmBuffer::GetSamples( CWavFile::lwaudio &_vResult, size_t _stFrom, size_t _stTo ) const {
+		if ( _stFrom > _stTo || _stTo > Frames() ) { return false; }
+		const CSampleConverter::PW_DECODERS dDecoders = CSampleConverter::Decoders( false, m_uiBitsPerSample, m_uiChannels );
+		if ( !dDecoders.pfDecode ) { return false; }
+		try {
+			_vResult.resize( m_uiChannels );
+			std::vector<double *> vDst( m_uiChannels );
+			for ( auto C = m_uiChannels; C--; ) {
+				size_t stOffset = _vResult[C].size();
+				_vResult[C].resize( stOffset + (_stTo - _stFrom) );
+				vDst[C] = _vResult[C].data() + stOffset;
+			}
+			const uint8_t * pui8Src = m_vData.data() + _stFrom * FrameSize();
+			dDecoders.pfDecode( pui8Src, _stTo - _stFrom, m_uiChannels, vDst.data(), 0 );
+			return true;
+		}
+		catch ( ... ) { return false; }
+	}
+
+	/**
+	 * Saves as a PCM WAV file in the format of the buffer.  The frames are written as they are.
+	 *
+	 * \param _pcPath The path to where the file will be saved.
+	 * \param _wfMeta The file providing the sample rate and metadata.
+	 * \return Returns true if the file was created and saved.
+	 */
+	bool CPcmBuffer::SaveAsPcm( const char8_t * _pcPath, const CWavFile &_wfMeta ) const {
+		if ( !m_uiChannels ) { return false; }
+		std::u8string sPath = CWavFile::SanitizePath( _pcPath );
+
+		CWavFile::PW_SAVE_DATA sdSettings;
+		sdSettings.uiBitsPerSample = m_uiBitsPerSample;
+		CWavStreamWriter wswWriter;
+		if ( !wswWriter.Create( sPath.c_str(), _wfMeta, m_uiChannels, &sdSettings, Frames() ) ) {
+			std::wprintf( L"Failed to create PCM file: %s.\r\n", reinterpret_cast<const wchar_t *>(CUtilities::Utf8ToUtf16( sPath.c_str() ).c_str()) );
+			return false;
+		}
+		if ( !wswWriter.WriteRaw( m_vData.data(), m_vData.size() ) ) { return false; }
+		return wswWriter.Finalize();
+	}
+
+}	// namespace pw
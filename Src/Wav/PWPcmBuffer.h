@@ -0,0 +1,245 @@
+/**
+ * Copyright L. Spiro 2024
+ *
+ * Written by: Shawn (L. Spiro) Wilcoxen
+ *
+ * Description: Interleaved PCM samples in their native integer format, with edits that never convert to floating point.
+ */
+
+
+#pragma once
+
+#include "PWWavFile.h"
+
+#include <vector>
+
+
+namespace pw {
+
+	/**
+	 * Class CPcmBuffer
+	 * \brief Interleaved PCM samples in their native integer format, with edits that never convert to floating point.
+	 *
+	 * Description: Interleaved PCM samples in their native integer format, with edits that never convert to floating point.  The
+	 *	samples are kept as 8-, 16-, 24-, or 32-bit frames exactly as they are in the "data" chunk, and polarity inversion, channel
+	 *	swaps, cuts, splices, reversal, and gain by powers of 2 work on the integer codes directly.  Only attenuation by a power of 2
+	 *	rounds, and only saturation at the limits of the format clips, so the output is otherwise bit-exact and nothing is decoded or
+	 *	re-encoded.
+	 *
+	 * Codes are signed everywhere in this interface; 8-bit samples are stored unsigned as in WAV files and converted on access.
+	 */
+	class CPcmBuffer {
+	public :
+		CPcmBuffer();
+
+
+		// == Functions.
+		/**
+		 * Copies the samples of a loaded PCM file.
+		 *
+		 * \param _wfFile The file whose samples are to be copied.  CWavFile::CanCopySamples() must return true for it.
+		 * \return Returns true if the samples were copied.
+		 */
+		bool															Set( const CWavFile &_wfFile );
+
+		/**
+		 * Empties the buffer.
+		 */
+		void															Reset();
+
+		/**
+		 * Gets the number of frames.
+		 *
+		 * \return Returns the number of frames.
+		 */
+		inline size_t													Frames() const { return m_vData.size() ? m_vData.size() / FrameSize() : 0; }
+
+		/**
+		 * Gets the number of channels.
+		 *
+		 * \return Returns the number of channels.
+		 */
+		inline uint16_t													Channels() const { return m_uiChannels; }
+
+		/**
+		 * Gets the number of bits per sample.
+		 *
+		 * \return Returns the number of bits per sample.
+		 */
+		inline uint16_t													BitsPerSample() const { return m_uiBitsPerSample; }
+
+		/**
+		 * Gets the interleaved frames as they would appear in a "data" chunk.
+		 *
+		 * \return Returns the interleaved frames.
+		 */
+		inline const std::vector<uint8_t> &								Data() const { return m_vData; }
+
+		/**
+		 * Gets a sample.
+		 *
+		 * \param _stFrame The frame holding the sample.  Must be less than Frames().
+		 * \param _uiChan The channel of the sample.  Must be less than Channels().
+		 * \return Returns the signed code of the sample.
+		 */
+		int32_t															Sample( size_t _stFrame, uint16_t _uiChan ) const;
+
+		/**
+		 * Sets a sample, saturating to the range of the format.
+		 *
+		 * \param _stFrame The frame holding the sample.  Must be less than Frames().
+		 * \param _uiChan The channel of the sample.  Must be less than Channels().
+		 * \param _i64Code The signed code to store.
+		 */
+		void															SetSample( size_t _stFrame, uint16_t _uiChan, int64_t _i64Code );
+
+		/**
+		 * Inverts the polarity of a channel.  The most negative code saturates to the most positive.
+		 *
+		 * \param _uiChan The channel to invert.
+		 * \return Returns true if the channel exists.
+		 */
+		bool															Invert( uint16_t _uiChan );
+
+		/**
+		 * Inverts the polarity of every channel.  The most negative code saturates to the most positive.
+		 */
+		void															Invert();
+
+		/**
+		 * Swaps two channels.
+		 *
+		 * \param _uiChanA The first channel.
+		 * \param _uiChanB The second channel.
+		 * \return Returns true if both channels exist.
+		 */
+		bool															SwapChannels( uint16_t _uiChanA, uint16_t _uiChanB );
+
+		/**
+		 * Multiplies a channel by a power of 2.  Positive powers saturate to the range of the format; negative powers round halves
+		 *	away from zero, as the encoders in CSampleConverter do.
+		 *
+		 * \param _uiChan The channel to scale.
+		 * \param _i32Power The power of 2 by which to multiply.
+		 * \return Returns true if the channel exists.
+		 */
+		bool															ScaleByPow2( uint16_t _uiChan, int32_t _i32Power );
+
+		/**
+		 * Multiplies every channel by a power of 2.  Positive powers saturate to the range of the format; negative powers round halves
+		 *	away from zero, as the encoders in CSampleConverter do.
+		 *
+		 * \param _i32Power The power of 2 by which to multiply.
+		 */
+		void															ScaleByPow2( int32_t _i32Power );
+
+		/**
+		 * Reverses the order of a range of frames.
+		 *
+		 * \param _stFrom The first frame to reverse.
+		 * \param _stTo The frame after the last frame to reverse.
+		 * \return Returns true if the range is valid.
+		 */
+		bool															Reverse( size_t _stFrom, size_t _stTo );
+
+		/**
+		 * Copies a range of frames into another buffer, replacing its contents.
+		 *
+		 * \param _stFrom The first frame to copy.
+		 * \param _stTo The frame after the last frame to copy.
+		 * \param _pbDst The buffer to receive the frames.  Must not be this buffer.
+		 * \return Returns true if the range is valid and the frames were copied.
+		 */
+		bool															Copy( size_t _stFrom, size_t _stTo, CPcmBuffer &_pbDst ) const;
+
+		/**
+		 * Removes a range of frames.
+		 *
+		 * \param _stFrom The first frame to remove.
+		 * \param _stTo The frame after the last frame to remove.
+		 * \param _ppbDst If not nullptr, receives the removed frames, replacing its contents.  Must not be this buffer.
+		 * \return Returns true if the range is valid and the frames were removed.
+		 */
+		bool															Cut( size_t _stFrom, size_t _stTo, CPcmBuffer * _ppbDst = nullptr );
+
+		/**
+		 * Inserts the frames of another buffer before the given frame.  Both buffers must have the same number of channels and bits per
+		 *	sample, unless this buffer is empty.
+		 *
+		 * \param _stAt The frame before which to insert the frames.  Frames() appends them.
+		 * \param _pbSrc The buffer to insert.  May be this buffer.
+		 * \return Returns true if the frames were inserted.
+		 */
+		bool															Insert( size_t _stAt, const CPcmBuffer &_pbSrc );
+
+		/**
+		 * Appends the frames of another buffer.  Both buffers must have the same number of channels and bits per sample, unless this
+		 *	buffer is empty.
+		 *
+		 * \param _pbSrc The buffer to append.  May be this buffer.
+		 * \return Returns true if the frames were appended.
+		 */
+		bool															Append( const CPcmBuffer &_pbSrc ) { return Insert( Frames(), _pbSrc ); }
+
+		/**
+		 * Appends a range of decoded frames on every channel to an array of vectors, one per channel.
+		 *
+		 * \param _vResult The array of vectors to which to append the samples.  Resized to the number of channels.
+		 * \param _stFrom The first frame to get.
+		 * \param _stTo The frame after the last frame to get.
+		 * \return Returns true if the vectors were able to fit all samples.  Returns false if the sample format cannot be decoded.
+		 */
+		bool															GetSamples( CWavFile::lwaudio &_vResult, size_t _stFrom, size_t _stTo ) const;
+
+		/**
+		 * Saves as a PCM WAV file in the format of the buffer.  The frames are written as they are.
+		 *
+		 * \param _pcPath The path to where the file will be saved.
+		 * \param _wfMeta The file providing the sample rate and metadata.
+		 * \return Returns true if the file was created and saved.
+		 */
+		bool															SaveAsPcm( const char8_t * _pcPath, const CWavFile &_wfMeta ) const;
+
+		/**
+		 * Saves as a PCM WAV file in the format of the buffer.  The frames are written as they are.
+		 *
+		 * \param _pcPath The path to where the file will be saved.
+		 * \param _wfMeta The file providing the sample rate and metadata.
+		 * \return Returns true if the file was created and saved.
+		 */
+		bool															SaveAsPcm( const char16_t * _pcPath, const CWavFile &_wfMeta ) const {
+			return SaveAsPcm( CUtilities::Utf16ToUtf8( _pcPath ).c_str(), _wfMeta );
+		}
+
+
+	protected :
+		// == Members.
+		/** The interleaved frames. */
+		std::vector<uint8_t>											m_vData;
+		/** The number of channels. */
+		uint16_t														m_uiChannels;
+		/** The bits per sample. */
+		uint16_t														m_uiBitsPerSample;
+		/** The bytes per sample. */
+		uint16_t														m_uiBytesPerSample;
+
+
+		// == Functions.
+		/**
+		 * Gets the size of a frame in bytes.
+		 *
+		 * \return Returns the size of a frame in bytes.
+		 */
+		inline size_t													FrameSize() const { return size_t( m_uiChannels ) * m_uiBytesPerSample; }
+
+		/**
+		 * Replaces every sample of a channel with the result of a function of its signed code, saturating the result.
+		 *
+		 * \param _uiChan The channel to modify.
+		 * \param _fFunc The function, taking and returning an int64_t.
+		 */
+		template <typename _tFunc>
+		void															Transform( uint16_t _uiChan, _tFunc _fFunc );
+	};
+
+}	// namespace pw
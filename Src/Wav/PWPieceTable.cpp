@@ -0,0 +1,342 @@
+/**
+ * Copyright L. Spiro 2024
+ *
+ * Written by: Shawn (L. Spiro) Wilcoxen
+ *
+ * Description: Audio stored as a list of pieces referencing loaded WAV files and added buffers, for cheap cut, insert, and paste.
+ */
+
+#include "PWPieceTable.h"
+#include "PWWavStreamWriter.h"
+
+#include <algorithm>
+
+
+namespace pw {
+
+	CPieceTable::CPieceTable() :
+		m_pwfFormat( nullptr ),
+		m_stFrames( 0 ),
+		m_uiChannels( 0 ) {
+	}
+	CPieceTable::CPieceTable( const CWavFile &_wfFile ) :
+		m_pwfFormat( nullptr ),
+		m_stFrames( 0 ),
+		m_uiChannels( 0 ) {
+		Set( _wfFile );
+	}
+
+	// == Functions.
+	/**
+	 * Replaces the contents of the table with the whole of a loaded file.  The file also provides the format and metadata used by
+	 *	SaveAsPcm().
+	 *
+	 * \param _wfFile The file to reference.
+	 * \return Returns true if the file has samples that can be decoded.
+	 */
+	bool CPieceTable::Set( const CWavFile &_wfFile ) {
+		Reset();
+		return Append( _wfFile );
+	}
+
+	/**
+	 * Empties the table.
+	 */
+	void CPieceTable::Reset() {
+		m_vPieces.clear();
+		m_pwfFormat = nullptr;
+		m_stFrames = 0;
+		m_uiChannels = 0;
+	}
+
+	/**
+	 * Inserts a copy of new samples before the given frame.
+	 *
+	 * \param _stAt The frame before which to insert the samples.  Frames() appends them.
+	 * \param _vSamples The samples to insert.  Must have Channels() tracks of the same length, unless the table is empty.
+	 * \return Returns true if the samples were inserted.
+	 */
+	bool CPieceTable::Insert( size_t _stAt, const CWavFile::lwaudio &_vSamples ) {
+		try {
+			CWavFile::lwaudio aCopy( _vSamples );
+			return Insert( _stAt, std::move( aCopy ) );
+		}
+		catch ( ... ) { return false; }
+	}
+
+	/**
+	 * Inserts new samples before the given frame, taking ownership of them.
+	 *
+	 * \param _stAt The frame before which to insert the samples.  Frames() appends them.
+	 * \param _vSamples The samples to insert.  Must have Channels() tracks of the same length, unless the table is empty.
+	 * \return Returns true if the samples were inserted.  On failure, _vSamples is left unchanged.
+	 */
+	bool CPieceTable::Insert( size_t _stAt, CWavFile::lwaudio &&_vSamples ) {
+		if ( !_vSamples.size() || _vSamples.size() > UINT16_MAX ) { return false; }
+		size_t stFrames = _vSamples[0].size();
+		for ( auto C = _vSamples.size(); C--; ) {
+			if ( _vSamples[C].size() != stFrames ) { return false; }
+		}
+		std::shared_ptr<CWavFile::lwaudio> psBuffer;
+		try {
+			psBuffer = std::make_shared<CWavFile::lwaudio>( std::move( _vSamples ) );
+			std::vector<PW_PIECE> vPieces( 1, PW_PIECE{ nullptr, psBuffer, 0, stFrames } );
+			if ( InsertPieces( _stAt, vPieces, static_cast<uint16_t>(psBuffer->size()), nullptr ) ) { return true; }
+		}
+		catch ( ... ) {}
+		// Hand the samples back.
+		if ( psBuffer ) { _vSamples = std::move( (*psBuffer) ); }
+		return false;
+	}
+
+	/**
+	 * Inserts the contents of another table before the given frame.  The pieces are shared, not copied.
+	 *
+	 * \param _stAt The frame before which to insert the samples.  Frames() appends them.
+	 * \param _ptSrc The table to insert.  May be this table.  Must have Channels() channels, unless this table is empty, and the
+	 *	Hz and sample format of the files already in this table.
+	 * \return Returns true if the samples were inserted.
+	 */
+	bool CPieceTable::Insert( size_t _stAt, const CPieceTable &_ptSrc ) {
+		if ( !_ptSrc.m_stFrames ) { return _stAt <= m_stFrames; }
+		try {
+			// Copy the list first in case _ptSrc is this table.
+			std::vector<PW_PIECE> vPieces( _ptSrc.m_vPieces );
+			return InsertPieces( _stAt, vPieces, _ptSrc.m_uiChannels, _ptSrc.m_pwfFormat );
+		}
+		catch ( ... ) { return false; }
+	}
+
+	/**
+	 * Appends the whole of a loaded file.
+	 *
+	 * \param _wfFile The file to append.  Must have Channels() channels, unless the table is empty, and the Hz and sample format of
+	 *	the files already in the table.
+	 * \return Returns true if the samples were appended.
+	 */
+	bool CPieceTable::Append( const CWavFile &_wfFile ) {
+		size_t stFrames = FileFrames( _wfFile );
+		if ( !stFrames ) { return false; }
+		try {
+			std::vector<PW_PIECE> vPieces;
+			vPieces.push_back( PW_PIECE{ &_wfFile, nullptr, 0, stFrames } );
+			return InsertPieces( m_stFrames, vPieces, _wfFile.Channels(), &_wfFile );
+		}
+		catch ( ... ) { return false; }
+	}
+
+	/**
+	 * Copies a range of frames into another table, replacing its contents.  The pieces are shared, not copied.
+	 *
+	 * \param _stFrom The first frame to copy.
+	 * \param _stTo The frame after the last frame to copy.
+	 * \param _ptDst The table to receive the frames.  Must not be this table.
+	 * \return Returns true if the range is valid and the frames were copied.
+	 */
+	bool CPieceTable::Copy( size_t _stFrom, size_t _stTo, CPieceTable &_ptDst ) const {
+		if ( &_ptDst == this || _stFrom > _stTo || _stTo > m_stFrames ) { return false; }
+		try {
+			std::vector<PW_PIECE> vPieces;
+			size_t stPos = 0;
+			for ( const auto & pPiece : m_vPieces ) {
+				size_t stEnd = stPos + pPiece.stFrames;
+				if ( stEnd > _stFrom && stPos < _stTo ) {
+					// Trim the piece to the part inside [_stFrom,_stTo).
+					size_t stSkip = _stFrom > stPos ? _stFrom - stPos : 0;
+					vPieces.push_back( pPiece );
+					vPieces.back().stStart += stSkip;
+					vPieces.back().stFrames = std::min( stEnd, _stTo ) - stPos - stSkip;
+				}
+				if ( stEnd >= _stTo ) { break; }
+				stPos = stEnd;
+			}
+			_ptDst.m_vPieces.swap( vPieces );
+			_ptDst.m_pwfFormat = m_pwfFormat;
+			_ptDst.m_stFrames = _stTo - _stFrom;
+			_ptDst.m_uiChannels = m_uiChannels;
+			return true;
+		}
+		catch ( ... ) { return false; }
+	}
+
+	/**
+	 * Removes a range of frames.
+	 *
+	 * \param _stFrom The first frame to remove.
+	 * \param _stTo The frame after the last frame to remove.
+	 * \param _pptDst If not nullptr, receives the removed frames, replacing its contents.  Must not be this table.
+	 * \return Returns true if the range is valid and the frames were removed.
+	 */
+	bool CPieceTable::Cut( size_t _stFrom, size_t _stTo, CPieceTable * _pptDst ) {
+		if ( _pptDst == this || _stFrom > _stTo || _stTo > m_stFrames ) { return false; }
+		if ( _pptDst && !Copy( _stFrom, _stTo, (*_pptDst) ) ) { return false; }
+		if ( _stFrom == _stTo ) { return true; }
+		try {
+			// Split() inserts at most one piece per call, so reserve room for both up front to keep the erase from failing halfway.
+			m_vPieces.reserve( m_vPieces.size() + 2 );
+		}
+		catch ( ... ) { return false; }
+		size_t stFirst = Split( _stFrom );
+		size_t stLast = Split( _stTo );
+		m_vPieces.erase( m_vPieces.begin() + stFirst, m_vPieces.begin() + stLast );
+		m_stFrames -= _stTo - _stFrom;
+		return true;
+	}
+
+	/**
+	 * Appends a range of decoded frames on every channel to an array of vectors, one per channel.
+	 *
+	 * \param _vResult The array of vectors to which to append the samples.  Resized to the number of channels.
+	 * \param _stFrom The first frame to get.
+	 * \param _stTo The frame after the last frame to get.
+	 * \return Returns true if the vectors were able to fit all samples.
+	 */
+	bool CPieceTable::GetSamples( CWavFile::lwaudio &_vResult, size_t _stFrom, size_t _stTo ) const {
+		if ( _stFrom > _stTo || _stTo > m_stFrames ) { return false; }
+		try {
+			_vResult.resize( m_uiChannels );
+			std::vector<size_t> vOffsets( m_uiChannels );
+			for ( auto C = m_uiChannels; C--; ) {
+				vOffsets[C] = _vResult[C].size();
+			}
+			size_t stPos = 0;
+			for ( const auto & pPiece : m_vPieces ) {
+				size_t stEnd = stPos + pPiece.stFrames;
+				if ( stEnd > _stFrom && stPos < _stTo ) {
+					size_t stStart = pPiece.stStart + (_stFrom > stPos ? _stFrom - stPos : 0);
+					size_t stStop = pPiece.stStart + (std::min( stEnd, _stTo ) - stPos);
+					if ( pPiece.pwfFile ) {
+						if ( !pPiece.pwfFile->GetSamples( _vResult, stStart, stStop ) ) {
+							for ( auto C = m_uiChannels; C--; ) {
+								_vResult[C].resize( vOffsets[C] );
+							}
+							return false;
+						}
+					}
+					else {
+						for ( auto C = m_uiChannels; C--; ) {
+							_vResult[C].insert( _vResult[C].end(), (*pPiece.psBuffer)[C].begin() + stStart, (*pPiece.psBuffer)[C].begin() + stStop );
+						}
+					}
+				}
+				if ( stEnd >= _stTo ) { break; }
+				stPos = stEnd;
+			}
+			return true;
+		}
+		catch ( ... ) { return false; }
+	}
+
+	/**
+	 * Saves as a PCM or IEEE float WAV file.  The format and metadata come from the first file referenced by the table.  Spans of a
+	 *	file whose format matches the output are copied verbatim; everything else is encoded a block at a time.
+	 *
+	 * \param _pcPath The path to where the file will be saved.
+	 * \param _psdSaveSettings Settings to override the format file's settings.
+	 * \return Returns true if the file was created and saved.
+	 */
+	bool CPieceTable::SaveAsPcm( const char8_t * _pcPath, const CWavFile::PW_SAVE_DATA * _psdSaveSettings ) const {
+		if ( nullptr == m_pwfFormat || !m_stFrames ) { return false; }
+		std::u8string sPath = CWavFile::SanitizePath( _pcPath );
+
+		CWavStreamWriter wswWriter;
+		if ( !wswWriter.Create( sPath.c_str(), (*m_pwfFormat), m_uiChannels, _psdSaveSettings, m_stFrames ) ) {
+			std::wprintf( L"Failed to create PCM file: %s.\r\n", reinterpret_cast<const wchar_t *>(CUtilities::Utf8ToUtf16( sPath.c_str() ).c_str()) );
+			return false;
+		}
+		// The output format, spelled out so that each piece can be checked against it.
+		CWavFile::PW_SAVE_DATA sdOutput = _psdSaveSettings ? (*_psdSaveSettings) : CWavFile::PW_SAVE_DATA();
+		sdOutput.uiBitsPerSample = m_pwfFormat->OutputBits( _psdSaveSettings );
+
+		size_t stBlock = CWavStreamWriter::PW_D_BLOCK_FRAMES * m_pwfFormat->Threads();
+		CWavFile::lwaudio aBlock;
+		for ( const auto & pPiece : m_vPieces ) {
+			if ( pPiece.pwfFile && pPiece.pwfFile->CanCopySamples( &sdOutput ) ) {
+				// Already in the output format.
+				size_t stFrameSize = size_t( m_uiChannels ) * pPiece.pwfFile->m_uiBytesPerSample;
+				if ( !wswWriter.WriteRaw( pPiece.pwfFile->m_pui8Samples + pPiece.stStart * stFrameSize, pPiece.stFrames * stFrameSize ) ) { return false; }
+				continue;
+			}
+			for ( size_t I = 0; I < pPiece.stFrames; I += stBlock ) {
+				size_t stFrom = pPiece.stStart + I;
+				size_t stTo = pPiece.stStart + std::min( I + stBlock, pPiece.stFrames );
+				if ( pPiece.pwfFile ) {
+					for ( auto C = aBlock.size(); C--; ) {
+						aBlock[C].clear();
+					}
+					if ( !pPiece.pwfFile->GetSamples( aBlock, stFrom, stTo ) || !wswWriter.WriteBlock( aBlock ) ) { return false; }
+				}
+				else if ( !wswWriter.WriteBlock( (*pPiece.psBuffer), stFrom, stTo ) ) { return false; }
+			}
+		}
+		return wswWriter.Finalize();
+	}
+
+	/**
+	 * Makes sure a piece starts at the given frame, splitting the piece containing it if necessary.
+	 *
+	 * \param _stAt The frame at which a piece must start.  Must not exceed Frames().
+	 * \return Returns the index of the piece starting at _stAt, or Pieces() if _stAt is Frames().
+	 */
+	size_t CPieceTable::Split( size_t _stAt ) {
+		size_t stPos = 0;
+		for ( size_t I = 0; I < m_vPieces.size(); ++I ) {
+			if ( stPos == _stAt ) { return I; }
+			size_t stEnd = stPos + m_vPieces[I].stFrames;
+			if ( _stAt < stEnd ) {
+				PW_PIECE pTail = m_vPieces[I];
+				pTail.stStart += _stAt - stPos;
+				pTail.stFrames = stEnd - _stAt;
+				m_vPieces[I].stFrames = _stAt - stPos;
+				m_vPieces.insert( m_vPieces.begin() + I + 1, pTail );
+				return I + 1;
+			}
+			stPos = stEnd;
+		}
+		return m_vPieces.size();
+	}
+
+	/**
+	 * Inserts pieces before the given frame.
+	 *
+	 * \param _stAt The frame before which to insert the pieces.
+	 * \param _vPieces The pieces to insert.
+	 * \param _uiChannels The number of channels in the pieces.
+	 * \param _pwfFormat The file providing the format of the pieces, or nullptr.
+	 * \return Returns true if the pieces were inserted.  Fails if _pwfFormat differs from the table's file in Hz or sample format.
+	 */
+	bool CPieceTable::InsertPieces( size_t _stAt, const std::vector<PW_PIECE> &_vPieces, uint16_t _uiChannels, const CWavFile * _pwfFormat ) {
+		if ( _stAt > m_stFrames || !_uiChannels ) { return false; }
+		if ( m_uiChannels && _uiChannels != m_uiChannels ) { return false; }
+		// The output takes its rate and format from one file, and nothing is resampled, so every file must share them.
+		if ( m_pwfFormat && _pwfFormat && (_pwfFormat->Hz() != m_pwfFormat->Hz() || _pwfFormat->Format() != m_pwfFormat->Format() ||
+			_pwfFormat->BitsPerSample() != m_pwfFormat->BitsPerSample()) ) { return false; }
+		size_t stFrames = 0;
+		for ( const auto & pPiece : _vPieces ) {
+			stFrames += pPiece.stFrames;
+		}
+		try {
+			// Room for the split and the new pieces, so that nothing below can throw.
+			m_vPieces.reserve( m_vPieces.size() + 1 + _vPieces.size() );
+		}
+		catch ( ... ) { return false; }
+		size_t stIdx = Split( _stAt );
+		m_vPieces.insert( m_vPieces.begin() + stIdx, _vPieces.begin(), _vPieces.end() );
+		m_stFrames += stFrames;
+		m_uiChannels = _uiChannels;
+		if ( nullptr == m_pwfFormat ) { m_pwfFormat = _pwfFormat; }
+		return true;
+	}
+
+	/**
+	 * Determines whether a file's frames can be decoded and counts them.
+	 *
+	 * \param _wfFile The file to check.
+	 * \return Returns the number of frames in the file, or 0 if it has none or they cannot be decoded.
+	 */
+	size_t CPieceTable::FileFrames( const CWavFile &_wfFile ) {
+		if ( !_wfFile.Channels() || _wfFile.BitsPerSample() < 8 ) { return 0; }
+		return size_t( _wfFile.TotalSamples() );
+	}
+
+}	// namespace pw
@@ -0,0 +1,223 @@
+/**
+ * Copyright L. Spiro 2024
+ *
+ * Written by: Shawn (L. Spiro) Wilcoxen
+ *
+ * Description: Audio stored as a list of pieces referencing loaded WAV files and added buffers, for cheap cut, insert, and paste.
+ */
+
+
+#pragma once
+
+#include "PWWavFile.h"
+
+#include <memory>
+#include <vector>
+
+
+namespace pw {
+
+	/**
+	 * Class CPieceTable
+	 * \brief Audio stored as a list of pieces referencing loaded WAV files and added buffers, for cheap cut, insert, and paste.
+	 *
+	 * Description: Audio stored as a list of pieces referencing loaded WAV files and added buffers, for cheap cut, insert, and paste.
+	 *	Each piece is a span of frames either in the raw sample data of a CWavFile or in a buffer of doubles added with Insert().
+	 *	Cutting, copying, inserting, and concatenating only edit the list of pieces; no samples are decoded or copied, and added
+	 *	buffers are shared between the tables that reference them.  SaveAsPcm() streams the pieces out in order, copying spans of a
+	 *	file verbatim when the output format matches it and encoding everything else.
+	 *
+	 * Every CWavFile referenced must outlive the table and any table pieces are pasted into.
+	 */
+	class CPieceTable {
+	public :
+		CPieceTable();
+		explicit CPieceTable( const CWavFile &_wfFile );
+
+
+		// == Functions.
+		/**
+		 * Replaces the contents of the table with the whole of a loaded file.  The file also provides the format and metadata used by
+		 *	SaveAsPcm().
+		 *
+		 * \param _wfFile The file to reference.
+		 * \return Returns true if the file has samples that can be decoded.
+		 */
+		bool															Set( const CWavFile &_wfFile );
+
+		/**
+		 * Empties the table.
+		 */
+		void															Reset();
+
+		/**
+		 * Gets the number of frames in the table.
+		 *
+		 * \return Returns the number of frames in the table.
+		 */
+		inline size_t													Frames() const { return m_stFrames; }
+
+		/**
+		 * Gets the number of channels.
+		 *
+		 * \return Returns the number of channels, or 0 if the table has never held any samples.
+		 */
+		inline uint16_t													Channels() const { return m_uiChannels; }
+
+		/**
+		 * Gets the number of pieces in the table.
+		 *
+		 * \return Returns the number of pieces in the table.
+		 */
+		inline size_t													Pieces() const { return m_vPieces.size(); }
+
+		/**
+		 * Inserts a copy of new samples before the given frame.
+		 *
+		 * \param _stAt The frame before which to insert the samples.  Frames() appends them.
+		 * \param _vSamples The samples to insert.  Must have Channels() tracks of the same length, unless the table is empty.
+		 * \return Returns true if the samples were inserted.
+		 */
+		bool															Insert( size_t _stAt, const CWavFile::lwaudio &_vSamples );
+
+		/**
+		 * Inserts new samples before the given frame, taking ownership of them.
+		 *
+		 * \param _stAt The frame before which to insert the samples.  Frames() appends them.
+		 * \param _vSamples The samples to insert.  Must have Channels() tracks of the same length, unless the table is empty.
+		 * \return Returns true if the samples were inserted.  On failure, _vSamples is left unchanged.
+		 */
+		bool															Insert( size_t _stAt, CWavFile::lwaudio &&_vSamples );
+
+		/**
+		 * Inserts the contents of another table before the given frame.  The pieces are shared, not copied.
+		 *
+		 * \param _stAt The frame before which to insert the samples.  Frames() appends them.
+		 * \param _ptSrc The table to insert.  May be this table.  Must have Channels() channels, unless this table is empty, and the
+		 *	Hz and sample format of the files already in this table.
+		 * \return Returns true if the samples were inserted.
+		 */
+		bool															Insert( size_t _stAt, const CPieceTable &_ptSrc );
+
+		/**
+		 * Appends the contents of another table.  The pieces are shared, not copied.
+		 *
+		 * \param _ptSrc The table to append.  May be this table.
+		 * \return Returns true if the samples were appended.
+		 */
+		bool															Append( const CPieceTable &_ptSrc ) { return Insert( m_stFrames, _ptSrc ); }
+
+		/**
+		 * Appends the whole of a loaded file.
+		 *
+		 * \param _wfFile The file to append.  Must have Channels() channels, unless the table is empty, and the Hz and sample format of
+		 *	the files already in the table.
+		 * \return Returns true if the samples were appended.
+		 */
+		bool															Append( const CWavFile &_wfFile );
+
+		/**
+		 * Copies a range of frames into another table, replacing its contents.  The pieces are shared, not copied.
+		 *
+		 * \param _stFrom The first frame to copy.
+		 * \param _stTo The frame after the last frame to copy.
+		 * \param _ptDst The table to receive the frames.  Must not be this table.
+		 * \return Returns true if the range is valid and the frames were copied.
+		 */
+		bool															Copy( size_t _stFrom, size_t _stTo, CPieceTable &_ptDst ) const;
+
+		/**
+		 * Removes a range of frames.
+		 *
+		 * \param _stFrom The first frame to remove.
+		 * \param _stTo The frame after the last frame to remove.
+		 * \param _pptDst If not nullptr, receives the removed frames, replacing its contents.  Must not be this table.
+		 * \return Returns true if the range is valid and the frames were removed.
+		 */
+		bool															Cut( size_t _stFrom, size_t _stTo, CPieceTable * _pptDst = nullptr );
+
+		/**
+		 * Appends a range of decoded frames on every channel to an array of vectors, one per channel.
+		 *
+		 * \param _vResult The array of vectors to which to append the samples.  Resized to the number of channels.
+		 * \param _stFrom The first frame to get.
+		 * \param _stTo The frame after the last frame to get.
+		 * \return Returns true if the vectors were able to fit all samples.
+		 */
+		bool															GetSamples( CWavFile::lwaudio &_vResult, size_t _stFrom, size_t _stTo ) const;
+
+		/**
+		 * Saves as a PCM or IEEE float WAV file.  The format and metadata come from the first file referenced by the table.  Spans of a
+		 *	file whose format matches the output are copied verbatim; everything else is encoded a block at a time.
+		 *
+		 * \param _pcPath The path to where the file will be saved.
+		 * \param _psdSaveSettings Settings to override the format file's settings.
+		 * \return Returns true if the file was created and saved.
+		 */
+		bool															SaveAsPcm( const char8_t * _pcPath, const CWavFile::PW_SAVE_DATA * _psdSaveSettings = nullptr ) const;
+
+		/**
+		 * Saves as a PCM or IEEE float WAV file.  The format and metadata come from the first file referenced by the table.  Spans of a
+		 *	file whose format matches the output are copied verbatim; everything else is encoded a block at a time.
+		 *
+		 * \param _pcPath The path to where the file will be saved.
+		 * \param _psdSaveSettings Settings to override the format file's settings.
+		 * \return Returns true if the file was created and saved.
+		 */
+		bool															SaveAsPcm( const char16_t * _pcPath, const CWavFile::PW_SAVE_DATA * _psdSaveSettings = nullptr ) const {
+			return SaveAsPcm( CUtilities::Utf16ToUtf8( _pcPath ).c_str(), _psdSaveSettings );
+		}
+
+
+	protected :
+		// == Types.
+		/** A span of frames in a file or in an added buffer. */
+		struct PW_PIECE {
+			const CWavFile *											pwfFile;				// The file holding the frames, or nullptr if they are in psBuffer.
+			std::shared_ptr<const CWavFile::lwaudio>					psBuffer;				// The added buffer holding the frames, if pwfFile is nullptr.
+			size_t														stStart;				// The first frame of the piece within its file or buffer.
+			size_t														stFrames;				// The number of frames in the piece.
+		};
+
+
+		// == Members.
+		/** The pieces, in order. */
+		std::vector<PW_PIECE>											m_vPieces;
+		/** The file providing the format and metadata when saving. */
+		const CWavFile *												m_pwfFormat;
+		/** The total number of frames. */
+		size_t															m_stFrames;
+		/** The number of channels. */
+		uint16_t														m_uiChannels;
+
+
+		// == Functions.
+		/**
+		 * Makes sure a piece starts at the given frame, splitting the piece containing it if necessary.
+		 *
+		 * \param _stAt The frame at which a piece must start.  Must not exceed Frames().
+		 * \return Returns the index of the piece starting at _stAt, or Pieces() if _stAt is Frames().
+		 */
+		size_t															Split( size_t _stAt );
+
+		/**
+		 * Inserts pieces before the given frame.
+		 *
+		 * \param _stAt The frame before which to insert the pieces.
+		 * \param _vPieces The pieces to insert.
+		 * \param _uiChannels The number of channels in the pieces.
+		 * \param _pwfFormat The file providing the format of the pieces, or nullptr.
+		 * \return Returns true if the pieces were inserted.  Fails if _pwfFormat differs from the table's file in Hz or sample format.
+		 */
+		bool															InsertPieces( size_t _stAt, const std::vector<PW_PIECE> &_vPieces, uint16_t _uiChannels, const CWavFile * _pwfFormat );
+
+		/**
+		 * Determines whether a file's frames can be decoded and counts them.
+		 *
+		 * \param _wfFile The file to check.
+		 * \return Returns the number of frames in the file, or 0 if it has none or they cannot be decoded.
+		 */
+		static size_t													FileFrames( const CWavFile &_wfFile );
+	};
+
+}	// namespace pw
@@ -0,0 +1,234 @@
+/**
+ * Copyright L. Spiro 2024
+ *
+ * Written by: Shawn (L. Spiro) Wilcoxen
+ *
+ * Description: Planar samples for every channel of a file in a single aligned block.
+ */
+
+
+#pragma once
+
+#include "../Utilities/PWAlignmentAllocator.h"
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+
+namespace pw {
+
+	/**
+	 * Class CPlanarBuffer
+	 * \brief Planar samples for every channel of a file in a single aligned block.
+	 *
+	 * Description: Planar samples for every channel of a file in a single aligned block.  Each channel starts Stride() samples after
+	 *	the one before it, and the stride is padded to a whole number of PW_D_ALIGN-byte cache lines, so every channel is aligned for
+	 *	the widest vectors and a vector loop over several channels at once never needs a scalar head.  The padding after the frames of
+	 *	each channel is zeroed, so a loop may also run to the end of the last vector without a scalar tail.
+	 *
+	 * Channels are returned as std::span, and size() and operator[] mirror lwaudio_t, so code written for a vector of tracks can take
+	 *	either.  The block is reused by Resize() whenever it is large enough, so a buffer kept from file to file allocates only when a
+	 *	file is larger than any before it.
+	 */
+	template <typename _tType>
+	class CPlanarBuffer {
+	public :
+		CPlanarBuffer() :
+			m_ptData( nullptr ),
+			m_stCapacity( 0 ),
+			m_stFrames( 0 ),
+			m_stStride( 0 ),
+			m_uiChannels( 0 ) {
+		}
+		CPlanarBuffer( CPlanarBuffer &&_pbOther ) noexcept :
+			m_ptData( _pbOther.m_ptData ),
+			m_stCapacity( _pbOther.m_stCapacity ),
+			m_stFrames( _pbOther.m_stFrames ),
+			m_stStride( _pbOther.m_stStride ),
+			m_uiChannels( _pbOther.m_uiChannels ) {
+			_pbOther.m_ptData = nullptr;
+			_pbOther.m_stCapacity = _pbOther.m_stFrames = _pbOther.m_stStride = 0;
+			_pbOther.m_uiChannels = 0;
+		}
+		CPlanarBuffer( const CPlanarBuffer & ) = delete;
+		~CPlanarBuffer() {
+			CAlignmentAllocatorBase::Free( m_ptData );
+		}
+
+
+		// == Enumerations.
+		/** Defaults. */
+		enum PW_DEFAULTS : size_t {
+			PW_D_ALIGN													= 64,					// The alignment of every channel and the multiple to which the stride is padded.
+		};
+
+
+		// == Types.
+		/** A channel, as returned by operator[]. */
+		typedef std::span<_tType>										value_type;
+
+
+		// == Operators.
+		/**
+		 * Moves another buffer into this one.
+		 *
+		 * \param _pbOther The buffer to move.  Left empty.
+		 * \return Returns a reference to this buffer.
+		 */
+		CPlanarBuffer &													operator = ( CPlanarBuffer &&_pbOther ) noexcept {
+			if ( this != &_pbOther ) {
+				CAlignmentAllocatorBase::Free( m_ptData );
+				m_ptData = _pbOther.m_ptData;
+				m_stCapacity = _pbOther.m_stCapacity;
+				m_stFrames = _pbOther.m_stFrames;
+				m_stStride = _pbOther.m_stStride;
+				m_uiChannels = _pbOther.m_uiChannels;
+				_pbOther.m_ptData = nullptr;
+				_pbOther.m_stCapacity = _pbOther.m_stFrames = _pbOther.m_stStride = 0;
+				_pbOther.m_uiChannels = 0;
+			}
+			return (*this);
+		}
+
+		CPlanarBuffer &													operator = ( const CPlanarBuffer & ) = delete;
+
+		/**
+		 * Gets a channel.
+		 *
+		 * \param _stChan The channel to get.  Must be less than Channels().
+		 * \return Returns the Frames() samples of the channel.
+		 */
+		inline std::span<_tType>										operator [] ( size_t _stChan ) { return Channel( _stChan ); }
+
+		/**
+		 * Gets a channel.
+		 *
+		 * \param _stChan The channel to get.  Must be less than Channels().
+		 * \return Returns the Frames() samples of the channel.
+		 */
+		inline std::span<const _tType>									operator [] ( size_t _stChan ) const { return Channel( _stChan ); }
+
+
+		// == Functions.
+		/**
+		 * Sets the number of channels and frames.  The samples are not kept and must be written before they are read, except for the
+		 *	padding after the frames of each channel, which is zeroed.
+		 *
+		 * \param _uiChannels The number of channels.
+		 * \param _stFrames The number of frames.
+		 * \return Returns true if the block could be allocated.  On failure the buffer is left empty.
+		 */
+		bool															Resize( uint16_t _uiChannels, size_t _stFrames ) {
+			constexpr size_t stPerLine = PW_D_ALIGN / sizeof( _tType );
+			if ( _stFrames > (SIZE_MAX - (stPerLine - 1)) ) {
+				Reset();
+				return false;
+			}
+			size_t stStride = (_stFrames + (stPerLine - 1)) / stPerLine * stPerLine;
+			if ( _uiChannels && stStride > SIZE_MAX / sizeof( _tType ) / _uiChannels ) {
+				Reset();
+				return false;
+			}
+			size_t stSize = stStride * _uiChannels * sizeof( _tType );
+			if ( stSize > m_stCapacity ) {
+				Reset();
+				m_ptData = static_cast<_tType *>(CAlignmentAllocatorBase::Allocate( stSize, PW_D_ALIGN ));
+				if ( !m_ptData ) { return false; }
+				m_stCapacity = stSize;
+			}
+			m_stFrames = _stFrames;
+			m_stStride = stStride;
+			m_uiChannels = _uiChannels;
+			if ( stStride != _stFrames ) {
+				for ( auto C = m_uiChannels; C--; ) {
+					std::memset( m_ptData + C * m_stStride + m_stFrames, 0, (m_stStride - m_stFrames) * sizeof( _tType ) );
+				}
+			}
+			return true;
+		}
+
+		/**
+		 * Frees the block and empties the buffer.
+		 */
+		void															Reset() {
+			CAlignmentAllocatorBase::Free( m_ptData );
+			m_ptData = nullptr;
+			m_stCapacity = m_stFrames = m_stStride = 0;
+			m_uiChannels = 0;
+		}
+
+		/**
+		 * Gets a channel.
+		 *
+		 * \param _stChan The channel to get.  Must be less than Channels().
+		 * \return Returns the Frames() samples of the channel.
+		 */
+		inline std::span<_tType>										Channel( size_t _stChan ) { return std::span<_tType>( m_ptData + _stChan * m_stStride, m_stFrames ); }
+
+		/**
+		 * Gets a channel.
+		 *
+		 * \param _stChan The channel to get.  Must be less than Channels().
+		 * \return Returns the Frames() samples of the channel.
+		 */
+		inline std::span<const _tType>									Channel( size_t _stChan ) const { return std::span<const _tType>( m_ptData + _stChan * m_stStride, m_stFrames ); }
+
+		/**
+		 * Gets the number of channels.
+		 *
+		 * \return Returns the number of channels.
+		 */
+		inline uint16_t													Channels() const { return m_uiChannels; }
+
+		/**
+		 * Gets the number of channels.  The same as Channels(), named to match lwaudio_t.
+		 *
+		 * \return Returns the number of channels.
+		 */
+		inline size_t													size() const { return m_uiChannels; }
+
+		/**
+		 * Gets the number of frames.
+		 *
+		 * \return Returns the number of frames.
+		 */
+		inline size_t													Frames() const { return m_stFrames; }
+
+		/**
+		 * Gets the distance in samples from the start of one channel to the start of the next.
+		 *
+		 * \return Returns the distance in samples from the start of one channel to the start of the next.
+		 */
+		inline size_t													Stride() const { return m_stStride; }
+
+		/**
+		 * Gets the block.  Channel C starts at Data() + C * Stride().
+		 *
+		 * \return Returns the block, or nullptr if nothing has been allocated.
+		 */
+		inline _tType *													Data() { return m_ptData; }
+
+		/**
+		 * Gets the block.  Channel C starts at Data() + C * Stride().
+		 *
+		 * \return Returns the block, or nullptr if nothing has been allocated.
+		 */
+		inline const _tType *											Data() const { return m_ptData; }
+
+
+	protected :
+		// == Members.
+		/** The block holding every channel. */
+		_tType *														m_ptData;
+		/** The size of the block in bytes. */
+		size_t															m_stCapacity;
+		/** The number of frames. */
+		size_t															m_stFrames;
+		/** The distance in samples from the start of one channel to the start of the next. */
+		size_t															m_stStride;
+		/** The number of channels. */
+		uint16_t														m_uiChannels;
+	};
+
+}	// namespace pw
@@ -0,0 +1,673 @@
+/**
+ * Copyright L. Spiro 2024
+ *
+ * Written by: Shawn (L. Spiro) Wilcoxen
+ *
+ * Description: Converts between interleaved PCM/float sample data and per-channel tracks of doubles.
+ */
+
+#include "PWSampleConverter.h"
+#include "../Utilities/PWUtilities.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+
+namespace pw {
+
+	// == Members.
+	/** The widest SIMD tier conversions may use. */
+	CSampleConverter::PW_TIER CSampleConverter::m_tMaxTier = CSampleConverter::PW_T_AVX512VBMI;
+	/** The conversions in use, or nullptr until SelectKernels() first picks them. */
+	std::atomic<const CSampleConverter::PW_KERNELS *> CSampleConverter::m_pkKernels = nullptr;
+
+	// == Functions.
+	/**
+	 * Gets the decoders for a sample format and channel count, to be looked up once per file.  Up to PW_D_FIXED_CHANNELS channels
+	 *	get decoders generated for that channel count, whose frame size, scale factor, and SIMD kernel are all fixed at compile time
+	 *	so that their loops do not branch on the layout; other channel counts get the general decoders.  Either way the results are
+	 *	the same as those of Pcm8ToF64() and the other decoders below.
+	 *
+	 * \param _bFloat If true, the samples are IEEE float; otherwise they are PCM.
+	 * \param _uiBits The bits per sample.  8, 16, 24, or 32 for PCM; 32 or 64 for float.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \return Returns the decoders, which are all nullptr if the format is not supported.
+	 */
+	CSampleConverter::PW_DECODERS CSampleConverter::Decoders( bool _bFloat, uint16_t _uiBits, uint16_t _uiChannels ) {
+		const PW_SAMPLE_FORMAT sfFormat = SampleFormat( _bFloat, _uiBits );
+		if ( sfFormat == PW_SF_TOTAL ) { return PW_DECODERS(); }
+		return Kernels().dDecoders[sfFormat][_uiChannels <= PW_D_FIXED_CHANNELS ? _uiChannels : 0];
+	}
+
+	/**
+	 * Converts interleaved 8-bit PCM frames to double.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppdDst One track per channel.  Frame I of channel C is written to _ppdDst[C][_stDstIdx+I].
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 */
+	void CSampleConverter::Pcm8ToF64( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx ) {
+		Kernels().dDecoders[PW_SF_PCM8][0].pfDecode( _pui8Src, _stFrames, _uiChannels, _ppdDst, _stDstIdx );
+	}
+
+	/**
+	 * Converts interleaved 16-bit PCM frames to double.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppdDst One track per channel.  Frame I of channel C is written to _ppdDst[C][_stDstIdx+I].
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 */
+	void CSampleConverter::Pcm16ToF64( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx ) {
+		Kernels().dDecoders[PW_SF_PCM16][0].pfDecode( _pui8Src, _stFrames, _uiChannels, _ppdDst, _stDstIdx );
+	}
+
+	/**
+	 * Converts interleaved 24-bit PCM frames to double.  A block at a time is widened to 32 bits with byte shuffles and converted
+	 *	by the 32-bit path.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppdDst One track per channel.  Frame I of channel C is written to _ppdDst[C][_stDstIdx+I].
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 */
+	void CSampleConverter::Pcm24ToF64( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx ) {
+		Kernels().dDecoders[PW_SF_PCM24][0].pfDecode( _pui8Src, _stFrames, _uiChannels, _ppdDst, _stDstIdx );
+	}
+
+	/**
+	 * Converts interleaved 32-bit PCM frames to double.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppdDst One track per channel.  Frame I of channel C is written to _ppdDst[C][_stDstIdx+I].
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 */
+	void CSampleConverter::Pcm32ToF64( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx ) {
+		Kernels().dDecoders[PW_SF_PCM32][0].pfDecode( _pui8Src, _stFrames, _uiChannels, _ppdDst, _stDstIdx );
+	}
+
+	/**
+	 * Converts interleaved 32-bit float frames to double.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppdDst One track per channel.  Frame I of channel C is written to _ppdDst[C][_stDstIdx+I].
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 */
+	void CSampleConverter::F32ToF64( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx ) {
+		Kernels().dDecoders[PW_SF_FLOAT32][0].pfDecode( _pui8Src, _stFrames, _uiChannels, _ppdDst, _stDstIdx );
+	}
+
+	/**
+	 * Converts interleaved 64-bit float frames to double.  The samples are copied as they are.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppdDst One track per channel.  Frame I of channel C is written to _ppdDst[C][_stDstIdx+I].
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 */
+	void CSampleConverter::F64ToF64( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx ) {
+		Kernels().dDecoders[PW_SF_FLOAT64][0].pfDecode( _pui8Src, _stFrames, _uiChannels, _ppdDst, _stDstIdx );
+	}
+
+	/**
+	 * Converts interleaved 8-bit PCM frames to float.  Every code is held exactly enough to encode back to itself.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppfDst One track per channel.  Frame I of channel C is written to _ppfDst[C][_stDstIdx+I].
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 */
+	void CSampleConverter::Pcm8ToF32( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, float * const * _ppfDst, size_t _stDstIdx ) {
+		Kernels().dDecoders[PW_SF_PCM8][0].pfDecodeF( _pui8Src, _stFrames, _uiChannels, _ppfDst, _stDstIdx );
+	}
+
+	/**
+	 * Converts interleaved 16-bit PCM frames to float.  Every code is held exactly enough to encode back to itself.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppfDst One track per channel.  Frame I of channel C is written to _ppfDst[C][_stDstIdx+I].
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 */
+	void CSampleConverter::Pcm16ToF32( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, float * const * _ppfDst, size_t _stDstIdx ) {
+		Kernels().dDecoders[PW_SF_PCM16][0].pfDecodeF( _pui8Src, _stFrames, _uiChannels, _ppfDst, _stDstIdx );
+	}
+
+	/**
+	 * Converts interleaved 24-bit PCM frames to float.  Every code is held exactly enough to encode back to itself.  A block at a
+	 *	time is widened to 32 bits with byte shuffles and converted by the 32-bit path.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppfDst One track per channel.  Frame I of channel C is written to _ppfDst[C][_stDstIdx+I].
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 */
+	void CSampleConverter::Pcm24ToF32( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, float * const * _ppfDst, size_t _stDstIdx ) {
+		Kernels().dDecoders[PW_SF_PCM24][0].pfDecodeF( _pui8Src, _stFrames, _uiChannels, _ppfDst, _stDstIdx );
+	}
+
+	/**
+	 * Converts interleaved 32-bit float frames to float.  The samples are copied as they are.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppfDst One track per channel.  Frame I of channel C is written to _ppfDst[C][_stDstIdx+I].
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 */
+	void CSampleConverter::F32ToF32( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, float * const * _ppfDst, size_t _stDstIdx ) {
+		Kernels().dDecoders[PW_SF_FLOAT32][0].pfDecodeF( _pui8Src, _stFrames, _uiChannels, _ppfDst, _stDstIdx );
+	}
+
+	/**
+	 * Converts per-channel tracks of doubles to interleaved 8-bit PCM frames.  Samples are clamped to [-1,1].
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _pui8Dst The buffer to which to write the frames.  Must have room for _stFrames * _uiChannels * 1 bytes.
+	 */
+	void CSampleConverter::F64ToPcm8( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, uint8_t * _pui8Dst ) {
+		Kernels().pfEncoders[PW_SF_PCM8]( _ppdSrc, _stSrcIdx, _stFrames, _uiChannels, _pui8Dst );
+	}
+
+	/**
+	 * Converts per-channel tracks of doubles to interleaved 16-bit PCM frames.  Samples are clamped to [-1,1].
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _pui8Dst The buffer to which to write the frames.  Must have room for _stFrames * _uiChannels * 2 bytes.
+	 */
+	void CSampleConverter::F64ToPcm16( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, uint8_t * _pui8Dst ) {
+		Kernels().pfEncoders[PW_SF_PCM16]( _ppdSrc, _stSrcIdx, _stFrames, _uiChannels, _pui8Dst );
+	}
+
+	/**
+	 * Converts per-channel tracks of doubles to interleaved 24-bit PCM frames.  Samples are clamped to [-1,1].  A block at a time
+	 *	is encoded by the 32-bit path and packed to 24 bits with byte shuffles.
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _pui8Dst The buffer to which to write the frames.  Must have room for _stFrames * _uiChannels * 3 bytes.
+	 */
+	void CSampleConverter::F64ToPcm24( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, uint8_t * _pui8Dst ) {
+		Kernels().pfEncoders[PW_SF_PCM24]( _ppdSrc, _stSrcIdx, _stFrames, _uiChannels, _pui8Dst );
+	}
+
+	/**
+	 * Converts per-channel tracks of doubles to interleaved 32-bit PCM frames.  Samples are clamped to [-1,1].
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _pui8Dst The buffer to which to write the frames.  Must have room for _stFrames * _uiChannels * 4 bytes.
+	 */
+	void CSampleConverter::F64ToPcm32( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, uint8_t * _pui8Dst ) {
+		Kernels().pfEncoders[PW_SF_PCM32]( _ppdSrc, _stSrcIdx, _stFrames, _uiChannels, _pui8Dst );
+	}
+
+	/**
+	 * Converts per-channel tracks of doubles to interleaved 32-bit float frames.  Each sample is rounded to the nearest float and is
+	 *	not clamped.
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _pui8Dst The buffer to which to write the frames.  Must have room for _stFrames * _uiChannels * 4 bytes.
+	 */
+	void CSampleConverter::F64ToFloat32( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, uint8_t * _pui8Dst ) {
+		Kernels().pfEncoders[PW_SF_FLOAT32]( _ppdSrc, _stSrcIdx, _stFrames, _uiChannels, _pui8Dst );
+	}
+
+	/**
+	 * Converts per-channel tracks of doubles to interleaved 64-bit float frames.  The samples are copied as they are.
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _pui8Dst The buffer to which to write the frames.  Must have room for _stFrames * _uiChannels * 8 bytes.
+	 */
+	void CSampleConverter::F64ToFloat64( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, uint8_t * _pui8Dst ) {
+		Kernels().pfEncoders[PW_SF_FLOAT64]( _ppdSrc, _stSrcIdx, _stFrames, _uiChannels, _pui8Dst );
+	}
+
+	/**
+	 * Converts PCM samples from one bit depth to another without going through floating point.  Widening is an exact shift; narrowing
+	 *	truncates, rounds to the nearest code with halves away from zero, or adds triangular dither and then rounds, saturating at the
+	 *	top of the range of the output.  Channels do not matter, so whole interleaved frames can be passed as samples.
+	 *
+	 * \param _pui8Src The first sample to convert.
+	 * \param _uiSrcBits The bits per source sample.  8, 16, 24, or 32.
+	 * \param _pui8Dst The buffer to which to write the samples.  Must have room for _stSamples * _uiDstBits / 8 bytes.
+	 * \param _uiDstBits The bits per output sample.  8, 16, 24, or 32.
+	 * \param _stSamples The number of samples to convert.
+	 * \param _nNarrowing How to drop bits when _uiDstBits is less than _uiSrcBits.
+	 * \param _ui32Dither The state of the dither noise, carried across calls so that consecutive blocks continue the same noise.  Must
+	 *	not be 0.
+	 * \return Returns false if either bit depth is not supported.
+	 */
+	bool CSampleConverter::PcmToPcm( const uint8_t * _pui8Src, uint16_t _uiSrcBits, uint8_t * _pui8Dst, uint16_t _uiDstBits, size_t _stSamples,
+		PW_NARROWING _nNarrowing, uint32_t &_ui32Dither ) {
+		return Kernels().pfPcmToPcm( _pui8Src, _uiSrcBits, _pui8Dst, _uiDstBits, _stSamples, _nNarrowing, _ui32Dither );
+	}
+
+	/**
+	 * Determines whether a SIMD tier is compiled in and supported by the CPU and OS.  This ignores the limit set by SetMaxTier().
+	 *
+	 * \param _tTier The tier to check.
+	 * \return Returns true if the tier can be used.
+	 */
+	bool CSampleConverter::TierSupported( PW_TIER _tTier ) {
+		if ( _tTier >= PW_T_TOTAL || TierKernels( _tTier ).tTier != _tTier ) { return false; }
+		switch ( _tTier ) {
+			case PW_T_SCALAR : { return true; }
+			case PW_T_SSE4 : { return CUtilities::IsSse4Supported(); }
+			case PW_T_AVX2 : { return CUtilities::IsAvx2Supported(); }
+			// The AVX-512 files may be compiled with /arch:AVX512, which can use any of F, CD, BW, DQ, and VL.
+			case PW_T_AVX512 : {
+				return CUtilities::IsAvx512FSupported() && CUtilities::IsAvx512CDSupported() && CUtilities::IsAvx512BWSupported() &&
+					CUtilities::IsAvx512DQSupported() && CUtilities::IsAvx512VLSupported();
+			}
+			case PW_T_AVX512VBMI : { return TierSupported( PW_T_AVX512 ) && CUtilities::IsAvx512VbmiSupported(); }
+			default : { return false; }
+		}
+	}
+
+	/**
+	 * Gets the name of a SIMD tier.
+	 *
+	 * \param _tTier The tier whose name is to be returned.
+	 * \return Returns the name of the tier, which is also what the -max_simd option accepts.
+	 */
+	const wchar_t * CSampleConverter::TierName( PW_TIER _tTier ) {
+		switch ( _tTier ) {
+			case PW_T_SCALAR : { return L"scalar"; }
+			case PW_T_SSE4 : { return L"sse4"; }
+			case PW_T_AVX2 : { return L"avx2"; }
+			case PW_T_AVX512 : { return L"avx512"; }
+			case PW_T_AVX512VBMI : { return L"vbmi"; }
+			default : { return L""; }
+		}
+	}
+
+	/**
+	 * Picks the conversions of the widest tier within the limit set by SetMaxTier() that the machine supports.
+	 *
+	 * \return Returns the conversions now in use.
+	 */
+	const CSampleConverter::PW_KERNELS & CSampleConverter::SelectKernels() {
+		uint32_t ui32Tier = std::min<uint32_t>( m_tMaxTier, PW_T_TOTAL - 1 );
+		while ( ui32Tier > PW_T_SCALAR && !TierSupported( PW_TIER( ui32Tier ) ) ) { --ui32Tier; }
+		const PW_KERNELS & kKernels = TierKernels( PW_TIER( ui32Tier ) );
+		m_pkKernels.store( &kKernels, std::memory_order_release );
+		return kKernels;
+	}
+
+	/**
+	 * Gets the conversions built for a tier.  Their tTier is lower than _tTier if their file was not compiled for the tier.
+	 *
+	 * \param _tTier The tier whose conversions are to be returned.
+	 * \return Returns the conversions built for the tier.
+	 */
+	const CSampleConverter::PW_KERNELS & CSampleConverter::TierKernels( PW_TIER _tTier ) {
+		switch ( _tTier ) {
+			case PW_T_SSE4 : { return m_kSse4Kernels; }
+			case PW_T_AVX2 : { return m_kAvx2Kernels; }
+			case PW_T_AVX512 : { return m_kAvx512Kernels; }
+			case PW_T_AVX512VBMI : { return m_kVbmiKernels; }
+			default : { return m_kScalarKernels; }
+		}
+	}
+
+	/**
+	 * Gets the table index of a sample format.
+	 *
+	 * \param _bFloat If true, the samples are IEEE float; otherwise they are PCM.
+	 * \param _uiBits The bits per sample.
+	 * \return Returns the index of the format, or PW_SF_TOTAL if it is not supported.
+	 */
+	CSampleConverter::PW_SAMPLE_FORMAT CSampleConverter::SampleFormat( bool _bFloat, uint16_t _uiBits ) {
+		if ( _bFloat ) {
+			switch ( _uiBits ) {
+				case 32 : { return PW_SF_FLOAT32; }
+				case 64 : { return PW_SF_FLOAT64; }
+			}
+		}
+		else {
+			switch ( _uiBits ) {
+				case 8 : { return PW_SF_PCM8; }
+				case 16 : { return PW_SF_PCM16; }
+				case 24 : { return PW_SF_PCM24; }
+				case 32 : { return PW_SF_PCM32; }
+			}
+		}
+		return PW_SF_TOTAL;
+	}
+
+	/**
+	 * Checks that every SIMD tier usable on this machine converts bit-for-bit the same as the scalar path.
+	 *
+	 * Every 8- and 16-bit code, the extremes and a dense random set of 24- and 32-bit codes, and random 32-bit floats are decoded and
+	 *	re-encoded in 1 to 8 and 11 channels, so that every kernel and every tail is exercised.  Each tier's decoded doubles and
+	 *	encoded bytes must match the scalar tier exactly, and the scalar round trip must give back the original codes.  The only
+	 *	exception is the most negative code: it decodes slightly below -1, is clamped when encoding, and so comes back as the next code up.
+	 *	Decoding to float is compared the same way, and every code decoded to float must also survive encoding.
+	 *	Random doubles in and out of [-1,1] and halfway cases are also encoded on every tier and compared.
+	 *	PcmToPcm() is run between every pair of PCM bit depths with every narrowing policy and compared the same way, and on the scalar
+	 *	tier every widening must truncate and round back to the original codes.
+	 *
+	 * The tier limit is changed while this runs, so no conversions may run on other threads at the same time.
+	 *
+	 * \param _wsLog Receives one line per tier and one per mismatch.
+	 * \return Returns true if every tier matched the scalar path.
+	 */
+	bool CSampleConverter::VerifyTiers( std::wstring &_wsLog ) {
+		struct PW_FORMAT {
+			const wchar_t *										pwcName;
+			uint32_t											ui32Bits;
+			size_t												stSize;
+			PfDecoder											pfDecode;
+			PfEncoder											pfEncode;
+			PfDecoderF											pfDecodeF;
+		};
+		static const PW_FORMAT s_fFormats[] = {
+			{ L"8-bit PCM", 8, 1, Pcm8ToF64, F64ToPcm8, Pcm8ToF32 },
+			{ L"16-bit PCM", 16, 2, Pcm16ToF64, F64ToPcm16, Pcm16ToF32 },
+			{ L"24-bit PCM", 24, 3, Pcm24ToF64, F64ToPcm24, Pcm24ToF32 },
+			{ L"32-bit PCM", 32, 4, Pcm32ToF64, F64ToPcm32, nullptr },
+			{ L"32-bit float", 0, 4, F32ToF64, F64ToFloat32, F32ToF32 },
+			{ L"64-bit float", 0, 8, F64ToF64, F64ToFloat64, nullptr },
+		};
+		static const uint16_t s_ui16Channels[] = { 1, 2, 3, 4, 5, 6, 7, 8, 11 };
+		constexpr size_t stRandomSamples = 1 << 18;
+
+		const PW_TIER tMaxTier = m_tMaxTier;
+		std::vector<PW_TIER> vTiers;
+		bool bMatched = true;
+		try {
+			for ( uint32_t T = PW_T_SCALAR + 1; T < PW_T_TOTAL; ++T ) {
+				if ( TierSupported( PW_TIER( T ) ) ) { vTiers.push_back( PW_TIER( T ) ); }
+			}
+
+			std::mt19937 mtRand( 0x50574156 );
+			std::vector<uint8_t> vCodes, vRefBytes, vBytes;
+			std::vector<std::vector<double>> vRefTracks, vTracks;
+			std::vector<double *> vRefPtrs, vPtrs;
+			std::vector<std::vector<float>> vRefTracksF, vTracksF;
+			std::vector<float *> vRefPtrsF, vPtrsF;
+			std::vector<uint32_t> vMismatches( PW_T_TOTAL );
+			auto aReport = [&]( PW_TIER _tTier, const PW_FORMAT &_fFormat, const wchar_t * _pwcWhat, uint16_t _uiChannels, size_t _stSample ) {
+				bMatched = false;
+				if ( vMismatches[_tTier]++ < 16 ) {
+					_wsLog += std::wstring( TierName( _tTier ) ) + L": " + _fFormat.pwcName + L" " + _pwcWhat + L" (" + std::to_wstring( _uiChannels ) +
+						L" channels, sample " + std::to_wstring( _stSample ) + L").\r\n";
+				}
+			};
+			auto aResize = [&]( auto &_vTracks, auto &_vPtrs, uint16_t _uiChannels, size_t _stFrames ) {
+				_vTracks.resize( _uiChannels );
+				_vPtrs.resize( _uiChannels );
+				for ( uint16_t C = 0; C < _uiChannels; ++C ) {
+					_vTracks[C].assign( _stFrames, 0 );
+					_vPtrs[C] = _vTracks[C].data();
+				}
+			};
+			// Checks that encoded samples match their source codes, except that the most negative PCM code comes back as the next code up.
+			auto aRoundTrip = [&]( const PW_FORMAT &_fFormat, const std::vector<uint8_t> &_vSrc, const std::vector<uint8_t> &_vDst, const wchar_t * _pwcWhat, uint16_t _uiChannels ) {
+				for ( size_t I = 0; I < _vSrc.size() / _fFormat.stSize; ++I ) {
+					uint64_t ui64Src = 0, ui64Dst = 0;
+					std::memcpy( &ui64Src, &_vSrc[I*_fFormat.stSize], _fFormat.stSize );
+					std::memcpy( &ui64Dst, &_vDst[I*_fFormat.stSize], _fFormat.stSize );
+					// 8-bit PCM is unsigned, so its most negative code is 0.  Floats have no such code.
+					const uint64_t ui64Lowest = _fFormat.ui32Bits == 8 ? 0 :
+						_fFormat.ui32Bits ? uint64_t( 1 ) << (_fFormat.ui32Bits - 1) : UINT64_MAX;
+					if ( ui64Dst != (ui64Src == ui64Lowest ? ui64Src + 1 : ui64Src) ) {
+						aReport( PW_T_SCALAR, _fFormat, _pwcWhat, _uiChannels, I );
+						break;
+					}
+				}
+			};
+			// Checks the decoders Decoders() selects for a layout against the scalar reference decode of the same frames.
+			auto aCheckTable = [&]( PW_TIER _tTier, const PW_FORMAT &_fFormat, const std::vector<uint8_t> &_vSrc, uint16_t _uiChannels, size_t _stFrames ) {
+				const PW_DECODERS dDecoders = Decoders( _fFormat.ui32Bits == 0, uint16_t( _fFormat.ui32Bits ? _fFormat.ui32Bits : _fFormat.stSize * 8 ), _uiChannels );
+				if ( !dDecoders.pfDecode || !dDecoders.pfDecodeChannel || (dDecoders.pfDecodeF == nullptr) != (_fFormat.pfDecodeF == nullptr) ) {
+					aReport( _tTier, _fFormat, L"has the wrong decoders in the table", _uiChannels, 0 );
+					return;
+				}
+				aResize( vTracks, vPtrs, _uiChannels, _stFrames );
+				dDecoders.pfDecode( _vSrc.data(), _stFrames, _uiChannels, vPtrs.data(), 0 );
+				for ( uint16_t C = 0; C < _uiChannels; ++C ) {
+					if ( std::memcmp( vTracks[C].data(), vRefTracks[C].data(), _stFrames * sizeof( double ) ) != 0 ) {
+						aReport( _tTier, _fFormat, L"table decode differs from scalar", _uiChannels, C );
+						break;
+					}
+				}
+				if ( dDecoders.pfDecodeF ) {
+					aResize( vTracksF, vPtrsF, _uiChannels, _stFrames );
+					dDecoders.pfDecodeF( _vSrc.data(), _stFrames, _uiChannels, vPtrsF.data(), 0 );
+					for ( uint16_t C = 0; C < _uiChannels; ++C ) {
+						if ( std::memcmp( vTracksF[C].data(), vRefTracksF[C].data(), _stFrames * sizeof( float ) ) != 0 ) {
+							aReport( _tTier, _fFormat, L"table float decode differs from scalar", _uiChannels, C );
+							break;
+						}
+					}
+				}
+				aResize( vTracks, vPtrs, _uiChannels, _stFrames );
+				for ( uint16_t C = 0; C < _uiChannels; ++C ) {
+					dDecoders.pfDecodeChannel( &_vSrc[C*_fFormat.stSize], _stFrames, _uiChannels, vTracks[C].data() );
+					if ( std::memcmp( vTracks[C].data(), vRefTracks[C].data(), _stFrames * sizeof( double ) ) != 0 ) {
+						aReport( _tTier, _fFormat, L"channel decode differs from scalar", _uiChannels, C );
+						break;
+					}
+				}
+			};
+
+			for ( const auto & fFormat : s_fFormats ) {
+				// The codes to test, as packed little-endian samples.
+				size_t stCodes = fFormat.ui32Bits == 8 || fFormat.ui32Bits == 16 ? (size_t( 1 ) << fFormat.ui32Bits) : stRandomSamples;
+				vCodes.resize( stCodes * fFormat.stSize );
+				for ( size_t I = 0; I < stCodes; ++I ) {
+					uint64_t ui64Code = stCodes == stRandomSamples ? uint64_t( mtRand() ) : uint64_t( I );
+					if ( fFormat.ui32Bits == 0 && fFormat.stSize == sizeof( double ) ) {
+						double dVal = std::uniform_real_distribution<double>( -1.5, 1.5 )( mtRand );
+						std::memcpy( &ui64Code, &dVal, sizeof( dVal ) );
+					}
+					else if ( fFormat.ui32Bits == 0 ) {
+						float fVal = std::uniform_real_distribution<float>( -1.5f, 1.5f )( mtRand );
+						std::memcpy( &ui64Code, &fVal, sizeof( fVal ) );
+					}
+					else if ( stCodes == stRandomSamples && I < 6 ) {
+						// The extremes, zero, and -1.
+						const uint32_t ui32Top = uint32_t( 1 ) << (fFormat.ui32Bits - 1);
+						const uint32_t ui32Edges[] = { ui32Top, ui32Top - 1, ui32Top + 1, 0, 1, ~uint32_t( 0 ) };
+						ui64Code = ui32Edges[I];
+					}
+					std::memcpy( &vCodes[I*fFormat.stSize], &ui64Code, fFormat.stSize );
+				}
+
+				for ( auto uiChannels : s_ui16Channels ) {
+					// Every code appears in every channel over the run; the last frame wraps around to the first codes.
+					const size_t stFrames = (stCodes + uiChannels - 1) / uiChannels + 1;
+					std::vector<uint8_t> vSrc( stFrames * uiChannels * fFormat.stSize );
+					for ( size_t I = 0; I < vSrc.size(); I += vCodes.size() ) {
+						std::memcpy( &vSrc[I], vCodes.data(), std::min( vCodes.size(), vSrc.size() - I ) );
+					}
+
+					// The scalar reference.
+					SetMaxTier( PW_T_SCALAR );
+					aResize( vRefTracks, vRefPtrs, uiChannels, stFrames );
+					fFormat.pfDecode( vSrc.data(), stFrames, uiChannels, vRefPtrs.data(), 0 );
+					if ( fFormat.pfEncode ) {
+						vRefBytes.assign( vSrc.size(), 0 );
+						fFormat.pfEncode( vRefPtrs.data(), 0, stFrames, uiChannels, vRefBytes.data() );
+						aRoundTrip( fFormat, vSrc, vRefBytes, L"does not survive a round trip", uiChannels );
+					}
+					if ( fFormat.pfDecodeF ) {
+						aResize( vRefTracksF, vRefPtrsF, uiChannels, stFrames );
+						fFormat.pfDecodeF( vSrc.data(), stFrames, uiChannels, vRefPtrsF.data(), 0 );
+						if ( fFormat.pfEncode ) {
+							// Floats are encoded by widening them to double, which is exact.
+							aResize( vTracks, vPtrs, uiChannels, stFrames );
+							for ( uint16_t C = 0; C < uiChannels; ++C ) {
+								std::copy( vRefTracksF[C].begin(), vRefTracksF[C].end(), vTracks[C].begin() );
+							}
+							vBytes.assign( vSrc.size(), 0 );
+							fFormat.pfEncode( vPtrs.data(), 0, stFrames, uiChannels, vBytes.data() );
+							aRoundTrip( fFormat, vSrc, vBytes, L"does not survive a round trip through float", uiChannels );
+						}
+					}
+					aCheckTable( PW_T_SCALAR, fFormat, vSrc, uiChannels, stFrames );
+
+					for ( auto tTier : vTiers ) {
+						SetMaxTier( tTier );
+						aResize( vTracks, vPtrs, uiChannels, stFrames );
+						fFormat.pfDecode( vSrc.data(), stFrames, uiChannels, vPtrs.data(), 0 );
+						for ( uint16_t C = 0; C < uiChannels; ++C ) {
+							if ( std::memcmp( vTracks[C].data(), vRefTracks[C].data(), stFrames * sizeof( double ) ) != 0 ) {
+								aReport( tTier, fFormat, L"decode differs from scalar", uiChannels, C );
+								break;
+							}
+						}
+						if ( fFormat.pfDecodeF ) {
+							aResize( vTracksF, vPtrsF, uiChannels, stFrames );
+							fFormat.pfDecodeF( vSrc.data(), stFrames, uiChannels, vPtrsF.data(), 0 );
+							for ( uint16_t C = 0; C < uiChannels; ++C ) {
+								if ( std::memcmp( vTracksF[C].data(), vRefTracksF[C].data(), stFrames * sizeof( float ) ) != 0 ) {
+									aReport( tTier, fFormat, L"float decode differs from scalar", uiChannels, C );
+									break;
+								}
+							}
+						}
+						if ( fFormat.pfEncode ) {
+							vBytes.assign( vSrc.size(), 0 );
+							fFormat.pfEncode( vRefPtrs.data(), 0, stFrames, uiChannels, vBytes.data() );
+							if ( vBytes != vRefBytes ) {
+								aReport( tTier, fFormat, L"encode differs from scalar", uiChannels,
+									size_t( std::mismatch( vBytes.begin(), vBytes.end(), vRefBytes.begin() ).first - vBytes.begin() ) / fFormat.stSize );
+							}
+						}
+						aCheckTable( tTier, fFormat, vSrc, uiChannels, stFrames );
+					}
+				}
+
+				// Arbitrary doubles, including out-of-range values and values that land halfway between two codes.  Floats have no codes, so
+				//	only their rounding is checked.
+				if ( fFormat.pfEncode ) {
+					const double dFactor = fFormat.ui32Bits == 8 ? 127.0 :
+						fFormat.ui32Bits ? std::pow( 2.0, double( fFormat.ui32Bits ) - 1.0 ) - 1.0 : 1.0;
+					const uint16_t uiChannels = 3;
+					const size_t stFrames = stRandomSamples / uiChannels + 5;
+					aResize( vRefTracks, vRefPtrs, uiChannels, stFrames );
+					for ( uint16_t C = 0; C < uiChannels; ++C ) {
+						for ( auto & dVal : vRefTracks[C] ) {
+							uint32_t ui32Kind = mtRand() % 4;
+							if ( ui32Kind == 0 ) {
+								dVal = (std::floor( std::uniform_real_distribution<double>( -dFactor, dFactor )( mtRand ) ) + 0.5) / dFactor;
+							}
+							else {
+								dVal = std::uniform_real_distribution<double>( -1.25, 1.25 )( mtRand );
+							}
+						}
+					}
+					SetMaxTier( PW_T_SCALAR );
+					vRefBytes.assign( stFrames * uiChannels * fFormat.stSize, 0 );
+					fFormat.pfEncode( vRefPtrs.data(), 0, stFrames, uiChannels, vRefBytes.data() );
+					for ( auto tTier : vTiers ) {
+						SetMaxTier( tTier );
+						vBytes.assign( vRefBytes.size(), 0 );
+						fFormat.pfEncode( vRefPtrs.data(), 0, stFrames, uiChannels, vBytes.data() );
+						if ( vBytes != vRefBytes ) {
+							aReport( tTier, fFormat, L"quantizes differently from scalar", uiChannels,
+								size_t( std::mismatch( vBytes.begin(), vBytes.end(), vRefBytes.begin() ).first - vBytes.begin() ) / fFormat.stSize );
+						}
+					}
+				}
+			}
+
+			// Bit-depth conversions between every pair of PCM formats with every narrowing policy, starting 1 sample in and running an
+			//	odd number of samples so that every tail is used.  The same dither seed is used on every tier.
+			static const wchar_t * s_pwcNarrowing[PW_N_TOTAL] = { L"truncated", L"rounded", L"dithered" };
+			const size_t stConvert = stRandomSamples + 7;
+			for ( const auto & fSrc : s_fFormats ) {
+				if ( !fSrc.ui32Bits ) { continue; }
+				vCodes.resize( (stConvert + 1) * fSrc.stSize );
+				for ( size_t I = 0; I < vCodes.size(); ++I ) { vCodes[I] = uint8_t( mtRand() ); }
+				for ( size_t I = 0; I < 6; ++I ) {
+					// The extremes, zero, and -1, as signed codes in the top of each sample.
+					const uint32_t ui32Edges[] = { 0x80000000, 0x7FFFFFFF, 0x80000001, 0, 1, ~uint32_t( 0 ) };
+					uint32_t ui32Code = ui32Edges[I] >> (32 - fSrc.ui32Bits);
+					if ( fSrc.ui32Bits == 8 ) { ui32Code ^= 0x80; }
+					std::memcpy( &vCodes[(I+1)*fSrc.stSize], &ui32Code, fSrc.stSize );
+				}
+				const uint8_t * pui8Src = vCodes.data() + fSrc.stSize;
+
+				for ( const auto & fDst : s_fFormats ) {
+					if ( !fDst.ui32Bits || fDst.ui32Bits == fSrc.ui32Bits ) { continue; }
+					for ( uint32_t N = 0; N < PW_N_TOTAL; ++N ) {
+						const std::wstring wsName = std::wstring( fSrc.pwcName ) + L" to " + fDst.pwcName + L" (" + s_pwcNarrowing[N] + L")";
+						const PW_FORMAT fPair = { wsName.c_str(), fDst.ui32Bits, fDst.stSize, nullptr, nullptr, nullptr };
+
+						SetMaxTier( PW_T_SCALAR );
+						uint32_t ui32Dither = 0x50574156;
+						vRefBytes.assign( stConvert * fDst.stSize, 0 );
+						PcmToPcm( pui8Src, uint16_t( fSrc.ui32Bits ), vRefBytes.data(), uint16_t( fDst.ui32Bits ), stConvert, PW_NARROWING( N ), ui32Dither );
+						if ( fDst.ui32Bits > fSrc.ui32Bits && N != PW_N_DITHER ) {
+							// Widening is exact, so truncating or rounding back must give the original codes.
+							vBytes.assign( stConvert * fSrc.stSize, 0 );
+							PcmToPcm( vRefBytes.data(), uint16_t( fDst.ui32Bits ), vBytes.data(), uint16_t( fSrc.ui32Bits ), stConvert, PW_NARROWING( N ), ui32Dither );
+							if ( std::memcmp( vBytes.data(), pui8Src, vBytes.size() ) != 0 ) {
+								aReport( PW_T_SCALAR, fPair, L"does not survive a round trip", 1,
+									size_t( std::mismatch( vBytes.begin(), vBytes.end(), pui8Src ).first - vBytes.begin() ) / fSrc.stSize );
+							}
+						}
+
+						for ( auto tTier : vTiers ) {
+							SetMaxTier( tTier );
+							ui32Dither = 0x50574156;
+							vBytes.assign( vRefBytes.size(), 0 );
+							PcmToPcm( pui8Src, uint16_t( fSrc.ui32Bits ), vBytes.data(), uint16_t( fDst.ui32Bits ), stConvert, PW_NARROWING( N ), ui32Dither );
+							if ( vBytes != vRefBytes ) {
+								aReport( tTier, fPair, L"differs from scalar", 1,
+									size_t( std::mismatch( vBytes.begin(), vBytes.end(), vRefBytes.begin() ).first - vBytes.begin() ) / fDst.stSize );
+							}
+						}
+					}
+				}
+			}
+
+			_wsLog += std::wstring( TierName( PW_T_SCALAR ) ) + (vMismatches[PW_T_SCALAR] ? L": round trip failed.\r\n" : L": reference.\r\n");
+			for ( auto tTier : vTiers ) {
+				_wsLog += std::wstring( TierName( tTier ) ) + (vMismatches[tTier] ? L": " + std::to_wstring( vMismatches[tTier] ) + L" mismatches.\r\n" :
+					std::wstring( L": matches scalar.\r\n" ));
+			}
+		}
+		catch ( ... ) {
+			_wsLog += L"Out of memory.\r\n";
+			bMatched = false;
+		}
+		SetMaxTier( tMaxTier );
+		return bMatched;
+	}
+
+}	// namespace pw
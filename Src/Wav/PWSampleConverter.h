@@ -0,0 +1,413 @@
+/**
+ * Copyright L. Spiro 2024
+ *
+ * Written by: Shawn (L. Spiro) Wilcoxen
+ *
+ * Description: Converts between interleaved PCM/float sample data and per-channel tracks of doubles or floats.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <cinttypes>
+#include <cstddef>
+#include <string>
+
+
+namespace pw {
+
+	/**
+	 * Class CSampleConverter
+	 * \brief Converts between interleaved PCM/float sample data and per-channel tracks of doubles or floats.
+	 *
+	 * Description: Converts between interleaved PCM/float sample data and per-channel tracks of doubles or floats.  Every conversion is
+	 *	compiled once per SIMD tier, and the widest tier the CPU and OS support is picked at run time, giving the same results as the
+	 *	scalar path.
+	 */
+	class CSampleConverter {
+	public :
+		// == Enumerations.
+		/** Defaults. */
+		enum PW_DEFAULTS : size_t {
+			PW_D_BLOCK_SAMPLES											= 2048,					// Samples staged on the stack at a time when widening or packing 24-bit samples.
+			PW_D_FIXED_CHANNELS											= 8,					// Decoders() has decoders with a fixed stride for up to this many channels.
+		};
+
+		/** SIMD tiers, from narrowest to widest.  A tier may also use every tier below it. */
+		enum PW_TIER : uint32_t {
+			PW_T_SCALAR,																		// No SIMD.
+			PW_T_SSE4,																			// SSE 4.1 and SSSE3.
+			PW_T_AVX2,																			// AVX2.
+			PW_T_AVX512,																		// AVX-512F.
+			PW_T_AVX512VBMI,																	// AVX-512 VBMI and BW.
+			PW_T_TOTAL
+		};
+
+		/** How to drop bits when converting PCM to a lower bit depth. */
+		enum PW_NARROWING : uint32_t {
+			PW_N_TRUNCATE,																		// Drop the low bits, rounding toward negative infinity.
+			PW_N_ROUND,																			// Round to the nearest code, halves away from zero.
+			PW_N_DITHER,																		// Add triangular (TPDF) dither of +-1 code, then round.
+			PW_N_TOTAL
+		};
+
+		/** The sample formats of the conversion tables. */
+		enum PW_SAMPLE_FORMAT : uint32_t {
+			PW_SF_PCM8,																			// 8-bit PCM.
+			PW_SF_PCM16,																		// 16-bit PCM.
+			PW_SF_PCM24,																		// 24-bit PCM.
+			PW_SF_PCM32,																		// 32-bit PCM.
+			PW_SF_FLOAT32,																		// 32-bit IEEE float.
+			PW_SF_FLOAT64,																		// 64-bit IEEE float.
+			PW_SF_TOTAL
+		};
+
+
+		// == Types.
+		/** Decodes interleaved frames to one track of doubles per channel, walking the frames once rather than once per channel. */
+		typedef void (*													PfDecoder)( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx );
+		/** Decodes interleaved frames to one track of floats per channel, walking the frames once rather than once per channel. */
+		typedef void (*													PfDecoderF)( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, float * const * _ppfDst, size_t _stDstIdx );
+		/** Decodes one channel of interleaved frames to doubles.  _pui8Src points to the channel's sample in the first frame. */
+		typedef void (*													PfChannelDecoder)( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * _pdDst );
+
+		/** Encodes one track of doubles per channel to interleaved frames, writing each frame once. */
+		typedef void (*													PfEncoder)( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, uint8_t * _pui8Dst );
+		/** Converts PCM samples from one bit depth to another. */
+		typedef bool (*													PfPcmToPcm)( const uint8_t * _pui8Src, uint16_t _uiSrcBits, uint8_t * _pui8Dst, uint16_t _uiDstBits, size_t _stSamples,
+			PW_NARROWING _nNarrowing, uint32_t &_ui32Dither );
+
+		/** The decoders for one sample format and channel count, as returned by Decoders(). */
+		struct PW_DECODERS {
+			PfDecoder													pfDecode;				// Decodes every channel to double, or nullptr if the format is not supported.
+			PfDecoderF													pfDecodeF;				// Decodes every channel to float, or nullptr if float cannot hold the format losslessly.
+			PfChannelDecoder											pfDecodeChannel;		// Decodes one channel to double, or nullptr if the format is not supported.
+		};
+
+		/** Every conversion compiled for one SIMD tier.  Each tier's table is built in its own file, compiled for that instruction set. */
+		struct PW_KERNELS {
+			PW_TIER														tTier;					// The widest tier the functions use.
+			PW_DECODERS													dDecoders[PW_SF_TOTAL][PW_D_FIXED_CHANNELS+1];	// By format, then channel count; the general decoders are at 0.
+			PfEncoder													pfEncoders[PW_SF_TOTAL];// By format.
+			PfPcmToPcm													pfPcmToPcm;				// PcmToPcm().
+		};
+
+
+		// == Functions.
+		/**
+		 * Gets the decoders for a sample format and channel count, to be looked up once per file.  Up to PW_D_FIXED_CHANNELS channels
+		 *	get decoders generated for that channel count, whose frame size, scale factor, and SIMD kernel are all fixed at compile time
+		 *	so that their loops do not branch on the layout; other channel counts get the general decoders.  Either way the results are
+		 *	the same as those of Pcm8ToF64() and the other decoders below.
+		 *
+		 * \param _bFloat If true, the samples are IEEE float; otherwise they are PCM.
+		 * \param _uiBits The bits per sample.  8, 16, 24, or 32 for PCM; 32 or 64 for float.
+		 * \param _uiChannels The number of channels in each frame.
+		 * \return Returns the decoders, which are all nullptr if the format is not supported.
+		 */
+		static PW_DECODERS												Decoders( bool _bFloat, uint16_t _uiBits, uint16_t _uiChannels );
+
+		/**
+		 * Converts interleaved 8-bit PCM frames to double.
+		 *
+		 * \param _pui8Src The first frame to convert.
+		 * \param _stFrames The number of frames to convert.
+		 * \param _uiChannels The number of channels in each frame.
+		 * \param _ppdDst One track per channel.  Frame I of channel C is written to _ppdDst[C][_stDstIdx+I].
+		 * \param _stDstIdx The index in each track at which to write the first frame.
+		 */
+		static void														Pcm8ToF64( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx );
+
+		/**
+		 * Converts interleaved 16-bit PCM frames to double.
+		 *
+		 * \param _pui8Src The first frame to convert.
+		 * \param _stFrames The number of frames to convert.
+		 * \param _uiChannels The number of channels in each frame.
+		 * \param _ppdDst One track per channel.  Frame I of channel C is written to _ppdDst[C][_stDstIdx+I].
+		 * \param _stDstIdx The index in each track at which to write the first frame.
+		 */
+		static void														Pcm16ToF64( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx );
+
+		/**
+		 * Converts interleaved 24-bit PCM frames to double.  A block at a time is widened to 32 bits with byte shuffles and converted
+		 *	by the 32-bit path.
+		 *
+		 * \param _pui8Src The first frame to convert.
+		 * \param _stFrames The number of frames to convert.
+		 * \param _uiChannels The number of channels in each frame.
+		 * \param _ppdDst One track per channel.  Frame I of channel C is written to _ppdDst[C][_stDstIdx+I].
+		 * \param _stDstIdx The index in each track at which to write the first frame.
+		 */
+		static void														Pcm24ToF64( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx );
+
+		/**
+		 * Converts interleaved 32-bit PCM frames to double.
+		 *
+		 * \param _pui8Src The first frame to convert.
+		 * \param _stFrames The number of frames to convert.
+		 * \param _uiChannels The number of channels in each frame.
+		 * \param _ppdDst One track per channel.  Frame I of channel C is written to _ppdDst[C][_stDstIdx+I].
+		 * \param _stDstIdx The index in each track at which to write the first frame.
+		 */
+		static void														Pcm32ToF64( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx );
+
+		/**
+		 * Converts interleaved 32-bit float frames to double.
+		 *
+		 * \param _pui8Src The first frame to convert.
+		 * \param _stFrames The number of frames to convert.
+		 * \param _uiChannels The number of channels in each frame.
+		 * \param _ppdDst One track per channel.  Frame I of channel C is written to _ppdDst[C][_stDstIdx+I].
+		 * \param _stDstIdx The index in each track at which to write the first frame.
+		 */
+		static void														F32ToF64( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx );
+
+		/**
+		 * Converts interleaved 64-bit float frames to double.  The samples are copied as they are.
+		 *
+		 * \param _pui8Src The first frame to convert.
+		 * \param _stFrames The number of frames to convert.
+		 * \param _uiChannels The number of channels in each frame.
+		 * \param _ppdDst One track per channel.  Frame I of channel C is written to _ppdDst[C][_stDstIdx+I].
+		 * \param _stDstIdx The index in each track at which to write the first frame.
+		 */
+		static void														F64ToF64( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx );
+
+		/**
+		 * Converts interleaved 8-bit PCM frames to float.  Every code is held exactly enough to encode back to itself.
+		 *
+		 * \param _pui8Src The first frame to convert.
+		 * \param _stFrames The number of frames to convert.
+		 * \param _uiChannels The number of channels in each frame.
+		 * \param _ppfDst One track per channel.  Frame I of channel C is written to _ppfDst[C][_stDstIdx+I].
+		 * \param _stDstIdx The index in each track at which to write the first frame.
+		 */
+		static void														Pcm8ToF32( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, float * const * _ppfDst, size_t _stDstIdx );
+
+		/**
+		 * Converts interleaved 16-bit PCM frames to float.  Every code is held exactly enough to encode back to itself.
+		 *
+		 * \param _pui8Src The first frame to convert.
+		 * \param _stFrames The number of frames to convert.
+		 * \param _uiChannels The number of channels in each frame.
+		 * \param _ppfDst One track per channel.  Frame I of channel C is written to _ppfDst[C][_stDstIdx+I].
+		 * \param _stDstIdx The index in each track at which to write the first frame.
+		 */
+		static void														Pcm16ToF32( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, float * const * _ppfDst, size_t _stDstIdx );
+
+		/**
+		 * Converts interleaved 24-bit PCM frames to float.  Every code is held exactly enough to encode back to itself.  A block at a
+		 *	time is widened to 32 bits with byte shuffles and converted by the 32-bit path.
+		 *
+		 * \param _pui8Src The first frame to convert.
+		 * \param _stFrames The number of frames to convert.
+		 * \param _uiChannels The number of channels in each frame.
+		 * \param _ppfDst One track per channel.  Frame I of channel C is written to _ppfDst[C][_stDstIdx+I].
+		 * \param _stDstIdx The index in each track at which to write the first frame.
+		 */
+		static void														Pcm24ToF32( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, float * const * _ppfDst, size_t _stDstIdx );
+
+		/**
+		 * Converts interleaved 32-bit float frames to float.  The samples are copied as they are.
+		 *
+		 * \param _pui8Src The first frame to convert.
+		 * \param _stFrames The number of frames to convert.
+		 * \param _uiChannels The number of channels in each frame.
+		 * \param _ppfDst One track per channel.  Frame I of channel C is written to _ppfDst[C][_stDstIdx+I].
+		 * \param _stDstIdx The index in each track at which to write the first frame.
+		 */
+		static void														F32ToF32( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, float * const * _ppfDst, size_t _stDstIdx );
+
+		/**
+		 * Converts per-channel tracks of doubles to interleaved 8-bit PCM frames.  Samples are clamped to [-1,1].
+		 *
+		 * \param _ppdSrc One track per channel.
+		 * \param _stSrcIdx The index in each track of the first frame to convert.
+		 * \param _stFrames The number of frames to convert.
+		 * \param _uiChannels The number of channels.
+		 * \param _pui8Dst The buffer to which to write the frames.  Must have room for _stFrames * _uiChannels * 1 bytes.
+		 */
+		static void														F64ToPcm8( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, uint8_t * _pui8Dst );
+
+		/**
+		 * Converts per-channel tracks of doubles to interleaved 16-bit PCM frames.  Samples are clamped to [-1,1].
+		 *
+		 * \param _ppdSrc One track per channel.
+		 * \param _stSrcIdx The index in each track of the first frame to convert.
+		 * \param _stFrames The number of frames to convert.
+		 * \param _uiChannels The number of channels.
+		 * \param _pui8Dst The buffer to which to write the frames.  Must have room for _stFrames * _uiChannels * 2 bytes.
+		 */
+		static void														F64ToPcm16( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, uint8_t * _pui8Dst );
+
+		/**
+		 * Converts per-channel tracks of doubles to interleaved 24-bit PCM frames.  Samples are clamped to [-1,1].  A block at a time
+		 *	is encoded by the 32-bit path and packed to 24 bits with byte shuffles.
+		 *
+		 * \param _ppdSrc One track per channel.
+		 * \param _stSrcIdx The index in each track of the first frame to convert.
+		 * \param _stFrames The number of frames to convert.
+		 * \param _uiChannels The number of channels.
+		 * \param _pui8Dst The buffer to which to write the frames.  Must have room for _stFrames * _uiChannels * 3 bytes.
+		 */
+		static void														F64ToPcm24( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, uint8_t * _pui8Dst );
+
+		/**
+		 * Converts per-channel tracks of doubles to interleaved 32-bit PCM frames.  Samples are clamped to [-1,1].
+		 *
+		 * \param _ppdSrc One track per channel.
+		 * \param _stSrcIdx The index in each track of the first frame to convert.
+		 * \param _stFrames The number of frames to convert.
+		 * \param _uiChannels The number of channels.
+		 * \param _pui8Dst The buffer to which to write the frames.  Must have room for _stFrames * _uiChannels * 4 bytes.
+		 */
+		static void														F64ToPcm32( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, uint8_t * _pui8Dst );
+
+		/**
+		 * Converts per-channel tracks of doubles to interleaved 32-bit float frames.  Each sample is rounded to the nearest float and is
+		 *	not clamped.
+		 *
+		 * \param _ppdSrc One track per channel.
+		 * \param _stSrcIdx The index in each track of the first frame to convert.
+		 * \param _stFrames The number of frames to convert.
+		 * \param _uiChannels The number of channels.
+		 * \param _pui8Dst The buffer to which to write the frames.  Must have room for _stFrames * _uiChannels * 4 bytes.
+		 */
+		static void														F64ToFloat32( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, uint8_t * _pui8Dst );
+
+		/**
+		 * Converts per-channel tracks of doubles to interleaved 64-bit float frames.  The samples are copied as they are.
+		 *
+		 * \param _ppdSrc One track per channel.
+		 * \param _stSrcIdx The index in each track of the first frame to convert.
+		 * \param _stFrames The number of frames to convert.
+		 * \param _uiChannels The number of channels.
+		 * \param _pui8Dst The buffer to which to write the frames.  Must have room for _stFrames * _uiChannels * 8 bytes.
+		 */
+		static void														F64ToFloat64( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, uint8_t * _pui8Dst );
+
+		/**
+		 * Converts PCM samples from one bit depth to another without going through floating point.  Widening is an exact shift;
+		 *	narrowing truncates, rounds, or dithers as requested, saturating at the top of the range of the output.  Channels do not
+		 *	matter, so whole interleaved frames can be passed as samples.
+		 *
+		 * \param _pui8Src The first sample to convert.
+		 * \param _uiSrcBits The bits per source sample.  8, 16, 24, or 32.
+		 * \param _pui8Dst The buffer to which to write the samples.  Must have room for _stSamples * _uiDstBits / 8 bytes.
+		 * \param _uiDstBits The bits per output sample.  8, 16, 24, or 32.
+		 * \param _stSamples The number of samples to convert.
+		 * \param _nNarrowing How to drop bits when _uiDstBits is less than _uiSrcBits.
+		 * \param _ui32Dither The state of the dither noise, carried across calls so that consecutive blocks continue the same noise.
+		 *	Must not be 0.
+		 * \return Returns false if either bit depth is not supported.
+		 */
+		static bool														PcmToPcm( const uint8_t * _pui8Src, uint16_t _uiSrcBits, uint8_t * _pui8Dst, uint16_t _uiDstBits, size_t _stSamples,
+			PW_NARROWING _nNarrowing, uint32_t &_ui32Dither );
+
+		/**
+		 * Sets the widest SIMD tier conversions may use.  Tiers the CPU does not support are skipped regardless.  Must not be called while
+		 *	conversions are running on other threads.
+		 *
+		 * \param _tTier The widest tier to use.
+		 */
+		static inline void												SetMaxTier( PW_TIER _tTier ) { m_tMaxTier = _tTier; SelectKernels(); }
+
+		/**
+		 * Gets the widest SIMD tier conversions may use.
+		 *
+		 * \return Returns the widest SIMD tier conversions may use.
+		 */
+		static inline PW_TIER											MaxTier() { return m_tMaxTier; }
+
+		/**
+		 * Determines whether a SIMD tier is compiled in and supported by the CPU and OS.  This ignores the limit set by SetMaxTier().
+		 *
+		 * \param _tTier The tier to check.
+		 * \return Returns true if the tier can be used.
+		 */
+		static bool														TierSupported( PW_TIER _tTier );
+
+		/**
+		 * Determines whether conversions use a SIMD tier.
+		 *
+		 * \param _tTier The tier to check.
+		 * \return Returns true if the tier is within the limit set by SetMaxTier() and is supported.
+		 */
+		static inline bool												UseTier( PW_TIER _tTier ) { return _tTier <= Kernels().tTier; }
+
+		/**
+		 * Gets the name of a SIMD tier.
+		 *
+		 * \param _tTier The tier whose name is to be returned.
+		 * \return Returns the name of the tier, which is also what the -max_simd option accepts.
+		 */
+		static const wchar_t *											TierName( PW_TIER _tTier );
+
+		/**
+		 * Checks that every SIMD tier usable on this machine converts bit-for-bit the same as the scalar path, and that the scalar
+		 *	path round-trips every code.  Changes the tier limit while running, so no conversions may run on other threads at the same time.
+		 *
+		 * \param _wsLog Receives one line per tier and one per mismatch.
+		 * \return Returns true if every tier matched the scalar path.
+		 */
+		static bool														VerifyTiers( std::wstring &_wsLog );
+
+
+	protected :
+		// == Members.
+		/** The widest SIMD tier conversions may use. */
+		static PW_TIER													m_tMaxTier;
+		/** The conversions in use, or nullptr until SelectKernels() first picks them. */
+		static std::atomic<const PW_KERNELS *>							m_pkKernels;
+		/** The conversions without SIMD, from PWSampleConverterScalar.cpp. */
+		static const PW_KERNELS											m_kScalarKernels;
+		/** The conversions for SSE 4.1, from PWSampleConverterSse4.cpp. */
+		static const PW_KERNELS											m_kSse4Kernels;
+		/** The conversions for AVX2, from PWSampleConverterAvx2.cpp. */
+		static const PW_KERNELS											m_kAvx2Kernels;
+		/** The conversions for AVX-512, from PWSampleConverterAvx512.cpp. */
+		static const PW_KERNELS											m_kAvx512Kernels;
+		/** The conversions for AVX-512 VBMI, from PWSampleConverterVbmi.cpp. */
+		static const PW_KERNELS											m_kVbmiKernels;
+
+
+		// == Functions.
+		/**
+		 * Gets the conversions of the widest tier within the limit set by SetMaxTier() that the machine supports.  They are picked
+		 *	the first time they are needed and again whenever the limit changes, never per call.
+		 *
+		 * \return Returns the conversions in use.
+		 */
+		static inline const PW_KERNELS &								Kernels() {
+			const PW_KERNELS * pkKernels = m_pkKernels.load( std::memory_order_acquire );
+			return pkKernels ? (*pkKernels) : SelectKernels();
+		}
+
+		/**
+		 * Picks the conversions of the widest tier within the limit set by SetMaxTier() that the machine supports.
+		 *
+		 * \return Returns the conversions now in use.
+		 */
+		static const PW_KERNELS &										SelectKernels();
+
+		/**
+		 * Gets the conversions built for a tier.  Their tTier is lower than _tTier if their file was not compiled for the tier.
+		 *
+		 * \param _tTier The tier whose conversions are to be returned.
+		 * \return Returns the conversions built for the tier.
+		 */
+		static const PW_KERNELS &										TierKernels( PW_TIER _tTier );
+
+		/**
+		 * Gets the table index of a sample format.
+		 *
+		 * \param _bFloat If true, the samples are IEEE float; otherwise they are PCM.
+		 * \param _uiBits The bits per sample.
+		 * \return Returns the index of the format, or PW_SF_TOTAL if it is not supported.
+		 */
+		static PW_SAMPLE_FORMAT											SampleFormat( bool _bFloat, uint16_t _uiBits );
+	};
+
+}	// namespace pw
@@ -0,0 +1,20 @@
+/**
+ * Copyright L. Spiro 2024
+ *
+ * Written by: Shawn (L. Spiro) Wilcoxen
+ *
+ * Description: The conversions of CSampleConverter for AVX2.  Compile with -mavx2, or on MSVC with /arch:AVX2 and __SSE4_1__=1
+ *	defined.
+ */
+
+#define PW_SAMPLE_CONVERTER_TIER										CSampleConverter::PW_T_AVX2
+#include "PWSampleConverterKernels.h"
+
+
+namespace pw {
+
+	// == Members.
+	/** The conversions for this file's tier. */
+	const CSampleConverter::PW_KERNELS CSampleConverter::m_kAvx2Kernels = MakeKernels();
+
+}	// namespace pw
@@ -0,0 +1,20 @@
+/**
+ * Copyright L. Spiro 2024
+ *
+ * Written by: Shawn (L. Spiro) Wilcoxen
+ *
+ * Description: The conversions of CSampleConverter for AVX-512.  Compile with -mavx512f -mavx512bw -mavx512dq -mavx512vl, or on
+ *	MSVC with /arch:AVX512 and __SSE4_1__=1 defined.
+ */
+
+#define PW_SAMPLE_CONVERTER_TIER										CSampleConverter::PW_T_AVX512
+#include "PWSampleConverterKernels.h"
+
+
+namespace pw {
+
+	// == Members.
+	/** The conversions for this file's tier. */
+	const CSampleConverter::PW_KERNELS CSampleConverter::m_kAvx512Kernels = MakeKernels();
+
+}	// namespace pw
@@ -0,0 +1,2253 @@
+/**
+ * Copyright L. Spiro 2024
+ *
+ * Written by: Shawn (L. Spiro) Wilcoxen
+ *
+ * Description: The conversions of CSampleConverter, compiled once per SIMD tier.  Each of PWSampleConverterScalar.cpp,
+ *	PWSampleConverterSse4.cpp, PWSampleConverterAvx2.cpp, PWSampleConverterAvx512.cpp, and PWSampleConverterVbmi.cpp defines
+ *	PW_SAMPLE_CONVERTER_TIER, includes this file, and builds its tier's table with MakeKernels(), so only those files are compiled
+ *	for an instruction set beyond the baseline.
+ *
+ * Every function here has internal linkage so that each file keeps its own copy.  Nothing with external linkage may be pulled in,
+ *	not even an inline function or a std:: template such as Min(), since the linker keeps only one copy of those and it may
+ *	be the one compiled for an instruction set the CPU lacks.  That is why this file includes no project headers beyond
+ *	PWSampleConverter.h and uses its own Min(), Max(), and Clamp().
+ */
+
+
+#pragma once
+
+#ifndef PW_SAMPLE_CONVERTER_TIER
+#error "Define PW_SAMPLE_CONVERTER_TIER before including PWSampleConverterKernels.h."
+#endif	// #ifndef PW_SAMPLE_CONVERTER_TIER
+
+#include "PWSampleConverter.h"
+
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE4_1__
+#include <immintrin.h>
+#endif	// #ifdef __SSE4_1__
+
+// The scalar loops must round exactly as they do in the scalar file, so files compiled for instruction sets with FMA must not fuse
+//	a multiply and an add.
+#if defined( _MSC_VER )
+#pragma fp_contract( off )
+#elif defined( __clang__ )
+#pragma STDC FP_CONTRACT OFF
+#elif defined( __GNUC__ )
+#pragma GCC optimize( "fp-contract=off" )
+#endif	// #if defined( _MSC_VER )
+
+
+namespace pw {
+
+	/**
+	 * Gets the widest tier whose instructions the compiler may use in this file.
+	 *
+	 * \return Returns the widest tier enabled by the compiler options.
+	 */
+	static constexpr CSampleConverter::PW_TIER CompiledTier() {
+#if defined( __AVX512VBMI__ ) && defined( __AVX512BW__ ) && defined( __AVX512F__ )
+		return CSampleConverter::PW_T_AVX512VBMI;
+#elif defined( __AVX512F__ )
+		return CSampleConverter::PW_T_AVX512;
+#elif defined( __AVX2__ )
+		return CSampleConverter::PW_T_AVX2;
+#elif defined( __SSE4_1__ )
+		return CSampleConverter::PW_T_SSE4;
+#else
+		return CSampleConverter::PW_T_SCALAR;
+#endif	// #if defined( __AVX512VBMI__ ) && defined( __AVX512BW__ ) && defined( __AVX512F__ )
+	}
+
+	/**
+	 * Gets the lesser of two values.
+	 *
+	 * \param _tA The first value.
+	 * \param _tB The second value.
+	 * \return Returns the lesser of the two values, or _tA if they are equal.
+	 */
+	template <typename _tType>
+	static constexpr _tType Min( _tType _tA, _tType _tB ) { return _tB < _tA ? _tB : _tA; }
+
+	/**
+	 * Gets the greater of two values.
+	 *
+	 * \param _tA The first value.
+	 * \param _tB The second value.
+	 * \return Returns the greater of the two values, or _tA if they are equal.
+	 */
+	template <typename _tType>
+	static constexpr _tType Max( _tType _tA, _tType _tB ) { return _tA < _tB ? _tB : _tA; }
+
+	/**
+	 * Clamps a value to a range, as Clamp() does.
+	 *
+	 * \param _tVal The value to clamp.
+	 * \param _tLow The lowest value to return.
+	 * \param _tHigh The highest value to return.
+	 * \return Returns _tVal clamped to [_tLow,_tHigh].
+	 */
+	template <typename _tType>
+	static constexpr _tType Clamp( _tType _tVal, _tType _tLow, _tType _tHigh ) { return _tVal < _tLow ? _tLow : (_tHigh < _tVal ? _tHigh : _tVal); }
+
+	/** The widest tier the conversions in this file use: the tier of the file, or less if the compiler options do not allow it. */
+	static constexpr CSampleConverter::PW_TIER s_tTier = Min( CSampleConverter::PW_TIER( PW_SAMPLE_CONVERTER_TIER ), CompiledTier() );
+
+	/**
+	 * Determines whether the conversions in this file use a SIMD tier.  Every tier in a table is checked against the CPU before the table
+	 *	is selected, so this is decided at compile time.
+	 *
+	 * \param _tTier The tier to check.
+	 * \return Returns true if the tier is at most the tier of this file.
+	 */
+	static constexpr bool UseTier( CSampleConverter::PW_TIER _tTier ) { return _tTier <= s_tTier; }
+
+	/**
+	 * Gets the divisor that brings a PCM sample, as read by LoadPcm(), into [-1,1].
+	 *
+	 * \return Returns the divisor for _uiBits-bit samples.
+	 */
+	template <unsigned _uiBits>
+	static constexpr double PcmFactor() {
+		if constexpr ( _uiBits == 8 ) { return 127.0; }
+		else if constexpr ( _uiBits == 16 ) { return 32767.0; }
+		// 24-bit samples are read into the top of a 32-bit integer.
+		else if constexpr ( _uiBits == 24 ) { return 8388607.0 * 256.0; }
+		else { return 2147483647.0; }
+	}
+
+	/**
+	 * Reads a PCM sample as a signed 32-bit integer.  8-bit samples are made signed and 24-bit samples land in the top 3 bytes.
+	 *
+	 * \param _pui8Src The sample to read.
+	 * \return Returns the sample as the SIMD decoders load it.
+	 */
+	template <unsigned _uiBits>
+	static inline int32_t LoadPcm( const uint8_t * _pui8Src ) {
+		if constexpr ( _uiBits == 8 ) {
+			return static_cast<int32_t>(_pui8Src[0]) - 128;
+		}
+		else if constexpr ( _uiBits == 16 ) {
+			int16_t i16Sample;
+			std::memcpy( &i16Sample, _pui8Src, sizeof( i16Sample ) );
+			return i16Sample;
+		}
+		else if constexpr ( _uiBits == 24 ) {
+			return static_cast<int32_t>((uint32_t( _pui8Src[0] ) << 8) | (uint32_t( _pui8Src[1] ) << 16) | (uint32_t( _pui8Src[2] ) << 24));
+		}
+		else {
+			int32_t i32Sample;
+			std::memcpy( &i32Sample, _pui8Src, sizeof( i32Sample ) );
+			return i32Sample;
+		}
+	}
+
+	/**
+	 * Decodes _stLanes frames at a time of every channel with SIMD loads.  _lLoad gets a pointer to the first of _stLanes samples of one
+	 *	channel, which are _stFrameSize bytes apart, and converts them to a register of 32-bit values.  _sStore converts such a register
+	 *	to doubles or floats and writes them to a track.  Loads may read up to 4 bytes from the start of each sample, so only frames for which
+	 *	that stays inside the source buffer are decoded.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stSampleSize The size of a sample in bytes.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _pptDst One track per channel, of doubles or floats.
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 * \param _lLoad Loads _stLanes samples of one channel.
+	 * \param _sStore Converts and stores _stLanes samples of one channel.
+	 * \return Returns the number of frames converted, which is a multiple of _stLanes.
+	 */
+	template <size_t _stLanes, typename _tSample, typename _tLoad, typename _tStore>
+	static size_t DecodeChannels_SIMD( const uint8_t * _pui8Src, size_t _stSampleSize, size_t _stFrames, uint16_t _uiChannels, _tSample * const * _pptDst, size_t _stDstIdx,
+		const _tLoad &_lLoad, const _tStore &_sStore ) {
+		const size_t stFrameSize = _stSampleSize * _uiChannels;
+		size_t I = 0;
+		for ( ; (I + _stLanes) * stFrameSize + sizeof( int32_t ) - _stSampleSize <= _stFrames * stFrameSize; I += _stLanes ) {
+			const uint8_t * pui8Frames = _pui8Src + I * stFrameSize;
+			for ( uint16_t C = 0; C < _uiChannels; ++C ) {
+				_sStore( _lLoad( pui8Frames + C * _stSampleSize ), _pptDst[C] + _stDstIdx + I );
+			}
+		}
+		return I;
+	}
+
+#ifdef __SSE4_1__
+	/**
+	 * Deinterleaves pairs of frames using SSE shuffles.  _lLoad converts the 2 * _uiChannels samples of 2 frames into _uiChannels
+	 *	registers of 2 consecutive samples each, so for K < _uiChannels / 2 register K holds channels 2K and 2K+1 of the first frame
+	 *	and register _uiChannels / 2 + K holds the same channels of the second frame.  One unpack of each such pair gives 2 frames of
+	 *	one channel.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrameSize The size of a frame in bytes.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _ppdDst One track per channel.
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 * \param _lLoad Converts 2 frames to doubles.
+	 * \return Returns the number of frames converted, which is _stFrames rounded down to a multiple of 2.
+	 */
+	template <uint16_t _uiChannels, typename _tLoad>
+	static size_t DeinterleavePairs_SSE4( const uint8_t * _pui8Src, size_t _stFrameSize, size_t _stFrames, double * const * _ppdDst, size_t _stDstIdx, const _tLoad &_lLoad ) {
+		static_assert( _uiChannels % 2 == 0, "Only even channel counts can be deinterleaved in pairs." );
+		__m128d mVals[_uiChannels];
+		size_t I = 0;
+		for ( ; I + 2 <= _stFrames; I += 2 ) {
+			_lLoad( _pui8Src + I * _stFrameSize, mVals );
+			for ( uint16_t C = 0; C < _uiChannels; C += 2 ) {
+				__m128d mFirst = mVals[C/2];
+				__m128d mSecond = mVals[_uiChannels/2+C/2];
+				_mm_storeu_pd( _ppdDst[C] + _stDstIdx + I, _mm_unpacklo_pd( mFirst, mSecond ) );
+				_mm_storeu_pd( _ppdDst[C+1] + _stDstIdx + I, _mm_unpackhi_pd( mFirst, mSecond ) );
+			}
+		}
+		return I;
+	}
+
+	/**
+	 * Converts pairs of interleaved 8-bit PCM frames to double using SSE 4.1.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _ppdDst One track per channel.
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 * \return Returns the number of frames converted.
+	 */
+	template <uint16_t _uiChannels>
+	static size_t Pcm8ToF64_SSE4( const uint8_t * _pui8Src, size_t _stFrames, double * const * _ppdDst, size_t _stDstIdx ) {
+		const __m128d mFactor = _mm_set1_pd( PcmFactor<8>() );
+		const __m128i mBias = _mm_set1_epi32( 128 );
+		return DeinterleavePairs_SSE4<_uiChannels>( _pui8Src, _uiChannels, _stFrames, _ppdDst, _stDstIdx, [&]( const uint8_t * _pui8Frames, __m128d * _pmDst ) {
+			for ( uint16_t K = 0; K < _uiChannels / 2; ++K ) {
+				int32_t i32Bytes;
+				std::memcpy( &i32Bytes, _pui8Frames + K * 4, sizeof( i32Bytes ) );
+				__m128i mInts = _mm_sub_epi32( _mm_cvtepu8_epi32( _mm_cvtsi32_si128( i32Bytes ) ), mBias );
+				_pmDst[K*2] = _mm_div_pd( _mm_cvtepi32_pd( mInts ), mFactor );
+				_pmDst[K*2+1] = _mm_div_pd( _mm_cvtepi32_pd( _mm_shuffle_epi32( mInts, _MM_SHUFFLE( 1, 0, 3, 2 ) ) ), mFactor );
+			}
+		} );
+	}
+
+	/**
+	 * Converts pairs of interleaved 16-bit PCM frames to double using SSE 4.1.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _ppdDst One track per channel.
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 * \return Returns the number of frames converted.
+	 */
+	template <uint16_t _uiChannels>
+	static size_t Pcm16ToF64_SSE4( const uint8_t * _pui8Src, size_t _stFrames, double * const * _ppdDst, size_t _stDstIdx ) {
+		const __m128d mFactor = _mm_set1_pd( PcmFactor<16>() );
+		return DeinterleavePairs_SSE4<_uiChannels>( _pui8Src, _uiChannels * sizeof( int16_t ), _stFrames, _ppdDst, _stDstIdx, [&]( const uint8_t * _pui8Frames, __m128d * _pmDst ) {
+			for ( uint16_t K = 0; K < _uiChannels / 2; ++K ) {
+				__m128i mInts = _mm_cvtepi16_epi32( _mm_loadl_epi64( reinterpret_cast<const __m128i *>(_pui8Frames + K * 8) ) );
+				_pmDst[K*2] = _mm_div_pd( _mm_cvtepi32_pd( mInts ), mFactor );
+				_pmDst[K*2+1] = _mm_div_pd( _mm_cvtepi32_pd( _mm_shuffle_epi32( mInts, _MM_SHUFFLE( 1, 0, 3, 2 ) ) ), mFactor );
+			}
+		} );
+	}
+
+	/**
+	 * Converts pairs of interleaved 32-bit integer frames to double using SSE 4.1.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _ppdDst One track per channel.
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 * \param _dFactor The divisor applied to each sample.
+	 * \return Returns the number of frames converted.
+	 */
+	template <uint16_t _uiChannels>
+	static size_t Int32ToF64_SSE4( const uint8_t * _pui8Src, size_t _stFrames, double * const * _ppdDst, size_t _stDstIdx, double _dFactor ) {
+		const __m128d mFactor = _mm_set1_pd( _dFactor );
+		return DeinterleavePairs_SSE4<_uiChannels>( _pui8Src, _uiChannels * sizeof( int32_t ), _stFrames, _ppdDst, _stDstIdx, [&]( const uint8_t * _pui8Frames, __m128d * _pmDst ) {
+			for ( uint16_t K = 0; K < _uiChannels; ++K ) {
+				_pmDst[K] = _mm_div_pd( _mm_cvtepi32_pd( _mm_loadl_epi64( reinterpret_cast<const __m128i *>(_pui8Frames + K * 8) ) ), mFactor );
+			}
+		} );
+	}
+
+	/**
+	 * Converts pairs of interleaved 32-bit float frames to double using SSE 4.1.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _ppdDst One track per channel.
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 * \return Returns the number of frames converted.
+	 */
+	template <uint16_t _uiChannels>
+	static size_t F32ToF64_SSE4( const uint8_t * _pui8Src, size_t _stFrames, double * const * _ppdDst, size_t _stDstIdx ) {
+		return DeinterleavePairs_SSE4<_uiChannels>( _pui8Src, _uiChannels * sizeof( float ), _stFrames, _ppdDst, _stDstIdx, [&]( const uint8_t * _pui8Frames, __m128d * _pmDst ) {
+			for ( uint16_t K = 0; K < _uiChannels; ++K ) {
+				_pmDst[K] = _mm_cvtps_pd( _mm_castsi128_ps( _mm_loadl_epi64( reinterpret_cast<const __m128i *>(_pui8Frames + K * 8) ) ) );
+			}
+		} );
+	}
+
+	/**
+	 * Converts interleaved frames of any layout to double using SSE 4.1, 4 frames at a time.  SSE 4.1 has no gathers, so each sample is
+	 *	read on its own with _lLoad and only the conversion is done 2 samples at a time, but the results are identical to the scalar path.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stSampleSize The size of a sample in bytes.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppdDst One track per channel.
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 * \param _lLoad Reads one sample as a 32-bit value.
+	 * \param _cConvert Converts the 2 values in the low half of a register to doubles.
+	 * \return Returns the number of frames converted.
+	 */
+	template <typename _tLoad, typename _tConvert>
+	static size_t StridedToF64_SSE4( const uint8_t * _pui8Src, size_t _stSampleSize, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx,
+		const _tLoad &_lLoad, const _tConvert &_cConvert ) {
+		const size_t stFrameSize = _stSampleSize * _uiChannels;
+		return DecodeChannels_SIMD<4>( _pui8Src, _stSampleSize, _stFrames, _uiChannels, _ppdDst, _stDstIdx, [&]( const uint8_t * _pui8Samples ) {
+			return _mm_setr_epi32( _lLoad( _pui8Samples ), _lLoad( _pui8Samples + stFrameSize ), _lLoad( _pui8Samples + stFrameSize * 2 ), _lLoad( _pui8Samples + stFrameSize * 3 ) );
+		}, [&]( __m128i _mVals, double * _pdDst ) {
+			_mm_storeu_pd( _pdDst, _cConvert( _mVals ) );
+			_mm_storeu_pd( _pdDst + 2, _cConvert( _mm_shuffle_epi32( _mVals, _MM_SHUFFLE( 1, 0, 3, 2 ) ) ) );
+		} );
+	}
+
+	/**
+	 * Calls an SSE 4.1 deinterleaving kernel for the 2-, 4-, 6-, and 8-channel layouts they handle, or the general kernel for any
+	 *	other layout.  The deinterleaving kernel gets the channel count as a std::integral_constant.  A non-zero _uiFixed selects the
+	 *	kernel at compile time and _uiChannels is ignored.
+	 *
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _kKernel The deinterleaving kernel to call.
+	 * \param _gGeneral The kernel to call for any other layout.  Takes no parameters.
+	 * \return Returns the number of frames the kernel converted.
+	 */
+	template <uint16_t _uiFixed, typename _tKernel, typename _tGeneral>
+	static size_t DispatchPairs_SSE4( uint16_t _uiChannels, const _tKernel &_kKernel, const _tGeneral &_gGeneral ) {
+		if constexpr ( _uiFixed != 0 ) {
+			if constexpr ( _uiFixed % 2 == 0 && _uiFixed <= 8 ) { return _kKernel( std::integral_constant<uint16_t, _uiFixed>() ); }
+			else { return _gGeneral(); }
+		}
+		else {
+			switch ( _uiChannels ) {
+				case 2 : { return _kKernel( std::integral_constant<uint16_t, 2>() ); }
+				case 4 : { return _kKernel( std::integral_constant<uint16_t, 4>() ); }
+				case 6 : { return _kKernel( std::integral_constant<uint16_t, 6>() ); }
+				case 8 : { return _kKernel( std::integral_constant<uint16_t, 8>() ); }
+			}
+			return _gGeneral();
+		}
+	}
+#endif	// #ifdef __SSE4_1__
+
+#ifdef __AVX2__
+	/**
+	 * Loads interleaved PCM frames as 32-bit integers using AVX2, 8 frames at a time, and passes them to a store function.  Mono 8-,
+	 *	16-, and 32-bit samples are loaded directly and everything else is gathered.  Each sample is brought to the same 32-bit integer as
+	 *	the scalar path.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _pptDst One track per channel, of doubles or floats.
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 * \param _sStore Converts and stores 8 samples of one channel.
+	 * \return Returns the number of frames converted.
+	 */
+	template <unsigned _uiBits, typename _tSample, typename _tStore>
+	static size_t PcmDecode_AVX2( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, _tSample * const * _pptDst, size_t _stDstIdx, const _tStore &_sStore ) {
+		constexpr size_t stSampleSize = _uiBits / 8;
+		const __m256i mIdx = _mm256_mullo_epi32( _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ), _mm256_set1_epi32( int32_t( stSampleSize * _uiChannels ) ) );
+		if ( _uiChannels == 1 ) {
+			return DecodeChannels_SIMD<8>( _pui8Src, stSampleSize, _stFrames, _uiChannels, _pptDst, _stDstIdx, []( const uint8_t * _pui8Samples ) {
+				if constexpr ( _uiBits == 8 ) {
+					return _mm256_sub_epi32( _mm256_cvtepu8_epi32( _mm_loadl_epi64( reinterpret_cast<const __m128i *>(_pui8Samples) ) ), _mm256_set1_epi32( 128 ) );
+				}
+				else if constexpr ( _uiBits == 16 ) {
+					return _mm256_cvtepi16_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i *>(_pui8Samples) ) );
+				}
+				else {
+					return _mm256_loadu_si256( reinterpret_cast<const __m256i *>(_pui8Samples) );
+				}
+			}, _sStore );
+		}
+		return DecodeChannels_SIMD<8>( _pui8Src, stSampleSize, _stFrames, _uiChannels, _pptDst, _stDstIdx, [&]( const uint8_t * _pui8Samples ) {
+			__m256i mRaw = _mm256_i32gather_epi32( reinterpret_cast<const int *>(_pui8Samples), mIdx, 1 );
+			if constexpr ( _uiBits == 8 ) {
+				return _mm256_sub_epi32( _mm256_and_si256( mRaw, _mm256_set1_epi32( 0xFF ) ), _mm256_set1_epi32( 128 ) );
+			}
+			else if constexpr ( _uiBits == 16 ) {
+				return _mm256_srai_epi32( _mm256_slli_epi32( mRaw, 16 ), 16 );
+			}
+			else {
+				return mRaw;
+			}
+		}, _sStore );
+	}
+
+	/**
+	 * Converts interleaved PCM frames to double using AVX2, 8 frames at a time.  Each sample is brought to the same 32-bit integer as
+	 *	the scalar path and divided by the same factor, so the results are identical.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppdDst One track per channel.
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 * \param _dFactor The divisor applied to each 32-bit sample.
+	 * \return Returns the number of frames converted.
+	 */
+	template <unsigned _uiBits>
+	static size_t PcmToF64_AVX2( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx, double _dFactor ) {
+		const __m256d mFactor = _mm256_set1_pd( _dFactor );
+		return PcmDecode_AVX2<_uiBits>( _pui8Src, _stFrames, _uiChannels, _ppdDst, _stDstIdx, [&]( __m256i _mInts, double * _pdDst ) {
+			_mm256_storeu_pd( _pdDst, _mm256_div_pd( _mm256_cvtepi32_pd( _mm256_castsi256_si128( _mInts ) ), mFactor ) );
+			_mm256_storeu_pd( _pdDst + 4, _mm256_div_pd( _mm256_cvtepi32_pd( _mm256_extracti128_si256( _mInts, 1 ) ), mFactor ) );
+		} );
+	}
+
+	/**
+	 * Converts interleaved PCM frames to float using AVX2, 8 frames at a time.  Each sample is brought to the same 32-bit integer as
+	 *	the scalar path and divided by the same factor, so the results are identical.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppfDst One track per channel.
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 * \param _fFactor The divisor applied to each 32-bit sample.
+	 * \return Returns the number of frames converted.
+	 */
+	template <unsigned _uiBits>
+	static size_t PcmToF32_AVX2( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, float * const * _ppfDst, size_t _stDstIdx, float _fFactor ) {
+		const __m256 mFactor = _mm256_set1_ps( _fFactor );
+		return PcmDecode_AVX2<_uiBits>( _pui8Src, _stFrames, _uiChannels, _ppfDst, _stDstIdx, [&]( __m256i _mInts, float * _pfDst ) {
+			_mm256_storeu_ps( _pfDst, _mm256_div_ps( _mm256_cvtepi32_ps( _mInts ), mFactor ) );
+		} );
+	}
+
+	/**
+	 * Converts interleaved 32-bit float frames to double using AVX2, 8 frames at a time.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppdDst One track per channel.
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 * \return Returns the number of frames converted.
+	 */
+	static size_t F32ToF64_AVX2( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx ) {
+		return PcmDecode_AVX2<32>( _pui8Src, _stFrames, _uiChannels, _ppdDst, _stDstIdx, []( __m256i _mFloats, double * _pdDst ) {
+			_mm256_storeu_pd( _pdDst, _mm256_cvtps_pd( _mm_castsi128_ps( _mm256_castsi256_si128( _mFloats ) ) ) );
+			_mm256_storeu_pd( _pdDst + 4, _mm256_cvtps_pd( _mm_castsi128_ps( _mm256_extracti128_si256( _mFloats, 1 ) ) ) );
+		} );
+	}
+
+	/**
+	 * Deinterleaves 32-bit float frames using AVX2, 8 frames at a time.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppfDst One track per channel.
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 * \return Returns the number of frames converted.
+	 */
+	static size_t F32ToF32_AVX2( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, float * const * _ppfDst, size_t _stDstIdx ) {
+		return PcmDecode_AVX2<32>( _pui8Src, _stFrames, _uiChannels, _ppfDst, _stDstIdx, []( __m256i _mFloats, float * _pfDst ) {
+			_mm256_storeu_ps( _pfDst, _mm256_castsi256_ps( _mFloats ) );
+		} );
+	}
+
+	/**
+	 * Deinterleaves 64-bit float frames using AVX2, 4 frames at a time.  Mono frames are copied, stereo frames are split with
+	 *	permutes and unpacks, and everything else is gathered.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppdDst One track per channel.
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 * \return Returns the number of frames converted.
+	 */
+	static size_t F64ToF64_AVX2( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx ) {
+		const double * pdSrc = reinterpret_cast<const double *>(_pui8Src);
+		const int64_t i64Stride = _uiChannels;
+		const __m256i mIdx = _mm256_setr_epi64x( 0, i64Stride, i64Stride * 2, i64Stride * 3 );
+		size_t I = 0;
+		for ( ; I + 4 <= _stFrames; I += 4 ) {
+			const double * pdFrames = pdSrc + I * _uiChannels;
+			switch ( _uiChannels ) {
+				case 1 : {
+					_mm256_storeu_pd( _ppdDst[0] + _stDstIdx + I, _mm256_loadu_pd( pdFrames ) );
+					break;
+				}
+				case 2 : {
+					// L0 R0 L1 R1 and L2 R2 L3 R3 become L0 R0 L2 R2 and L1 R1 L3 R3, whose unpacks are the channels.
+					__m256d mA = _mm256_loadu_pd( pdFrames );
+					__m256d mB = _mm256_loadu_pd( pdFrames + 4 );
+					__m256d mLo = _mm256_permute2f128_pd( mA, mB, 0x20 );
+					__m256d mHi = _mm256_permute2f128_pd( mA, mB, 0x31 );
+					_mm256_storeu_pd( _ppdDst[0] + _stDstIdx + I, _mm256_unpacklo_pd( mLo, mHi ) );
+					_mm256_storeu_pd( _ppdDst[1] + _stDstIdx + I, _mm256_unpackhi_pd( mLo, mHi ) );
+					break;
+				}
+				default : {
+					for ( uint16_t C = 0; C < _uiChannels; ++C ) {
+						_mm256_storeu_pd( _ppdDst[C] + _stDstIdx + I, _mm256_i64gather_pd( pdFrames + C, mIdx, sizeof( double ) ) );
+					}
+					break;
+				}
+			}
+		}
+		return I;
+	}
+#endif	// #ifdef __AVX2__
+
+#ifdef __AVX512F__
+	/**
+	 * Loads interleaved PCM frames as 32-bit integers using AVX-512, 16 frames at a time, and passes them to a store function.  Mono
+	 *	8-, 16-, and 32-bit samples are loaded directly and everything else is gathered.  Each sample is brought to the same 32-bit
+	 *	integer as the scalar path.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _pptDst One track per channel, of doubles or floats.
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 * \param _sStore Converts and stores 16 samples of one channel.
+	 * \return Returns the number of frames converted.
+	 */
+	template <unsigned _uiBits, typename _tSample, typename _tStore>
+	static size_t PcmDecode_AVX512( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, _tSample * const * _pptDst, size_t _stDstIdx, const _tStore &_sStore ) {
+		constexpr size_t stSampleSize = _uiBits / 8;
+		const __m512i mIdx = _mm512_mullo_epi32( _mm512_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 ), _mm512_set1_epi32( int32_t( stSampleSize * _uiChannels ) ) );
+		if ( _uiChannels == 1 ) {
+			return DecodeChannels_SIMD<16>( _pui8Src, stSampleSize, _stFrames, _uiChannels, _pptDst, _stDstIdx, []( const uint8_t * _pui8Samples ) {
+				if constexpr ( _uiBits == 8 ) {
+					return _mm512_sub_epi32( _mm512_cvtepu8_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i *>(_pui8Samples) ) ), _mm512_set1_epi32( 128 ) );
+				}
+				else if constexpr ( _uiBits == 16 ) {
+					return _mm512_cvtepi16_epi32( _mm256_loadu_si256( reinterpret_cast<const __m256i *>(_pui8Samples) ) );
+				}
+				else {
+					return _mm512_loadu_si512( _pui8Samples );
+				}
+			}, _sStore );
+		}
+		return DecodeChannels_SIMD<16>( _pui8Src, stSampleSize, _stFrames, _uiChannels, _pptDst, _stDstIdx, [&]( const uint8_t * _pui8Samples ) {
+			__m512i mRaw = _mm512_i32gather_epi32( mIdx, _pui8Samples, 1 );
+			if constexpr ( _uiBits == 8 ) {
+				return _mm512_sub_epi32( _mm512_and_si512( mRaw, _mm512_set1_epi32( 0xFF ) ), _mm512_set1_epi32( 128 ) );
+			}
+			else if constexpr ( _uiBits == 16 ) {
+				return _mm512_srai_epi32( _mm512_slli_epi32( mRaw, 16 ), 16 );
+			}
+			else {
+				return mRaw;
+			}
+		}, _sStore );
+	}
+
+	/**
+	 * Converts interleaved PCM frames to double using AVX-512, 16 frames at a time.  Each sample is brought to the same 32-bit integer
+	 *	as the scalar path and divided by the same factor, so the results are identical.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppdDst One track per channel.
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 * \param _dFactor The divisor applied to each 32-bit sample.
+	 * \return Returns the number of frames converted.
+	 */
+	template <unsigned _uiBits>
+	static size_t PcmToF64_AVX512( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx, double _dFactor ) {
+		const __m512d mFactor = _mm512_set1_pd( _dFactor );
+		return PcmDecode_AVX512<_uiBits>( _pui8Src, _stFrames, _uiChannels, _ppdDst, _stDstIdx, [&]( __m512i _mInts, double * _pdDst ) {
+			_mm512_storeu_pd( _pdDst, _mm512_div_pd( _mm512_cvtepi32_pd( _mm512_castsi512_si256( _mInts ) ), mFactor ) );
+			_mm512_storeu_pd( _pdDst + 8, _mm512_div_pd( _mm512_cvtepi32_pd( _mm512_extracti64x4_epi64( _mInts, 1 ) ), mFactor ) );
+		} );
+	}
+
+	/**
+	 * Converts interleaved PCM frames to float using AVX-512, 16 frames at a time.  Each sample is brought to the same 32-bit integer
+	 *	as the scalar path and divided by the same factor, so the results are identical.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppfDst One track per channel.
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 * \param _fFactor The divisor applied to each 32-bit sample.
+	 * \return Returns the number of frames converted.
+	 */
+	template <unsigned _uiBits>
+	static size_t PcmToF32_AVX512( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, float * const * _ppfDst, size_t _stDstIdx, float _fFactor ) {
+		const __m512 mFactor = _mm512_set1_ps( _fFactor );
+		return PcmDecode_AVX512<_uiBits>( _pui8Src, _stFrames, _uiChannels, _ppfDst, _stDstIdx, [&]( __m512i _mInts, float * _pfDst ) {
+			_mm512_storeu_ps( _pfDst, _mm512_div_ps( _mm512_cvtepi32_ps( _mInts ), mFactor ) );
+		} );
+	}
+
+	/**
+	 * Converts interleaved 32-bit float frames to double using AVX-512, 16 frames at a time.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppdDst One track per channel.
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 * \return Returns the number of frames converted.
+	 */
+	static size_t F32ToF64_AVX512( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx ) {
+		return PcmDecode_AVX512<32>( _pui8Src, _stFrames, _uiChannels, _ppdDst, _stDstIdx, []( __m512i _mFloats, double * _pdDst ) {
+			_mm512_storeu_pd( _pdDst, _mm512_cvtps_pd( _mm256_castsi256_ps( _mm512_castsi512_si256( _mFloats ) ) ) );
+			_mm512_storeu_pd( _pdDst + 8, _mm512_cvtps_pd( _mm256_castsi256_ps( _mm512_extracti64x4_epi64( _mFloats, 1 ) ) ) );
+		} );
+	}
+
+	/**
+	 * Deinterleaves 32-bit float frames using AVX-512, 16 frames at a time.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppfDst One track per channel.
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 * \return Returns the number of frames converted.
+	 */
+	static size_t F32ToF32_AVX512( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, float * const * _ppfDst, size_t _stDstIdx ) {
+		return PcmDecode_AVX512<32>( _pui8Src, _stFrames, _uiChannels, _ppfDst, _stDstIdx, []( __m512i _mFloats, float * _pfDst ) {
+			_mm512_storeu_ps( _pfDst, _mm512_castsi512_ps( _mFloats ) );
+		} );
+	}
+
+	/**
+	 * Deinterleaves 64-bit float frames using AVX-512, 8 frames at a time.  Mono frames are copied and everything else is gathered.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.
+	 * \param _ppdDst One track per channel.
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 * \return Returns the number of frames converted.
+	 */
+	static size_t F64ToF64_AVX512( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx ) {
+		const double * pdSrc = reinterpret_cast<const double *>(_pui8Src);
+		const int64_t i64Stride = _uiChannels;
+		const __m512i mIdx = _mm512_setr_epi64( 0, i64Stride, i64Stride * 2, i64Stride * 3, i64Stride * 4, i64Stride * 5, i64Stride * 6, i64Stride * 7 );
+		size_t I = 0;
+		for ( ; I + 8 <= _stFrames; I += 8 ) {
+			const double * pdFrames = pdSrc + I * _uiChannels;
+			if ( _uiChannels == 1 ) {
+				_mm512_storeu_pd( _ppdDst[0] + _stDstIdx + I, _mm512_loadu_pd( pdFrames ) );
+				continue;
+			}
+			for ( uint16_t C = 0; C < _uiChannels; ++C ) {
+				_mm512_storeu_pd( _ppdDst[C] + _stDstIdx + I, _mm512_i64gather_pd( mIdx, pdFrames + C, sizeof( double ) ) );
+			}
+		}
+		return I;
+	}
+
+	/**
+	 * Permutation tables that interleave 8 frames of _uiChannels channels held as 32-bit integers.  The input is packed 2 channels per
+	 *	register, channel 2Z in the low 8 lanes of register Z and channel 2Z+1 in the high 8 lanes, so sample F of channel C is lane
+	 *	(C % 2) * 8 + F of register C / 2.  Output register M holds interleaved samples M * 16 through M * 16 + 15.
+	 */
+	template <uint16_t _uiChannels>
+	struct PW_INTERLEAVE_8 {
+		static_assert( _uiChannels >= 1 && _uiChannels <= 8, "Only 1 to 8 channels can be interleaved in registers." );
+		static constexpr size_t											Outputs = (_uiChannels * 8 + 15) / 16;
+
+		int32_t															i32Lo[Outputs][16];		// Indices into input registers 0 and 1.
+		int32_t															i32Hi[Outputs][16];		// Indices into input registers 2 and 3.
+		uint16_t														ui16HiMask[Outputs];	// Lanes taken from input registers 2 and 3.
+
+		constexpr PW_INTERLEAVE_8() :
+			i32Lo{},
+			i32Hi{},
+			ui16HiMask{} {
+			for ( size_t M = 0; M < Outputs; ++M ) {
+				for ( size_t K = 0; K < 16; ++K ) {
+					size_t stFrame = (M * 16 + K) / _uiChannels;
+					size_t stChan = (M * 16 + K) % _uiChannels;
+					if ( stFrame >= 8 ) { continue; }
+					size_t stReg = stChan / 2;
+					int32_t i32Lane = int32_t( (stChan % 2) * 8 + stFrame );
+					if ( stReg < 2 ) {
+						i32Lo[M][K] = int32_t( stReg * 16 ) + i32Lane;
+					}
+					else {
+						i32Hi[M][K] = int32_t( (stReg - 2) * 16 ) + i32Lane;
+						ui16HiMask[M] |= uint16_t( 1 << K );
+					}
+				}
+			}
+		}
+	};
+
+	/**
+	 * Converts 8 frames of one channel to rounded 32-bit integers using AVX-512.  Rounding is half away from zero.
+	 *
+	 * \param _pdSrc The first sample to convert.
+	 * \param _mFactor The scale applied after clamping to [-1,1].
+	 * \return Returns the 8 converted samples.
+	 */
+	static inline __m256i F64ToInt32x8_AVX512( const double * _pdSrc, const __m512d &_mFactor ) {
+		__m512d mSamples = _mm512_loadu_pd( _pdSrc );
+		mSamples = _mm512_max_pd( mSamples, _mm512_set1_pd( -1.0 ) );
+		mSamples = _mm512_min_pd( mSamples, _mm512_set1_pd( 1.0 ) );
+		mSamples = _mm512_mul_pd( mSamples, _mFactor );
+
+		// Round half away from zero like std::round(), not to even, so that the results match the scalar path.
+		__m512d mTrunc = _mm512_roundscale_pd( mSamples, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC );
+		__mmask8 mHalf = _mm512_cmp_pd_mask( _mm512_abs_pd( _mm512_sub_pd( mSamples, mTrunc ) ), _mm512_set1_pd( 0.5 ), _CMP_GE_OQ );
+		__m512i mStep = _mm512_or_si512( _mm512_and_si512( _mm512_castpd_si512( mSamples ), _mm512_set1_epi64( INT64_MIN ) ),
+			_mm512_castpd_si512( _mm512_set1_pd( 1.0 ) ) );
+		mTrunc = _mm512_mask_add_pd( mTrunc, mHalf, mTrunc, _mm512_castsi512_pd( mStep ) );
+		return _mm512_cvttpd_epi32( mTrunc );
+	}
+
+	/**
+	 * Stores interleaved 32-bit samples as 16- or 32-bit samples.
+	 *
+	 * \param _ptDst The destination of the first sample.
+	 * \param _mSamples The samples to store.
+	 * \param _stLanes The number of samples to store, either 8 or 16.
+	 */
+	template <typename _tType>
+	static inline void StoreInt32x16_AVX512( _tType * _ptDst, __m512i _mSamples, size_t _stLanes ) {
+		if constexpr ( sizeof( _tType ) == sizeof( int16_t ) ) {
+			__m256i mNarrow = _mm512_cvtsepi32_epi16( _mSamples );
+			if ( _stLanes == 16 ) { _mm256_storeu_si256( reinterpret_cast<__m256i *>(_ptDst), mNarrow ); }
+			else { _mm_storeu_si128( reinterpret_cast<__m128i *>(_ptDst), _mm256_castsi256_si128( mNarrow ) ); }
+		}
+		else {
+			if ( _stLanes == 16 ) { _mm512_storeu_si512( _ptDst, _mSamples ); }
+			else { _mm512_mask_storeu_epi32( _ptDst, 0x00FF, _mSamples ); }
+		}
+	}
+
+	/**
+	 * Encodes 8 frames at a time of 1 to 8 channels to interleaved 16- or 32-bit samples using AVX-512.  Each channel is converted in a
+	 *	register, the channels are interleaved in registers with PW_INTERLEAVE_8 permutes, and the result is stored directly to
+	 *	the destination.
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _cConvert Converts 8 doubles to a register of 8 32-bit samples.
+	 * \param _ptDst The destination of the first frame.
+	 * \return Returns the number of frames converted, which is _stFrames rounded down to a multiple of 8.
+	 */
+	template <uint16_t _uiChannels, typename _tType, typename _tConvert>
+	static size_t F64Interleaved_AVX512( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, const _tConvert &_cConvert, _tType * _ptDst ) {
+		static constexpr PW_INTERLEAVE_8<_uiChannels> s_iTable;
+		constexpr size_t stRegs = (_uiChannels + 1) / 2;
+		size_t I = 0;
+		for ( ; I + 8 <= _stFrames; I += 8 ) {
+			__m256i mInts[stRegs*2];
+			for ( size_t C = 0; C < _uiChannels; ++C ) {
+				mInts[C] = _cConvert( _ppdSrc[C] + _stSrcIdx + I );
+			}
+			if constexpr ( _uiChannels % 2 ) { mInts[_uiChannels] = _mm256_setzero_si256(); }
+
+			__m512i mPairs[stRegs];
+			for ( size_t Z = 0; Z < stRegs; ++Z ) {
+				mPairs[Z] = _mm512_inserti64x4( _mm512_castsi256_si512( mInts[Z*2] ), mInts[Z*2+1], 1 );
+			}
+			for ( size_t M = 0; M < s_iTable.Outputs; ++M ) {
+				__m512i mOut;
+				if constexpr ( stRegs == 1 ) {
+					mOut = _mm512_permutexvar_epi32( _mm512_loadu_si512( s_iTable.i32Lo[M] ), mPairs[0] );
+				}
+				else {
+					mOut = _mm512_permutex2var_epi32( mPairs[0], _mm512_loadu_si512( s_iTable.i32Lo[M] ), mPairs[1] );
+					if constexpr ( stRegs > 2 ) {
+						__m512i mHi = _mm512_permutex2var_epi32( mPairs[2], _mm512_loadu_si512( s_iTable.i32Hi[M] ), mPairs[stRegs-1] );
+						mOut = _mm512_mask_blend_epi32( s_iTable.ui16HiMask[M], mOut, mHi );
+					}
+				}
+				StoreInt32x16_AVX512( _ptDst + I * _uiChannels + M * 16, mOut, Min<size_t>( 16, _uiChannels * 8 - M * 16 ) );
+			}
+		}
+		return I;
+	}
+
+	/**
+	 * Encodes 8 frames at a time of any number of channels to interleaved 16- or 32-bit samples using AVX-512.  Each channel is
+	 *	converted in a register and its 8 samples are scattered to their frames.
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _cConvert Converts 8 doubles to a register of 8 32-bit samples.
+	 * \param _ptDst The destination of the first frame.
+	 * \return Returns the number of frames converted, which is _stFrames rounded down to a multiple of 8.
+	 */
+	template <typename _tType, typename _tConvert>
+	static size_t F64Scattered_AVX512( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, const _tConvert &_cConvert, _tType * _ptDst ) {
+		alignas( 32 ) int32_t i32Lanes[8];
+		size_t I = 0;
+		for ( ; I + 8 <= _stFrames; I += 8 ) {
+			for ( uint16_t C = 0; C < _uiChannels; ++C ) {
+				_mm256_store_si256( reinterpret_cast<__m256i *>(i32Lanes), _cConvert( _ppdSrc[C] + _stSrcIdx + I ) );
+				for ( size_t F = 0; F < 8; ++F ) {
+					_ptDst[(I+F)*_uiChannels+C] = static_cast<_tType>(i32Lanes[F]);
+				}
+			}
+		}
+		return I;
+	}
+
+	/**
+	 * Encodes frames to interleaved 16- or 32-bit samples using AVX-512, picking the kernel for the channel count.
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _cConvert Converts 8 doubles to a register of 8 32-bit samples.
+	 * \param _ptDst The destination of the first frame.
+	 * \return Returns the number of frames converted, which is _stFrames rounded down to a multiple of 8.
+	 */
+	template <typename _tType, typename _tConvert>
+	static size_t F64Encode_AVX512( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, const _tConvert &_cConvert, _tType * _ptDst ) {
+		switch ( _uiChannels ) {
+			case 1 : { return F64Interleaved_AVX512<1>( _ppdSrc, _stSrcIdx, _stFrames, _cConvert, _ptDst ); }
+			case 2 : { return F64Interleaved_AVX512<2>( _ppdSrc, _stSrcIdx, _stFrames, _cConvert, _ptDst ); }
+			case 3 : { return F64Interleaved_AVX512<3>( _ppdSrc, _stSrcIdx, _stFrames, _cConvert, _ptDst ); }
+			case 4 : { return F64Interleaved_AVX512<4>( _ppdSrc, _stSrcIdx, _stFrames, _cConvert, _ptDst ); }
+			case 5 : { return F64Interleaved_AVX512<5>( _ppdSrc, _stSrcIdx, _stFrames, _cConvert, _ptDst ); }
+			case 6 : { return F64Interleaved_AVX512<6>( _ppdSrc, _stSrcIdx, _stFrames, _cConvert, _ptDst ); }
+			case 7 : { return F64Interleaved_AVX512<7>( _ppdSrc, _stSrcIdx, _stFrames, _cConvert, _ptDst ); }
+			case 8 : { return F64Interleaved_AVX512<8>( _ppdSrc, _stSrcIdx, _stFrames, _cConvert, _ptDst ); }
+		}
+		return F64Scattered_AVX512( _ppdSrc, _stSrcIdx, _stFrames, _uiChannels, _cConvert, _ptDst );
+	}
+
+	/**
+	 * Converts frames to interleaved 16- or 32-bit PCM using AVX-512.
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _dFactor The scale applied after clamping to [-1,1].
+	 * \param _ptDst The destination of the first frame.
+	 * \return Returns the number of frames converted, which is _stFrames rounded down to a multiple of 8.
+	 */
+	template <typename _tType>
+	static size_t F64ToPcm_AVX512( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, double _dFactor, _tType * _ptDst ) {
+		const __m512d mFactor = _mm512_set1_pd( _dFactor );
+		return F64Encode_AVX512( _ppdSrc, _stSrcIdx, _stFrames, _uiChannels, [&]( const double * _pdSrc ) {
+			return F64ToInt32x8_AVX512( _pdSrc, mFactor );
+		}, _ptDst );
+	}
+
+	/**
+	 * Converts frames to interleaved 32-bit float using AVX-512.  Each double is rounded to the nearest float, as a cast does.
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _pi32Dst The destination of the first frame, receiving the bits of each float.
+	 * \return Returns the number of frames converted, which is _stFrames rounded down to a multiple of 8.
+	 */
+	static size_t F64ToFloat32_AVX512( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, int32_t * _pi32Dst ) {
+		return F64Encode_AVX512( _ppdSrc, _stSrcIdx, _stFrames, _uiChannels, []( const double * _pdSrc ) {
+			return _mm256_castps_si256( _mm512_cvtpd_ps( _mm512_loadu_pd( _pdSrc ) ) );
+		}, _pi32Dst );
+	}
+
+	/**
+	 * Interleaves per-channel tracks of doubles into 64-bit float frames using AVX-512, 8 frames at a time.  Mono frames are copied and
+	 *	everything else is scattered.
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _pdDst The destination of the first frame.
+	 * \return Returns the number of frames converted.
+	 */
+	static size_t F64ToFloat64_AVX512( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, double * _pdDst ) {
+		const int64_t i64Stride = _uiChannels;
+		const __m512i mIdx = _mm512_setr_epi64( 0, i64Stride, i64Stride * 2, i64Stride * 3, i64Stride * 4, i64Stride * 5, i64Stride * 6, i64Stride * 7 );
+		size_t I = 0;
+		for ( ; I + 8 <= _stFrames; I += 8 ) {
+			double * pdFrames = _pdDst + I * _uiChannels;
+			if ( _uiChannels == 1 ) {
+				_mm512_storeu_pd( pdFrames, _mm512_loadu_pd( _ppdSrc[0] + _stSrcIdx + I ) );
+				continue;
+			}
+			for ( uint16_t C = 0; C < _uiChannels; ++C ) {
+				_mm512_i64scatter_pd( pdFrames + C, mIdx, _mm512_loadu_pd( _ppdSrc[C] + _stSrcIdx + I ), sizeof( double ) );
+			}
+		}
+		return I;
+	}
+#endif	// #ifdef __AVX512F__
+
+	/** Byte permutes between 16 packed 24-bit samples and 16 32-bit samples: widened samples sit in the top 3 bytes, packed samples come from the low 3. */
+	struct PW_PCM24_PERMUTE {
+		uint8_t															ui8Widen[64];			// Byte 4K+J+1 of a widened sample comes from byte 3K+J.
+		uint8_t															ui8Narrow[64];			// Byte 3K+J of a packed sample comes from byte 4K+J.
+
+		constexpr PW_PCM24_PERMUTE() :
+			ui8Widen{},
+			ui8Narrow{} {
+			for ( size_t K = 0; K < 16; ++K ) {
+				for ( size_t J = 0; J < 3; ++J ) {
+					ui8Widen[K*4+J+1] = uint8_t( K * 3 + J );
+					ui8Narrow[K*3+J] = uint8_t( K * 4 + J );
+				}
+			}
+		}
+	};
+
+#ifdef __SSE4_1__
+	/**
+	 * Widens packed 24-bit samples to 32 bits using SSSE3 shuffles, 4 samples at a time.  Each sample lands in the top 3 bytes of its
+	 *	32-bit value, as in the scalar decoder.  No bytes past the last sample are read.
+	 *
+	 * \param _pui8Src The first sample to widen.
+	 * \param _stSamples The number of samples to widen.
+	 * \param _pi32Dst The buffer to which to write the widened samples.
+	 * \return Returns the number of samples widened.
+	 */
+	static size_t Pcm24ToInt32_SSE4( const uint8_t * _pui8Src, size_t _stSamples, int32_t * _pi32Dst ) {
+		const __m128i mShuffle = _mm_setr_epi8( -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11 );
+		size_t I = 0;
+		for ( ; I + 4 <= _stSamples; I += 4 ) {
+			const uint8_t * pui8Src = _pui8Src + I * 3;
+			int32_t i32Last;
+			std::memcpy( &i32Last, pui8Src + 8, sizeof( i32Last ) );
+			__m128i mBytes = _mm_insert_epi32( _mm_loadl_epi64( reinterpret_cast<const __m128i *>(pui8Src) ), i32Last, 2 );
+			_mm_storeu_si128( reinterpret_cast<__m128i *>(_pi32Dst + I), _mm_shuffle_epi8( mBytes, mShuffle ) );
+		}
+		return I;
+	}
+
+	/**
+	 * Packs 32-bit samples to 24 bits using SSSE3 shuffles, 4 samples at a time.  The low 3 bytes of each sample are kept.  No bytes
+	 *	past the last sample are written.
+	 *
+	 * \param _pi32Src The first sample to pack.
+	 * \param _stSamples The number of samples to pack.
+	 * \param _pui8Dst The buffer to which to write the packed samples.
+	 * \return Returns the number of samples packed.
+	 */
+	static size_t Int32ToPcm24_SSE4( const int32_t * _pi32Src, size_t _stSamples, uint8_t * _pui8Dst ) {
+		const __m128i mShuffle = _mm_setr_epi8( 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1 );
+		size_t I = 0;
+		for ( ; I + 4 <= _stSamples; I += 4 ) {
+			__m128i mBytes = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i *>(_pi32Src + I) ), mShuffle );
+			uint8_t * pui8Dst = _pui8Dst + I * 3;
+			_mm_storel_epi64( reinterpret_cast<__m128i *>(pui8Dst), mBytes );
+			int32_t i32Last = _mm_extract_epi32( mBytes, 2 );
+			std::memcpy( pui8Dst + 8, &i32Last, sizeof( i32Last ) );
+		}
+		return I;
+	}
+
+	/**
+	 * Clamps, scales, and rounds per-channel tracks to interleaved 32-bit integers using SSE 4.1, 2 frames at a time.  Rounding is half
+	 *	away from zero, as with std::round(), so the results are identical to the scalar path.
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _dFactor The scale applied after clamping to [-1,1].
+	 * \param _pi32Dst The buffer to which to write the frames.
+	 * \return Returns the number of frames converted.
+	 */
+	static size_t F64ToInt32_SSE4( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, double _dFactor, int32_t * _pi32Dst ) {
+		const __m128d mFactor = _mm_set1_pd( _dFactor );
+		const __m128d mSign = _mm_set1_pd( -0.0 );
+		alignas( 16 ) int32_t i32Lanes[4];
+		size_t I = 0;
+		for ( ; I + 2 <= _stFrames; I += 2 ) {
+			for ( uint16_t C = 0; C < _uiChannels; ++C ) {
+				__m128d mVal = _mm_loadu_pd( _ppdSrc[C] + _stSrcIdx + I );
+				mVal = _mm_mul_pd( _mm_min_pd( _mm_max_pd( mVal, _mm_set1_pd( -1.0 ) ), _mm_set1_pd( 1.0 ) ), mFactor );
+				__m128d mTrunc = _mm_round_pd( mVal, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC );
+				__m128d mHalf = _mm_cmpge_pd( _mm_andnot_pd( mSign, _mm_sub_pd( mVal, mTrunc ) ), _mm_set1_pd( 0.5 ) );
+				mTrunc = _mm_add_pd( mTrunc, _mm_and_pd( mHalf, _mm_or_pd( _mm_and_pd( mVal, mSign ), _mm_set1_pd( 1.0 ) ) ) );
+				_mm_store_si128( reinterpret_cast<__m128i *>(i32Lanes), _mm_cvttpd_epi32( mTrunc ) );
+				_pi32Dst[I*_uiChannels+C] = i32Lanes[0];
+				_pi32Dst[(I+1)*_uiChannels+C] = i32Lanes[1];
+			}
+		}
+		return I;
+	}
+#endif	// #ifdef __SSE4_1__
+
+#ifdef __AVX2__
+	/**
+	 * Widens packed 24-bit samples to 32 bits using AVX2 shuffles, 8 samples at a time.  Each sample lands in the top 3 bytes of its
+	 *	32-bit value, as in the scalar decoder.  No bytes past the last sample are read.
+	 *
+	 * \param _pui8Src The first sample to widen.
+	 * \param _stSamples The number of samples to widen.
+	 * \param _pi32Dst The buffer to which to write the widened samples.
+	 * \return Returns the number of samples widened.
+	 */
+	static size_t Pcm24ToInt32_AVX2( const uint8_t * _pui8Src, size_t _stSamples, int32_t * _pi32Dst ) {
+		// The high lane is loaded 8 bytes in, so its 4 samples start at byte 4.
+		const __m256i mShuffle = _mm256_setr_epi8( -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+			-1, 4, 5, 6, -1, 7, 8, 9, -1, 10, 11, 12, -1, 13, 14, 15 );
+		size_t I = 0;
+		for ( ; I + 8 <= _stSamples; I += 8 ) {
+			const uint8_t * pui8Src = _pui8Src + I * 3;
+			__m256i mBytes = _mm256_inserti128_si256( _mm256_castsi128_si256( _mm_loadu_si128( reinterpret_cast<const __m128i *>(pui8Src) ) ),
+				_mm_loadu_si128( reinterpret_cast<const __m128i *>(pui8Src + 8) ), 1 );
+			_mm256_storeu_si256( reinterpret_cast<__m256i *>(_pi32Dst + I), _mm256_shuffle_epi8( mBytes, mShuffle ) );
+		}
+		return I;
+	}
+
+	/**
+	 * Packs 32-bit samples to 24 bits using AVX2 shuffles, 8 samples at a time.  The low 3 bytes of each sample are kept.  No bytes past
+	 *	the last sample are written.
+	 *
+	 * \param _pi32Src The first sample to pack.
+	 * \param _stSamples The number of samples to pack.
+	 * \param _pui8Dst The buffer to which to write the packed samples.
+	 * \return Returns the number of samples packed.
+	 */
+	static size_t Int32ToPcm24_AVX2( const int32_t * _pi32Src, size_t _stSamples, uint8_t * _pui8Dst ) {
+		const __m256i mShuffle = _mm256_setr_epi8( 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+			0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1 );
+		// Moves the 12 packed bytes of the high lane down against those of the low lane.
+		const __m256i mJoin = _mm256_setr_epi32( 0, 1, 2, 4, 5, 6, 3, 7 );
+		size_t I = 0;
+		for ( ; I + 8 <= _stSamples; I += 8 ) {
+			__m256i mBytes = _mm256_shuffle_epi8( _mm256_loadu_si256( reinterpret_cast<const __m256i *>(_pi32Src + I) ), mShuffle );
+			mBytes = _mm256_permutevar8x32_epi32( mBytes, mJoin );
+			uint8_t * pui8Dst = _pui8Dst + I * 3;
+			_mm_storeu_si128( reinterpret_cast<__m128i *>(pui8Dst), _mm256_castsi256_si128( mBytes ) );
+			_mm_storel_epi64( reinterpret_cast<__m128i *>(pui8Dst + 16), _mm256_extracti128_si256( mBytes, 1 ) );
+		}
+		return I;
+	}
+
+	/**
+	 * Clamps, scales, and rounds per-channel tracks to interleaved 32-bit integers using AVX2, 4 frames at a time.  Rounding is half
+	 *	away from zero, as with std::round(), so the results are identical to the scalar path.
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _dFactor The scale applied after clamping to [-1,1].
+	 * \param _pi32Dst The buffer to which to write the frames.
+	 * \return Returns the number of frames converted.
+	 */
+	static size_t F64ToInt32_AVX2( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, double _dFactor, int32_t * _pi32Dst ) {
+		const __m256d mFactor = _mm256_set1_pd( _dFactor );
+		const __m256d mSign = _mm256_set1_pd( -0.0 );
+		alignas( 16 ) int32_t i32Lanes[4];
+		size_t I = 0;
+		for ( ; I + 4 <= _stFrames; I += 4 ) {
+			for ( uint16_t C = 0; C < _uiChannels; ++C ) {
+				__m256d mVal = _mm256_loadu_pd( _ppdSrc[C] + _stSrcIdx + I );
+				mVal = _mm256_mul_pd( _mm256_min_pd( _mm256_max_pd( mVal, _mm256_set1_pd( -1.0 ) ), _mm256_set1_pd( 1.0 ) ), mFactor );
+				__m256d mTrunc = _mm256_round_pd( mVal, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC );
+				__m256d mHalf = _mm256_cmp_pd( _mm256_andnot_pd( mSign, _mm256_sub_pd( mVal, mTrunc ) ), _mm256_set1_pd( 0.5 ), _CMP_GE_OQ );
+				mTrunc = _mm256_add_pd( mTrunc, _mm256_and_pd( mHalf, _mm256_or_pd( _mm256_and_pd( mVal, mSign ), _mm256_set1_pd( 1.0 ) ) ) );
+				_mm_store_si128( reinterpret_cast<__m128i *>(i32Lanes), _mm256_cvttpd_epi32( mTrunc ) );
+				for ( size_t F = 0; F < 4; ++F ) {
+					_pi32Dst[(I+F)*_uiChannels+C] = i32Lanes[F];
+				}
+			}
+		}
+		return I;
+	}
+
+	/**
+	 * Converts per-channel tracks to interleaved 32-bit float using AVX2, 4 frames at a time.  Each double is rounded to the nearest
+	 *	float, as a cast does.
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _pfDst The buffer to which to write the frames.
+	 * \return Returns the number of frames converted.
+	 */
+	static size_t F64ToFloat32_AVX2( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, float * _pfDst ) {
+		alignas( 16 ) float fLanes[4];
+		size_t I = 0;
+		for ( ; I + 4 <= _stFrames; I += 4 ) {
+			if ( _uiChannels == 2 ) {
+				__m128 mL = _mm256_cvtpd_ps( _mm256_loadu_pd( _ppdSrc[0] + _stSrcIdx + I ) );
+				__m128 mR = _mm256_cvtpd_ps( _mm256_loadu_pd( _ppdSrc[1] + _stSrcIdx + I ) );
+				_mm_storeu_ps( _pfDst + I * 2, _mm_unpacklo_ps( mL, mR ) );
+				_mm_storeu_ps( _pfDst + I * 2 + 4, _mm_unpackhi_ps( mL, mR ) );
+				continue;
+			}
+			for ( uint16_t C = 0; C < _uiChannels; ++C ) {
+				_mm_store_ps( fLanes, _mm256_cvtpd_ps( _mm256_loadu_pd( _ppdSrc[C] + _stSrcIdx + I ) ) );
+				for ( size_t F = 0; F < 4; ++F ) {
+					_pfDst[(I+F)*_uiChannels+C] = fLanes[F];
+				}
+			}
+		}
+		return I;
+	}
+
+	/**
+	 * Interleaves per-channel tracks of doubles into 64-bit float frames using AVX2, 4 frames at a time.  Only mono and stereo are
+	 *	handled; mono is copied and stereo is joined with unpacks and permutes.
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _pdDst The buffer to which to write the frames.
+	 * \return Returns the number of frames converted.
+	 */
+	static size_t F64ToFloat64_AVX2( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, double * _pdDst ) {
+		if ( _uiChannels > 2 ) { return 0; }
+		size_t I = 0;
+		for ( ; I + 4 <= _stFrames; I += 4 ) {
+			if ( _uiChannels == 1 ) {
+				_mm256_storeu_pd( _pdDst + I, _mm256_loadu_pd( _ppdSrc[0] + _stSrcIdx + I ) );
+				continue;
+			}
+			// L0 L1 L2 L3 and R0 R1 R2 R3 unpack to L0 R0 L2 R2 and L1 R1 L3 R3, whose halves are the frames in order.
+			__m256d mL = _mm256_loadu_pd( _ppdSrc[0] + _stSrcIdx + I );
+			__m256d mR = _mm256_loadu_pd( _ppdSrc[1] + _stSrcIdx + I );
+			__m256d mLo = _mm256_unpacklo_pd( mL, mR );
+			__m256d mHi = _mm256_unpackhi_pd( mL, mR );
+			_mm256_storeu_pd( _pdDst + I * 2, _mm256_permute2f128_pd( mLo, mHi, 0x20 ) );
+			_mm256_storeu_pd( _pdDst + I * 2 + 4, _mm256_permute2f128_pd( mLo, mHi, 0x31 ) );
+		}
+		return I;
+	}
+#endif	// #ifdef __AVX2__
+
+#ifdef __AVX512VBMI__
+	/**
+	 * Widens packed 24-bit samples to 32 bits using AVX-512 VBMI byte permutes, 16 samples at a time.  Each sample lands in the top 3
+	 *	bytes of its 32-bit value, as in the scalar decoder.  No bytes past the last sample are read.
+	 *
+	 * \param _pui8Src The first sample to widen.
+	 * \param _stSamples The number of samples to widen.
+	 * \param _pi32Dst The buffer to which to write the widened samples.
+	 * \return Returns the number of samples widened.
+	 */
+	static size_t Pcm24ToInt32_VBMI( const uint8_t * _pui8Src, size_t _stSamples, int32_t * _pi32Dst ) {
+		static constexpr PW_PCM24_PERMUTE s_pPermute;
+		const __m512i mWiden = _mm512_loadu_si512( s_pPermute.ui8Widen );
+		size_t I = 0;
+		for ( ; I + 16 <= _stSamples; I += 16 ) {
+			__m512i mBytes = _mm512_maskz_loadu_epi8( 0x0000FFFFFFFFFFFFULL, _pui8Src + I * 3 );
+			_mm512_storeu_si512( _pi32Dst + I, _mm512_maskz_permutexvar_epi8( 0xEEEEEEEEEEEEEEEEULL, mWiden, mBytes ) );
+		}
+		return I;
+	}
+
+	/**
+	 * Packs 32-bit samples to 24 bits using AVX-512 VBMI byte permutes, 16 samples at a time.  The low 3 bytes of each sample are kept.
+	 *	No bytes past the last sample are written.
+	 *
+	 * \param _pi32Src The first sample to pack.
+	 * \param _stSamples The number of samples to pack.
+	 * \param _pui8Dst The buffer to which to write the packed samples.
+	 * \return Returns the number of samples packed.
+	 */
+	static size_t Int32ToPcm24_VBMI( const int32_t * _pi32Src, size_t _stSamples, uint8_t * _pui8Dst ) {
+		static constexpr PW_PCM24_PERMUTE s_pPermute;
+		const __m512i mNarrow = _mm512_loadu_si512( s_pPermute.ui8Narrow );
+		size_t I = 0;
+		for ( ; I + 16 <= _stSamples; I += 16 ) {
+			_mm512_mask_storeu_epi8( _pui8Dst + I * 3, 0x0000FFFFFFFFFFFFULL, _mm512_permutexvar_epi8( mNarrow, _mm512_loadu_si512( _pi32Src + I ) ) );
+		}
+		return I;
+	}
+#endif	// #ifdef __AVX512VBMI__
+
+	/**
+	 * Widens packed 24-bit samples to 32 bits, each sample landing in the top 3 bytes of its 32-bit value.
+	 *
+	 * \param _pui8Src The first sample to widen.
+	 * \param _stSamples The number of samples to widen.
+	 * \param _pi32Dst The buffer to which to write the widened samples.
+	 */
+	static void Pcm24ToInt32( const uint8_t * _pui8Src, size_t _stSamples, int32_t * _pi32Dst ) {
+		size_t I = 0;
+#ifdef __AVX512VBMI__
+		if ( UseTier( CSampleConverter::PW_T_AVX512VBMI ) ) {
+			I = Pcm24ToInt32_VBMI( _pui8Src, _stSamples, _pi32Dst );
+		}
+#endif	// #ifdef __AVX512VBMI__
+#ifdef __AVX2__
+		if ( UseTier( CSampleConverter::PW_T_AVX2 ) ) {
+			I += Pcm24ToInt32_AVX2( _pui8Src + I * 3, _stSamples - I, _pi32Dst + I );
+		}
+#endif	// #ifdef __AVX2__
+#ifdef __SSE4_1__
+		if ( UseTier( CSampleConverter::PW_T_SSE4 ) ) {
+			I += Pcm24ToInt32_SSE4( _pui8Src + I * 3, _stSamples - I, _pi32Dst + I );
+		}
+#endif	// #ifdef __SSE4_1__
+
+		for ( const uint8_t * pui8Src = _pui8Src + I * 3; I < _stSamples; ++I, pui8Src += 3 ) {
+			// Assemble the sample in the top 3 bytes so that the sign comes along for free.  No bytes past the sample are read.
+			_pi32Dst[I] = static_cast<int32_t>((uint32_t( pui8Src[0] ) << 8) | (uint32_t( pui8Src[1] ) << 16) | (uint32_t( pui8Src[2] ) << 24));
+		}
+	}
+
+	/**
+	 * Packs 32-bit samples to 24 bits, keeping the low 3 bytes of each.
+	 *
+	 * \param _pi32Src The first sample to pack.
+	 * \param _stSamples The number of samples to pack.
+	 * \param _pui8Dst The buffer to which to write the packed samples.
+	 */
+	static void Int32ToPcm24( const int32_t * _pi32Src, size_t _stSamples, uint8_t * _pui8Dst ) {
+		size_t I = 0;
+#ifdef __AVX512VBMI__
+		if ( UseTier( CSampleConverter::PW_T_AVX512VBMI ) ) {
+			I = Int32ToPcm24_VBMI( _pi32Src, _stSamples, _pui8Dst );
+		}
+#endif	// #ifdef __AVX512VBMI__
+#ifdef __AVX2__
+		if ( UseTier( CSampleConverter::PW_T_AVX2 ) ) {
+			I += Int32ToPcm24_AVX2( _pi32Src + I, _stSamples - I, _pui8Dst + I * 3 );
+		}
+#endif	// #ifdef __AVX2__
+#ifdef __SSE4_1__
+		if ( UseTier( CSampleConverter::PW_T_SSE4 ) ) {
+			I += Int32ToPcm24_SSE4( _pi32Src + I, _stSamples - I, _pui8Dst + I * 3 );
+		}
+#endif	// #ifdef __SSE4_1__
+
+		for ( uint8_t * pui8Dst = _pui8Dst + I * 3; I < _stSamples; ++I ) {
+			(*pui8Dst++) = static_cast<uint8_t>(_pi32Src[I]);
+			(*pui8Dst++) = static_cast<uint8_t>(_pi32Src[I] >> 8);
+			(*pui8Dst++) = static_cast<uint8_t>(_pi32Src[I] >> 16);
+		}
+	}
+
+	/**
+	 * Clamps, scales, and rounds per-channel tracks to interleaved 32-bit integers.  Samples are clamped to [-1,1] and rounded half
+	 *	away from zero.
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _dFactor The scale applied after clamping to [-1,1].
+	 * \param _pi32Dst The buffer to which to write the frames.
+	 */
+	static void F64ToInt32( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, double _dFactor, int32_t * _pi32Dst ) {
+		size_t I = 0;
+#ifdef __AVX512F__
+		if ( UseTier( CSampleConverter::PW_T_AVX512 ) ) {
+			I = F64ToPcm_AVX512( _ppdSrc, _stSrcIdx, _stFrames, _uiChannels, _dFactor, _pi32Dst );
+		}
+#endif	// #ifdef __AVX512F__
+#ifdef __AVX2__
+		if ( UseTier( CSampleConverter::PW_T_AVX2 ) ) {
+			I += F64ToInt32_AVX2( _ppdSrc, _stSrcIdx + I, _stFrames - I, _uiChannels, _dFactor, _pi32Dst + I * _uiChannels );
+		}
+#endif	// #ifdef __AVX2__
+#ifdef __SSE4_1__
+		if ( UseTier( CSampleConverter::PW_T_SSE4 ) ) {
+			I += F64ToInt32_SSE4( _ppdSrc, _stSrcIdx + I, _stFrames - I, _uiChannels, _dFactor, _pi32Dst + I * _uiChannels );
+		}
+#endif	// #ifdef __SSE4_1__
+
+		for ( int32_t * pi32Dst = _pi32Dst + I * _uiChannels; I < _stFrames; ++I ) {
+			for ( uint16_t C = 0; C < _uiChannels; ++C ) {
+				(*pi32Dst++) = static_cast<int32_t>(std::round( Clamp( _ppdSrc[C][_stSrcIdx+I], -1.0, 1.0 ) * _dFactor ));
+			}
+		}
+	}
+
+#ifdef __SSE4_1__
+	/**
+	 * Widens 8-bit PCM samples to 32 bits using SSE 4.1, 4 samples at a time.  Each sample is made signed and lands in the top byte of
+	 *	its 32-bit value.
+	 *
+	 * \param _pui8Src The first sample to widen.
+	 * \param _stSamples The number of samples to widen.
+	 * \param _pi32Dst The buffer to which to write the widened samples.
+	 * \return Returns the number of samples widened.
+	 */
+	static size_t Pcm8ToInt32_SSE4( const uint8_t * _pui8Src, size_t _stSamples, int32_t * _pi32Dst ) {
+		const __m128i mSign = _mm_set1_epi32( INT32_MIN );
+		size_t I = 0;
+		for ( ; I + 4 <= _stSamples; I += 4 ) {
+			int32_t i32Bytes;
+			std::memcpy( &i32Bytes, _pui8Src + I, sizeof( i32Bytes ) );
+			// (V << 24) ^ 0x80000000 is (V - 128) << 24.
+			__m128i mSamples = _mm_slli_epi32( _mm_cvtepu8_epi32( _mm_cvtsi32_si128( i32Bytes ) ), 24 );
+			_mm_storeu_si128( reinterpret_cast<__m128i *>(_pi32Dst + I), _mm_xor_si128( mSamples, mSign ) );
+		}
+		return I;
+	}
+
+	/**
+	 * Widens 16-bit PCM samples to 32 bits using SSE 4.1, 8 samples at a time.  Each sample lands in the top 2 bytes of its 32-bit value.
+	 *
+	 * \param _pui8Src The first sample to widen.
+	 * \param _stSamples The number of samples to widen.
+	 * \param _pi32Dst The buffer to which to write the widened samples.
+	 * \return Returns the number of samples widened.
+	 */
+	static size_t Pcm16ToInt32_SSE4( const uint8_t * _pui8Src, size_t _stSamples, int32_t * _pi32Dst ) {
+		size_t I = 0;
+		for ( ; I + 8 <= _stSamples; I += 8 ) {
+			__m128i mSamples = _mm_loadu_si128( reinterpret_cast<const __m128i *>(_pui8Src + I * 2) );
+			_mm_storeu_si128( reinterpret_cast<__m128i *>(_pi32Dst + I), _mm_unpacklo_epi16( _mm_setzero_si128(), mSamples ) );
+			_mm_storeu_si128( reinterpret_cast<__m128i *>(_pi32Dst + I + 4), _mm_unpackhi_epi16( _mm_setzero_si128(), mSamples ) );
+		}
+		return I;
+	}
+
+	/**
+	 * Shifts 32-bit samples right in place using SSE 4.1, 4 samples at a time, either truncating or rounding as NarrowInt32() does.
+	 *
+	 * \param _pi32Samples The samples to shift.
+	 * \param _stSamples The number of samples to shift.
+	 * \param _ui32Shift The number of bits by which to shift.  1 to 24.
+	 * \param _bRound If true, samples are rounded to the nearest result; otherwise they are truncated.
+	 * \return Returns the number of samples shifted.
+	 */
+	static size_t NarrowInt32_SSE4( int32_t * _pi32Samples, size_t _stSamples, uint32_t _ui32Shift, bool _bRound ) {
+		const __m128i mShift = _mm_cvtsi32_si128( int32_t( _ui32Shift ) );
+		const __m128i mLow = _mm_set1_epi32( int32_t( (uint32_t( 1 ) << _ui32Shift) - 1 ) );
+		const __m128i mHalf = _mm_set1_epi32( int32_t( (uint32_t( 1 ) << (_ui32Shift - 1)) - 1 ) );
+		const __m128i mMax = _mm_set1_epi32( int32_t( (uint32_t( 1 ) << (31 - _ui32Shift)) - 1 ) );
+		size_t I = 0;
+		for ( ; I + 4 <= _stSamples; I += 4 ) {
+			__m128i mSamples = _mm_loadu_si128( reinterpret_cast<const __m128i *>(_pi32Samples + I) );
+			__m128i mResult = _mm_sra_epi32( mSamples, mShift );
+			if ( _bRound ) {
+				// Round up when the dropped bits exceed half, minus 1 for non-negative samples.
+				__m128i mUp = _mm_cmpgt_epi32( _mm_and_si128( mSamples, mLow ), _mm_sub_epi32( mHalf, _mm_srai_epi32( mSamples, 31 ) ) );
+				mResult = _mm_min_epi32( _mm_sub_epi32( mResult, mUp ), mMax );
+			}
+			_mm_storeu_si128( reinterpret_cast<__m128i *>(_pi32Samples + I), mResult );
+		}
+		return I;
+	}
+
+	/**
+	 * Packs 32-bit samples already in [-128,127] to unsigned 8-bit PCM using SSE 4.1, 16 samples at a time.
+	 *
+	 * \param _pi32Src The first sample to pack.
+	 * \param _stSamples The number of samples to pack.
+	 * \param _pui8Dst The buffer to which to write the packed samples.
+	 * \return Returns the number of samples packed.
+	 */
+	static size_t Int32ToPcm8_SSE4( const int32_t * _pi32Src, size_t _stSamples, uint8_t * _pui8Dst ) {
+		const __m128i mSign = _mm_set1_epi8( -128 );
+		size_t I = 0;
+		for ( ; I + 16 <= _stSamples; I += 16 ) {
+			const __m128i * pmSrc = reinterpret_cast<const __m128i *>(_pi32Src + I);
+			__m128i mLo = _mm_packs_epi32( _mm_loadu_si128( pmSrc ), _mm_loadu_si128( pmSrc + 1 ) );
+			__m128i mHi = _mm_packs_epi32( _mm_loadu_si128( pmSrc + 2 ), _mm_loadu_si128( pmSrc + 3 ) );
+			_mm_storeu_si128( reinterpret_cast<__m128i *>(_pui8Dst + I), _mm_xor_si128( _mm_packs_epi16( mLo, mHi ), mSign ) );
+		}
+		return I;
+	}
+
+	/**
+	 * Packs 32-bit samples already in the 16-bit range to 16-bit PCM using SSE 4.1, 8 samples at a time.
+	 *
+	 * \param _pi32Src The first sample to pack.
+	 * \param _stSamples The number of samples to pack.
+	 * \param _pui8Dst The buffer to which to write the packed samples.
+	 * \return Returns the number of samples packed.
+	 */
+	static size_t Int32ToPcm16_SSE4( const int32_t * _pi32Src, size_t _stSamples, uint8_t * _pui8Dst ) {
+		size_t I = 0;
+		for ( ; I + 8 <= _stSamples; I += 8 ) {
+			const __m128i * pmSrc = reinterpret_cast<const __m128i *>(_pi32Src + I);
+			_mm_storeu_si128( reinterpret_cast<__m128i *>(_pui8Dst + I * 2), _mm_packs_epi32( _mm_loadu_si128( pmSrc ), _mm_loadu_si128( pmSrc + 1 ) ) );
+		}
+		return I;
+	}
+#endif	// #ifdef __SSE4_1__
+
+#ifdef __AVX2__
+	/**
+	 * Widens 8-bit PCM samples to 32 bits using AVX2, 8 samples at a time.  Each sample is made signed and lands in the top byte of its
+	 *	32-bit value.
+	 *
+	 * \param _pui8Src The first sample to widen.
+	 * \param _stSamples The number of samples to widen.
+	 * \param _pi32Dst The buffer to which to write the widened samples.
+	 * \return Returns the number of samples widened.
+	 */
+	static size_t Pcm8ToInt32_AVX2( const uint8_t * _pui8Src, size_t _stSamples, int32_t * _pi32Dst ) {
+		const __m256i mSign = _mm256_set1_epi32( INT32_MIN );
+		size_t I = 0;
+		for ( ; I + 8 <= _stSamples; I += 8 ) {
+			__m256i mSamples = _mm256_slli_epi32( _mm256_cvtepu8_epi32( _mm_loadl_epi64( reinterpret_cast<const __m128i *>(_pui8Src + I) ) ), 24 );
+			_mm256_storeu_si256( reinterpret_cast<__m256i *>(_pi32Dst + I), _mm256_xor_si256( mSamples, mSign ) );
+		}
+		return I;
+	}
+
+	/**
+	 * Widens 16-bit PCM samples to 32 bits using AVX2, 8 samples at a time.  Each sample lands in the top 2 bytes of its 32-bit value.
+	 *
+	 * \param _pui8Src The first sample to widen.
+	 * \param _stSamples The number of samples to widen.
+	 * \param _pi32Dst The buffer to which to write the widened samples.
+	 * \return Returns the number of samples widened.
+	 */
+	static size_t Pcm16ToInt32_AVX2( const uint8_t * _pui8Src, size_t _stSamples, int32_t * _pi32Dst ) {
+		size_t I = 0;
+		for ( ; I + 8 <= _stSamples; I += 8 ) {
+			__m256i mSamples = _mm256_cvtepi16_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i *>(_pui8Src + I * 2) ) );
+			_mm256_storeu_si256( reinterpret_cast<__m256i *>(_pi32Dst + I), _mm256_slli_epi32( mSamples, 16 ) );
+		}
+		return I;
+	}
+
+	/**
+	 * Shifts 32-bit samples right in place using AVX2, 8 samples at a time, either truncating or rounding as NarrowInt32() does.
+	 *
+	 * \param _pi32Samples The samples to shift.
+	 * \param _stSamples The number of samples to shift.
+	 * \param _ui32Shift The number of bits by which to shift.  1 to 24.
+	 * \param _bRound If true, samples are rounded to the nearest result; otherwise they are truncated.
+	 * \return Returns the number of samples shifted.
+	 */
+	static size_t NarrowInt32_AVX2( int32_t * _pi32Samples, size_t _stSamples, uint32_t _ui32Shift, bool _bRound ) {
+		const __m128i mShift = _mm_cvtsi32_si128( int32_t( _ui32Shift ) );
+		const __m256i mLow = _mm256_set1_epi32( int32_t( (uint32_t( 1 ) << _ui32Shift) - 1 ) );
+		const __m256i mHalf = _mm256_set1_epi32( int32_t( (uint32_t( 1 ) << (_ui32Shift - 1)) - 1 ) );
+		const __m256i mMax = _mm256_set1_epi32( int32_t( (uint32_t( 1 ) << (31 - _ui32Shift)) - 1 ) );
+		size_t I = 0;
+		for ( ; I + 8 <= _stSamples; I += 8 ) {
+			__m256i mSamples = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(_pi32Samples + I) );
+			__m256i mResult = _mm256_sra_epi32( mSamples, mShift );
+			if ( _bRound ) {
+				__m256i mUp = _mm256_cmpgt_epi32( _mm256_and_si256( mSamples, mLow ), _mm256_sub_epi32( mHalf, _mm256_srai_epi32( mSamples, 31 ) ) );
+				mResult = _mm256_min_epi32( _mm256_sub_epi32( mResult, mUp ), mMax );
+			}
+			_mm256_storeu_si256( reinterpret_cast<__m256i *>(_pi32Samples + I), mResult );
+		}
+		return I;
+	}
+
+	/**
+	 * Packs 32-bit samples already in [-128,127] to unsigned 8-bit PCM using AVX2, 32 samples at a time.
+	 *
+	 * \param _pi32Src The first sample to pack.
+	 * \param _stSamples The number of samples to pack.
+	 * \param _pui8Dst The buffer to which to write the packed samples.
+	 * \return Returns the number of samples packed.
+	 */
+	static size_t Int32ToPcm8_AVX2( const int32_t * _pi32Src, size_t _stSamples, uint8_t * _pui8Dst ) {
+		const __m256i mSign = _mm256_set1_epi8( -128 );
+		// The packs work within 128-bit lanes, leaving groups of 4 samples in the order 0, 2, 4, 6, 1, 3, 5, 7.
+		const __m256i mOrder = _mm256_setr_epi32( 0, 4, 1, 5, 2, 6, 3, 7 );
+		size_t I = 0;
+		for ( ; I + 32 <= _stSamples; I += 32 ) {
+			const __m256i * pmSrc = reinterpret_cast<const __m256i *>(_pi32Src + I);
+			__m256i mLo = _mm256_packs_epi32( _mm256_loadu_si256( pmSrc ), _mm256_loadu_si256( pmSrc + 1 ) );
+			__m256i mHi = _mm256_packs_epi32( _mm256_loadu_si256( pmSrc + 2 ), _mm256_loadu_si256( pmSrc + 3 ) );
+			__m256i mBytes = _mm256_permutevar8x32_epi32( _mm256_packs_epi16( mLo, mHi ), mOrder );
+			_mm256_storeu_si256( reinterpret_cast<__m256i *>(_pui8Dst + I), _mm256_xor_si256( mBytes, mSign ) );
+		}
+		return I;
+	}
+
+	/**
+	 * Packs 32-bit samples already in the 16-bit range to 16-bit PCM using AVX2, 16 samples at a time.
+	 *
+	 * \param _pi32Src The first sample to pack.
+	 * \param _stSamples The number of samples to pack.
+	 * \param _pui8Dst The buffer to which to write the packed samples.
+	 * \return Returns the number of samples packed.
+	 */
+	static size_t Int32ToPcm16_AVX2( const int32_t * _pi32Src, size_t _stSamples, uint8_t * _pui8Dst ) {
+		size_t I = 0;
+		for ( ; I + 16 <= _stSamples; I += 16 ) {
+			const __m256i * pmSrc = reinterpret_cast<const __m256i *>(_pi32Src + I);
+			__m256i mWords = _mm256_packs_epi32( _mm256_loadu_si256( pmSrc ), _mm256_loadu_si256( pmSrc + 1 ) );
+			_mm256_storeu_si256( reinterpret_cast<__m256i *>(_pui8Dst + I * 2), _mm256_permute4x64_epi64( mWords, 0xD8 ) );
+		}
+		return I;
+	}
+#endif	// #ifdef __AVX2__
+
+#ifdef __AVX512F__
+	/**
+	 * Shifts 32-bit samples right in place using AVX-512, 16 samples at a time, either truncating or rounding as NarrowInt32() does.
+	 *
+	 * \param _pi32Samples The samples to shift.
+	 * \param _stSamples The number of samples to shift.
+	 * \param _ui32Shift The number of bits by which to shift.  1 to 24.
+	 * \param _bRound If true, samples are rounded to the nearest result; otherwise they are truncated.
+	 * \return Returns the number of samples shifted.
+	 */
+	static size_t NarrowInt32_AVX512( int32_t * _pi32Samples, size_t _stSamples, uint32_t _ui32Shift, bool _bRound ) {
+		const __m128i mShift = _mm_cvtsi32_si128( int32_t( _ui32Shift ) );
+		const __m512i mLow = _mm512_set1_epi32( int32_t( (uint32_t( 1 ) << _ui32Shift) - 1 ) );
+		const __m512i mHalf = _mm512_set1_epi32( int32_t( (uint32_t( 1 ) << (_ui32Shift - 1)) - 1 ) );
+		const __m512i mMax = _mm512_set1_epi32( int32_t( (uint32_t( 1 ) << (31 - _ui32Shift)) - 1 ) );
+		size_t I = 0;
+		for ( ; I + 16 <= _stSamples; I += 16 ) {
+			__m512i mSamples = _mm512_loadu_si512( _pi32Samples + I );
+			__m512i mResult = _mm512_sra_epi32( mSamples, mShift );
+			if ( _bRound ) {
+				__mmask16 mUp = _mm512_cmpgt_epi32_mask( _mm512_and_si512( mSamples, mLow ), _mm512_sub_epi32( mHalf, _mm512_srai_epi32( mSamples, 31 ) ) );
+				mResult = _mm512_min_epi32( _mm512_mask_add_epi32( mResult, mUp, mResult, _mm512_set1_epi32( 1 ) ), mMax );
+			}
+			_mm512_storeu_si512( _pi32Samples + I, mResult );
+		}
+		return I;
+	}
+#endif	// #ifdef __AVX512F__
+
+	/**
+	 * Widens 8-bit PCM samples to 32 bits, each sample made signed and landing in the top byte of its 32-bit value.
+	 *
+	 * \param _pui8Src The first sample to widen.
+	 * \param _stSamples The number of samples to widen.
+	 * \param _pi32Dst The buffer to which to write the widened samples.
+	 */
+	static void Pcm8ToInt32( const uint8_t * _pui8Src, size_t _stSamples, int32_t * _pi32Dst ) {
+		size_t I = 0;
+#ifdef __AVX2__
+		if ( UseTier( CSampleConverter::PW_T_AVX2 ) ) {
+			I = Pcm8ToInt32_AVX2( _pui8Src, _stSamples, _pi32Dst );
+		}
+#endif	// #ifdef __AVX2__
+#ifdef __SSE4_1__
+		if ( UseTier( CSampleConverter::PW_T_SSE4 ) ) {
+			I += Pcm8ToInt32_SSE4( _pui8Src + I, _stSamples - I, _pi32Dst + I );
+		}
+#endif	// #ifdef __SSE4_1__
+
+		for ( ; I < _stSamples; ++I ) {
+			_pi32Dst[I] = static_cast<int32_t>((uint32_t( _pui8Src[I] ) << 24) ^ 0x80000000U);
+		}
+	}
+
+	/**
+	 * Widens 16-bit PCM samples to 32 bits, each sample landing in the top 2 bytes of its 32-bit value.
+	 *
+	 * \param _pui8Src The first sample to widen.
+	 * \param _stSamples The number of samples to widen.
+	 * \param _pi32Dst The buffer to which to write the widened samples.
+	 */
+	static void Pcm16ToInt32( const uint8_t * _pui8Src, size_t _stSamples, int32_t * _pi32Dst ) {
+		size_t I = 0;
+#ifdef __AVX2__
+		if ( UseTier( CSampleConverter::PW_T_AVX2 ) ) {
+			I = Pcm16ToInt32_AVX2( _pui8Src, _stSamples, _pi32Dst );
+		}
+#endif	// #ifdef __AVX2__
+#ifdef __SSE4_1__
+		if ( UseTier( CSampleConverter::PW_T_SSE4 ) ) {
+			I += Pcm16ToInt32_SSE4( _pui8Src + I * 2, _stSamples - I, _pi32Dst + I );
+		}
+#endif	// #ifdef __SSE4_1__
+
+		for ( const uint8_t * pui8Src = _pui8Src + I * 2; I < _stSamples; ++I, pui8Src += 2 ) {
+			_pi32Dst[I] = static_cast<int32_t>((uint32_t( pui8Src[0] ) << 16) | (uint32_t( pui8Src[1] ) << 24));
+		}
+	}
+
+	/**
+	 * Shifts 32-bit samples right in place, either truncating or rounding to the nearest result with halves away from zero.  Rounded
+	 *	results that would pass the most positive result are clamped to it.
+	 *
+	 * \param _pi32Samples The samples to shift.
+	 * \param _stSamples The number of samples to shift.
+	 * \param _ui32Shift The number of bits by which to shift.  1 to 24.
+	 * \param _bRound If true, samples are rounded to the nearest result; otherwise they are truncated.
+	 */
+	static void NarrowInt32( int32_t * _pi32Samples, size_t _stSamples, uint32_t _ui32Shift, bool _bRound ) {
+		size_t I = 0;
+#ifdef __AVX512F__
+		if ( UseTier( CSampleConverter::PW_T_AVX512 ) ) {
+			I = NarrowInt32_AVX512( _pi32Samples, _stSamples, _ui32Shift, _bRound );
+		}
+#endif	// #ifdef __AVX512F__
+#ifdef __AVX2__
+		if ( UseTier( CSampleConverter::PW_T_AVX2 ) ) {
+			I += NarrowInt32_AVX2( _pi32Samples + I, _stSamples - I, _ui32Shift, _bRound );
+		}
+#endif	// #ifdef __AVX2__
+#ifdef __SSE4_1__
+		if ( UseTier( CSampleConverter::PW_T_SSE4 ) ) {
+			I += NarrowInt32_SSE4( _pi32Samples + I, _stSamples - I, _ui32Shift, _bRound );
+		}
+#endif	// #ifdef __SSE4_1__
+
+		const int64_t i64Half = int64_t( 1 ) << (_ui32Shift - 1);
+		const int64_t i64Max = (int64_t( 1 ) << (31 - _ui32Shift)) - 1;
+		for ( ; I < _stSamples; ++I ) {
+			if ( _bRound ) {
+				int64_t i64Sample = _pi32Samples[I];
+				i64Sample = i64Sample < 0 ? -((i64Half - i64Sample) >> _ui32Shift) : (i64Sample + i64Half) >> _ui32Shift;
+				_pi32Samples[I] = static_cast<int32_t>(Min( i64Sample, i64Max ));
+			}
+			else {
+				_pi32Samples[I] >>= _ui32Shift;
+			}
+		}
+	}
+
+	/**
+	 * Shifts 32-bit samples right in place with triangular (TPDF) dither of +-1 step of the result, then rounds as NarrowInt32() does
+	 *	and clamps to the range of the result.
+	 *
+	 * \param _pi32Samples The samples to shift.
+	 * \param _stSamples The number of samples to shift.
+	 * \param _ui32Shift The number of bits by which to shift.  1 to 24.
+	 * \param _ui32State The xorshift32 state of the noise generator.  Must not be 0.  Updated on return.
+	 */
+	static void DitherInt32( int32_t * _pi32Samples, size_t _stSamples, uint32_t _ui32Shift, uint32_t &_ui32State ) {
+		const int64_t i64Half = int64_t( 1 ) << (_ui32Shift - 1);
+		const int64_t i64Max = (int64_t( 1 ) << (31 - _ui32Shift)) - 1;
+		auto aNext = [&]() {
+			_ui32State ^= _ui32State << 13;
+			_ui32State ^= _ui32State >> 17;
+			_ui32State ^= _ui32State << 5;
+			return int64_t( _ui32State >> (32 - _ui32Shift) );
+		};
+		for ( size_t I = 0; I < _stSamples; ++I ) {
+			int64_t i64Sample = int64_t( _pi32Samples[I] ) + aNext() - aNext();
+			i64Sample = i64Sample < 0 ? -((i64Half - i64Sample) >> _ui32Shift) : (i64Sample + i64Half) >> _ui32Shift;
+			_pi32Samples[I] = static_cast<int32_t>(Clamp( i64Sample, -i64Max - 1, i64Max ));
+		}
+	}
+
+	/**
+	 * Packs 32-bit samples already in [-128,127] to unsigned 8-bit PCM.
+	 *
+	 * \param _pi32Src The first sample to pack.
+	 * \param _stSamples The number of samples to pack.
+	 * \param _pui8Dst The buffer to which to write the packed samples.
+	 */
+	static void Int32ToPcm8( const int32_t * _pi32Src, size_t _stSamples, uint8_t * _pui8Dst ) {
+		size_t I = 0;
+#ifdef __AVX2__
+		if ( UseTier( CSampleConverter::PW_T_AVX2 ) ) {
+			I = Int32ToPcm8_AVX2( _pi32Src, _stSamples, _pui8Dst );
+		}
+#endif	// #ifdef __AVX2__
+#ifdef __SSE4_1__
+		if ( UseTier( CSampleConverter::PW_T_SSE4 ) ) {
+			I += Int32ToPcm8_SSE4( _pi32Src + I, _stSamples - I, _pui8Dst + I );
+		}
+#endif	// #ifdef __SSE4_1__
+
+		for ( ; I < _stSamples; ++I ) {
+			_pui8Dst[I] = static_cast<uint8_t>(_pi32Src[I] + 128);
+		}
+	}
+
+	/**
+	 * Packs 32-bit samples already in the 16-bit range to 16-bit PCM.
+	 *
+	 * \param _pi32Src The first sample to pack.
+	 * \param _stSamples The number of samples to pack.
+	 * \param _pui8Dst The buffer to which to write the packed samples.
+	 */
+	static void Int32ToPcm16( const int32_t * _pi32Src, size_t _stSamples, uint8_t * _pui8Dst ) {
+		size_t I = 0;
+#ifdef __AVX2__
+		if ( UseTier( CSampleConverter::PW_T_AVX2 ) ) {
+			I = Int32ToPcm16_AVX2( _pi32Src, _stSamples, _pui8Dst );
+		}
+#endif	// #ifdef __AVX2__
+#ifdef __SSE4_1__
+		if ( UseTier( CSampleConverter::PW_T_SSE4 ) ) {
+			I += Int32ToPcm16_SSE4( _pi32Src + I, _stSamples - I, _pui8Dst + I * 2 );
+		}
+#endif	// #ifdef __SSE4_1__
+
+		for ( uint8_t * pui8Dst = _pui8Dst + I * 2; I < _stSamples; ++I ) {
+			(*pui8Dst++) = static_cast<uint8_t>(_pi32Src[I]);
+			(*pui8Dst++) = static_cast<uint8_t>(_pi32Src[I] >> 8);
+		}
+	}
+
+	/**
+	 * Converts interleaved PCM frames to double by dividing each sample, as read by LoadPcm<_uiBits>(), by PcmFactor<_uiScale>().  A
+	 *	non-zero _uiFixed fixes the channel count, and with it the frame stride and SSE 4.1 kernel, at compile time.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.  Ignored if _uiFixed is not 0.
+	 * \param _ppdDst One track per channel.  Frame I of channel C is written to _ppdDst[C][_stDstIdx+I].
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 */
+	template <unsigned _uiBits, unsigned _uiScale, uint16_t _uiFixed>
+	static void PcmFramesToF64( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx ) {
+		const uint16_t uiChannels = _uiFixed ? _uiFixed : _uiChannels;
+		const size_t stFrameSize = (_uiBits / 8) * size_t( uiChannels );
+		constexpr double dFactor = PcmFactor<_uiScale>();
+		size_t I = 0;
+#ifdef __AVX512F__
+		if ( UseTier( CSampleConverter::PW_T_AVX512 ) ) {
+			I = PcmToF64_AVX512<_uiBits>( _pui8Src, _stFrames, uiChannels, _ppdDst, _stDstIdx, dFactor );
+		}
+#endif	// #ifdef __AVX512F__
+#ifdef __AVX2__
+		if ( UseTier( CSampleConverter::PW_T_AVX2 ) ) {
+			I += PcmToF64_AVX2<_uiBits>( _pui8Src + I * stFrameSize, _stFrames - I, uiChannels, _ppdDst, _stDstIdx + I, dFactor );
+		}
+#endif	// #ifdef __AVX2__
+#ifdef __SSE4_1__
+		if ( UseTier( CSampleConverter::PW_T_SSE4 ) ) {
+			I += DispatchPairs_SSE4<_uiFixed>( uiChannels, [&]( auto _icChannels ) {
+				constexpr uint16_t uiPairs = decltype( _icChannels )::value;
+				if constexpr ( _uiBits == 8 ) { return Pcm8ToF64_SSE4<uiPairs>( _pui8Src + I * stFrameSize, _stFrames - I, _ppdDst, _stDstIdx + I ); }
+				else if constexpr ( _uiBits == 16 ) { return Pcm16ToF64_SSE4<uiPairs>( _pui8Src + I * stFrameSize, _stFrames - I, _ppdDst, _stDstIdx + I ); }
+				else { return Int32ToF64_SSE4<uiPairs>( _pui8Src + I * stFrameSize, _stFrames - I, _ppdDst, _stDstIdx + I, dFactor ); }
+			}, [&]() {
+				const __m128d mFactor = _mm_set1_pd( dFactor );
+				return StridedToF64_SSE4( _pui8Src + I * stFrameSize, _uiBits / 8, _stFrames - I, uiChannels, _ppdDst, _stDstIdx + I,
+					LoadPcm<_uiBits>, [&]( __m128i _mInts ) { return _mm_div_pd( _mm_cvtepi32_pd( _mInts ), mFactor ); } );
+			} );
+		}
+#endif	// #ifdef __SSE4_1__
+
+		const uint8_t * pui8Src = _pui8Src + I * stFrameSize;
+		for ( ; I < _stFrames; ++I ) {
+			for ( uint16_t C = 0; C < uiChannels; ++C, pui8Src += _uiBits / 8 ) {
+				_ppdDst[C][_stDstIdx+I] = LoadPcm<_uiBits>( pui8Src ) / dFactor;
+			}
+		}
+	}
+
+	/**
+	 * Converts interleaved PCM frames to float by dividing each sample, as read by LoadPcm<_uiBits>(), by PcmFactor<_uiScale>().  The
+	 *	result is the correctly rounded quotient on every tier.  A non-zero _uiFixed fixes the channel count at compile time.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.  Ignored if _uiFixed is not 0.
+	 * \param _ppfDst One track per channel.  Frame I of channel C is written to _ppfDst[C][_stDstIdx+I].
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 */
+	template <unsigned _uiBits, unsigned _uiScale, uint16_t _uiFixed>
+	static void PcmFramesToF32( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, float * const * _ppfDst, size_t _stDstIdx ) {
+		const uint16_t uiChannels = _uiFixed ? _uiFixed : _uiChannels;
+		const size_t stFrameSize = (_uiBits / 8) * size_t( uiChannels );
+		constexpr float fFactor = static_cast<float>(PcmFactor<_uiScale>());
+		size_t I = 0;
+#ifdef __AVX512F__
+		if ( UseTier( CSampleConverter::PW_T_AVX512 ) ) {
+			I = PcmToF32_AVX512<_uiBits>( _pui8Src, _stFrames, uiChannels, _ppfDst, _stDstIdx, fFactor );
+		}
+#endif	// #ifdef __AVX512F__
+#ifdef __AVX2__
+		if ( UseTier( CSampleConverter::PW_T_AVX2 ) ) {
+			I += PcmToF32_AVX2<_uiBits>( _pui8Src + I * stFrameSize, _stFrames - I, uiChannels, _ppfDst, _stDstIdx + I, fFactor );
+		}
+#endif	// #ifdef __AVX2__
+
+		const uint8_t * pui8Src = _pui8Src + I * stFrameSize;
+		for ( ; I < _stFrames; ++I ) {
+			for ( uint16_t C = 0; C < uiChannels; ++C, pui8Src += _uiBits / 8 ) {
+				_ppfDst[C][_stDstIdx+I] = static_cast<float>(LoadPcm<_uiBits>( pui8Src )) / fFactor;
+			}
+		}
+	}
+
+	/**
+	 * Converts interleaved 24-bit PCM frames to double or float.  A block at a time is widened on the stack with byte shuffles and
+	 *	decoded as 32-bit samples, so that 24-bit data goes through the same SIMD paths as 32-bit data.  The widened samples have at
+	 *	most 24 significant bits and the factor has 23, so both also convert to float exactly.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.  Ignored if _uiFixed is not 0.
+	 * \param _pptDst One track per channel, of doubles or floats.  Frame I of channel C is written to _pptDst[C][_stDstIdx+I].
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 */
+	template <typename _tSample, uint16_t _uiFixed>
+	static void Pcm24FramesTo( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, _tSample * const * _pptDst, size_t _stDstIdx ) {
+		const uint16_t uiChannels = _uiFixed ? _uiFixed : _uiChannels;
+		constexpr size_t stBlockSamples = CSampleConverter::PW_D_BLOCK_SAMPLES;
+		alignas( 64 ) int32_t i32Block[stBlockSamples];
+		const size_t stBlockFrames = Max<size_t>( stBlockSamples / uiChannels, 1 );
+		for ( size_t I = 0; I < _stFrames; I += stBlockFrames ) {
+			size_t stFrames = Min( stBlockFrames, _stFrames - I );
+			if ( stFrames * uiChannels > stBlockSamples ) {
+				// More channels than fit in the block.
+				const uint8_t * pui8Src = _pui8Src + I * uiChannels * 3;
+				for ( size_t F = 0; F < stFrames; ++F ) {
+					for ( uint16_t C = 0; C < uiChannels; ++C, pui8Src += 3 ) {
+						_pptDst[C][_stDstIdx+I+F] = static_cast<_tSample>(LoadPcm<24>( pui8Src )) / static_cast<_tSample>(PcmFactor<24>());
+					}
+				}
+				continue;
+			}
+			Pcm24ToInt32( _pui8Src + I * uiChannels * 3, stFrames * uiChannels, i32Block );
+			if constexpr ( std::is_same_v<_tSample, float> ) {
+				PcmFramesToF32<32, 24, _uiFixed>( reinterpret_cast<const uint8_t *>(i32Block), stFrames, uiChannels, _pptDst, _stDstIdx + I );
+			}
+			else {
+				PcmFramesToF64<32, 24, _uiFixed>( reinterpret_cast<const uint8_t *>(i32Block), stFrames, uiChannels, _pptDst, _stDstIdx + I );
+			}
+		}
+	}
+
+	/**
+	 * Converts interleaved 32-bit float frames to double.  A non-zero _uiFixed fixes the channel count at compile time.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.  Ignored if _uiFixed is not 0.
+	 * \param _ppdDst One track per channel.  Frame I of channel C is written to _ppdDst[C][_stDstIdx+I].
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 */
+	template <uint16_t _uiFixed>
+	static void F32FramesToF64( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx ) {
+		const uint16_t uiChannels = _uiFixed ? _uiFixed : _uiChannels;
+		const size_t stFrameSize = sizeof( float ) * uiChannels;
+		size_t I = 0;
+#ifdef __AVX512F__
+		if ( UseTier( CSampleConverter::PW_T_AVX512 ) ) {
+			I = F32ToF64_AVX512( _pui8Src, _stFrames, uiChannels, _ppdDst, _stDstIdx );
+		}
+#endif	// #ifdef __AVX512F__
+#ifdef __AVX2__
+		if ( UseTier( CSampleConverter::PW_T_AVX2 ) ) {
+			I += F32ToF64_AVX2( _pui8Src + I * stFrameSize, _stFrames - I, uiChannels, _ppdDst, _stDstIdx + I );
+		}
+#endif	// #ifdef __AVX2__
+#ifdef __SSE4_1__
+		if ( UseTier( CSampleConverter::PW_T_SSE4 ) ) {
+			I += DispatchPairs_SSE4<_uiFixed>( uiChannels, [&]( auto _icChannels ) {
+				return F32ToF64_SSE4<decltype( _icChannels )::value>( _pui8Src + I * stFrameSize, _stFrames - I, _ppdDst, _stDstIdx + I );
+			}, [&]() {
+				return StridedToF64_SSE4( _pui8Src + I * stFrameSize, sizeof( float ), _stFrames - I, uiChannels, _ppdDst, _stDstIdx + I,
+					LoadPcm<32>, []( __m128i _mBits ) { return _mm_cvtps_pd( _mm_castsi128_ps( _mBits ) ); } );
+			} );
+		}
+#endif	// #ifdef __SSE4_1__
+
+		const uint8_t * pui8Src = _pui8Src + I * stFrameSize;
+		for ( ; I < _stFrames; ++I ) {
+			for ( uint16_t C = 0; C < uiChannels; ++C, pui8Src += sizeof( float ) ) {
+				float fSample;
+				std::memcpy( &fSample, pui8Src, sizeof( fSample ) );
+				_ppdDst[C][_stDstIdx+I] = fSample;
+			}
+		}
+	}
+
+	/**
+	 * Converts interleaved 64-bit float frames to double.  The samples are copied as they are.  A non-zero _uiFixed fixes the channel
+	 *	count at compile time.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.  Ignored if _uiFixed is not 0.
+	 * \param _ppdDst One track per channel.  Frame I of channel C is written to _ppdDst[C][_stDstIdx+I].
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 */
+	template <uint16_t _uiFixed>
+	static void F64FramesToF64( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx ) {
+		const uint16_t uiChannels = _uiFixed ? _uiFixed : _uiChannels;
+		const size_t stFrameSize = sizeof( double ) * uiChannels;
+		size_t I = 0;
+#ifdef __AVX512F__
+		if ( UseTier( CSampleConverter::PW_T_AVX512 ) ) {
+			I = F64ToF64_AVX512( _pui8Src, _stFrames, uiChannels, _ppdDst, _stDstIdx );
+		}
+#endif	// #ifdef __AVX512F__
+#ifdef __AVX2__
+		if ( UseTier( CSampleConverter::PW_T_AVX2 ) ) {
+			I += F64ToF64_AVX2( _pui8Src + I * stFrameSize, _stFrames - I, uiChannels, _ppdDst, _stDstIdx + I );
+		}
+#endif	// #ifdef __AVX2__
+
+		const uint8_t * pui8Src = _pui8Src + I * stFrameSize;
+		for ( ; I < _stFrames; ++I ) {
+			for ( uint16_t C = 0; C < uiChannels; ++C, pui8Src += sizeof( double ) ) {
+				std::memcpy( &_ppdDst[C][_stDstIdx+I], pui8Src, sizeof( double ) );
+			}
+		}
+	}
+
+	/**
+	 * Converts interleaved 32-bit float frames to float.  The samples are copied as they are.  A non-zero _uiFixed fixes the channel
+	 *	count at compile time.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.  Ignored if _uiFixed is not 0.
+	 * \param _ppfDst One track per channel.  Frame I of channel C is written to _ppfDst[C][_stDstIdx+I].
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 */
+	template <uint16_t _uiFixed>
+	static void F32FramesToF32( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, float * const * _ppfDst, size_t _stDstIdx ) {
+		const uint16_t uiChannels = _uiFixed ? _uiFixed : _uiChannels;
+		const size_t stFrameSize = sizeof( float ) * uiChannels;
+		size_t I = 0;
+#ifdef __AVX512F__
+		if ( UseTier( CSampleConverter::PW_T_AVX512 ) ) {
+			I = F32ToF32_AVX512( _pui8Src, _stFrames, uiChannels, _ppfDst, _stDstIdx );
+		}
+#endif	// #ifdef __AVX512F__
+#ifdef __AVX2__
+		if ( UseTier( CSampleConverter::PW_T_AVX2 ) ) {
+			I += F32ToF32_AVX2( _pui8Src + I * stFrameSize, _stFrames - I, uiChannels, _ppfDst, _stDstIdx + I );
+		}
+#endif	// #ifdef __AVX2__
+
+		const uint8_t * pui8Src = _pui8Src + I * stFrameSize;
+		for ( ; I < _stFrames; ++I ) {
+			for ( uint16_t C = 0; C < uiChannels; ++C, pui8Src += sizeof( float ) ) {
+				std::memcpy( &_ppfDst[C][_stDstIdx+I], pui8Src, sizeof( float ) );
+			}
+		}
+	}
+
+	/**
+	 * Converts interleaved frames in any supported format to double.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.  Ignored if _uiFixed is not 0.
+	 * \param _ppdDst One track per channel.  Frame I of channel C is written to _ppdDst[C][_stDstIdx+I].
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 */
+	template <bool _bFloat, unsigned _uiBits, uint16_t _uiFixed>
+	static void FramesToF64( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * const * _ppdDst, size_t _stDstIdx ) {
+		if constexpr ( _bFloat && _uiBits == 32 ) { F32FramesToF64<_uiFixed>( _pui8Src, _stFrames, _uiChannels, _ppdDst, _stDstIdx ); }
+		else if constexpr ( _bFloat ) { F64FramesToF64<_uiFixed>( _pui8Src, _stFrames, _uiChannels, _ppdDst, _stDstIdx ); }
+		else if constexpr ( _uiBits == 24 ) { Pcm24FramesTo<double, _uiFixed>( _pui8Src, _stFrames, _uiChannels, _ppdDst, _stDstIdx ); }
+		else { PcmFramesToF64<_uiBits, _uiBits, _uiFixed>( _pui8Src, _stFrames, _uiChannels, _ppdDst, _stDstIdx ); }
+	}
+
+	/**
+	 * Converts interleaved frames to float.  Only formats a float holds losslessly are supported: 8-, 16-, and 24-bit PCM and 32-bit
+	 *	float.
+	 *
+	 * \param _pui8Src The first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.  Ignored if _uiFixed is not 0.
+	 * \param _ppfDst One track per channel.  Frame I of channel C is written to _ppfDst[C][_stDstIdx+I].
+	 * \param _stDstIdx The index in each track at which to write the first frame.
+	 */
+	template <bool _bFloat, unsigned _uiBits, uint16_t _uiFixed>
+	static void FramesToF32( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, float * const * _ppfDst, size_t _stDstIdx ) {
+		static_assert( _bFloat ? _uiBits == 32 : _uiBits <= 24, "The format does not fit in a float." );
+		if constexpr ( _bFloat ) { F32FramesToF32<_uiFixed>( _pui8Src, _stFrames, _uiChannels, _ppfDst, _stDstIdx ); }
+		else if constexpr ( _uiBits == 24 ) { Pcm24FramesTo<float, _uiFixed>( _pui8Src, _stFrames, _uiChannels, _ppfDst, _stDstIdx ); }
+		else { PcmFramesToF32<_uiBits, _uiBits, _uiFixed>( _pui8Src, _stFrames, _uiChannels, _ppfDst, _stDstIdx ); }
+	}
+
+	/**
+	 * Converts one channel of interleaved frames to double.  Samples are read a byte at a time where needed, so nothing past the last
+	 *	sample of the channel is touched.
+	 *
+	 * \param _pui8Src The sample of the channel in the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels in each frame.  Ignored if _uiFixed is not 0.
+	 * \param _pdDst The buffer to which to write the samples.
+	 */
+	template <bool _bFloat, unsigned _uiBits, uint16_t _uiFixed>
+	static void ChannelToF64( const uint8_t * _pui8Src, size_t _stFrames, uint16_t _uiChannels, double * _pdDst ) {
+		const size_t stFrameSize = (_uiBits / 8) * size_t( _uiFixed ? _uiFixed : _uiChannels );
+		for ( size_t I = 0; I < _stFrames; ++I, _pui8Src += stFrameSize ) {
+			if constexpr ( _bFloat && _uiBits == 32 ) {
+				float fSample;
+				std::memcpy( &fSample, _pui8Src, sizeof( fSample ) );
+				_pdDst[I] = fSample;
+			}
+			else if constexpr ( _bFloat ) {
+				std::memcpy( &_pdDst[I], _pui8Src, sizeof( double ) );
+			}
+			else {
+				_pdDst[I] = LoadPcm<_uiBits>( _pui8Src ) / PcmFactor<_uiBits>();
+			}
+		}
+	}
+
+	/**
+	 * Gets the decoders for one format and channel count.
+	 *
+	 * \return Returns the decoders, with pfDecodeF set to nullptr if a float does not hold the format losslessly.
+	 */
+	template <bool _bFloat, unsigned _uiBits, uint16_t _uiFixed>
+	static constexpr CSampleConverter::PW_DECODERS MakeDecoders() {
+		if constexpr ( _bFloat ? _uiBits == 32 : _uiBits <= 24 ) {
+			return { FramesToF64<_bFloat, _uiBits, _uiFixed>, FramesToF32<_bFloat, _uiBits, _uiFixed>, ChannelToF64<_bFloat, _uiBits, _uiFixed> };
+		}
+		else {
+			return { FramesToF64<_bFloat, _uiBits, _uiFixed>, nullptr, ChannelToF64<_bFloat, _uiBits, _uiFixed> };
+		}
+	}
+
+	/**
+	 * Converts per-channel tracks of doubles to interleaved 8-bit PCM frames.  Samples are clamped to [-1,1].
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _pui8Dst The buffer to which to write the frames.  Must have room for _stFrames * _uiChannels * 1 bytes.
+	 */
+	static void F64ToPcm8Frames( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, uint8_t * _pui8Dst ) {
+		for ( size_t I = 0; I < _stFrames; ++I ) {
+			for ( uint16_t C = 0; C < _uiChannels; ++C ) {
+				// Through int32_t: the rounded value is in [1,255], which does not fit an int8_t.
+				int32_t iSample = static_cast<int32_t>(std::round( Clamp( _ppdSrc[C][_stSrcIdx+I], -1.0, 1.0 ) * 127.0 + 128.0 ));
+				(*_pui8Dst++) = static_cast<uint8_t>(iSample);
+			}
+		}
+	}
+
+	/**
+	 * Converts per-channel tracks of doubles to interleaved 16-bit PCM frames.  Samples are clamped to [-1,1].
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _pui8Dst The buffer to which to write the frames.  Must have room for _stFrames * _uiChannels * 2 bytes.
+	 */
+	static void F64ToPcm16Frames( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, uint8_t * _pui8Dst ) {
+		constexpr double dFactor = PcmFactor<16>();
+		int16_t * pi16Dst = reinterpret_cast<int16_t *>(_pui8Dst);
+		size_t I = 0;
+#ifdef __AVX512F__
+		if ( UseTier( CSampleConverter::PW_T_AVX512 ) ) {
+			I = F64ToPcm_AVX512( _ppdSrc, _stSrcIdx, _stFrames, _uiChannels, dFactor, pi16Dst );
+			pi16Dst += I * _uiChannels;
+		}
+#endif	// #ifdef __AVX512F__
+
+		for ( ; I < _stFrames; ++I ) {
+			for ( uint16_t C = 0; C < _uiChannels; ++C ) {
+				(*pi16Dst++) = static_cast<int16_t>(std::round( Clamp( _ppdSrc[C][_stSrcIdx+I], -1.0, 1.0 ) * dFactor ));
+			}
+		}
+	}
+
+	/**
+	 * Converts per-channel tracks of doubles to interleaved 24-bit PCM frames.  Samples are clamped to [-1,1].  A block at a time is
+	 *	encoded as 32-bit samples on the stack and packed with byte shuffles, so that 24-bit data goes through the same SIMD paths as
+	 *	32-bit data.
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _pui8Dst The buffer to which to write the frames.  Must have room for _stFrames * _uiChannels * 3 bytes.
+	 */
+	static void F64ToPcm24Frames( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, uint8_t * _pui8Dst ) {
+		// Convert a block at a time to 32-bit samples on the stack and pack it with byte shuffles.
+		constexpr double dFactor = PcmFactor<24>() / 256.0;
+		alignas( 64 ) int32_t i32Block[CSampleConverter::PW_D_BLOCK_SAMPLES];
+		const size_t stBlockFrames = Max<size_t>( CSampleConverter::PW_D_BLOCK_SAMPLES / _uiChannels, 1 );
+		for ( size_t I = 0; I < _stFrames; I += stBlockFrames ) {
+			size_t stFrames = Min( stBlockFrames, _stFrames - I );
+			uint8_t * pui8Dst = _pui8Dst + I * _uiChannels * 3;
+			if ( stFrames * _uiChannels > CSampleConverter::PW_D_BLOCK_SAMPLES ) {
+				// More channels than fit in the block.
+				for ( size_t F = 0; F < stFrames; ++F ) {
+					for ( uint16_t C = 0; C < _uiChannels; ++C ) {
+						int32_t iSample = static_cast<int32_t>(std::round( Clamp( _ppdSrc[C][_stSrcIdx+I+F], -1.0, 1.0 ) * dFactor ));
+						Int32ToPcm24( &iSample, 1, pui8Dst );
+						pui8Dst += 3;
+					}
+				}
+				continue;
+			}
+			F64ToInt32( _ppdSrc, _stSrcIdx + I, stFrames, _uiChannels, dFactor, i32Block );
+			Int32ToPcm24( i32Block, stFrames * _uiChannels, pui8Dst );
+		}
+	}
+
+	/**
+	 * Converts per-channel tracks of doubles to interleaved 32-bit PCM frames.  Samples are clamped to [-1,1].
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _pui8Dst The buffer to which to write the frames.  Must have room for _stFrames * _uiChannels * 4 bytes.
+	 */
+	static void F64ToPcm32Frames( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, uint8_t * _pui8Dst ) {
+		F64ToInt32( _ppdSrc, _stSrcIdx, _stFrames, _uiChannels, PcmFactor<32>(), reinterpret_cast<int32_t *>(_pui8Dst) );
+	}
+
+	/**
+	 * Converts per-channel tracks of doubles to interleaved 32-bit float frames.  Each sample is rounded to the nearest float and is
+	 *	not clamped.
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _pui8Dst The buffer to which to write the frames.  Must have room for _stFrames * _uiChannels * 4 bytes.
+	 */
+	static void F64ToFloat32Frames( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, uint8_t * _pui8Dst ) {
+		float * pfDst = reinterpret_cast<float *>(_pui8Dst);
+		size_t I = 0;
+#ifdef __AVX512F__
+		if ( UseTier( CSampleConverter::PW_T_AVX512 ) ) {
+			I = F64ToFloat32_AVX512( _ppdSrc, _stSrcIdx, _stFrames, _uiChannels, reinterpret_cast<int32_t *>(pfDst) );
+		}
+#endif	// #ifdef __AVX512F__
+#ifdef __AVX2__
+		if ( UseTier( CSampleConverter::PW_T_AVX2 ) ) {
+			I += F64ToFloat32_AVX2( _ppdSrc, _stSrcIdx + I, _stFrames - I, _uiChannels, pfDst + I * _uiChannels );
+		}
+#endif	// #ifdef __AVX2__
+
+		for ( pfDst += I * _uiChannels; I < _stFrames; ++I ) {
+			for ( uint16_t C = 0; C < _uiChannels; ++C ) {
+				(*pfDst++) = static_cast<float>(_ppdSrc[C][_stSrcIdx+I]);
+			}
+		}
+	}
+
+	/**
+	 * Converts per-channel tracks of doubles to interleaved 64-bit float frames.  The samples are copied as they are.
+	 *
+	 * \param _ppdSrc One track per channel.
+	 * \param _stSrcIdx The index in each track of the first frame to convert.
+	 * \param _stFrames The number of frames to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _pui8Dst The buffer to which to write the frames.  Must have room for _stFrames * _uiChannels * 8 bytes.
+	 */
+	static void F64ToFloat64Frames( const double * const * _ppdSrc, size_t _stSrcIdx, size_t _stFrames, uint16_t _uiChannels, uint8_t * _pui8Dst ) {
+		double * pdDst = reinterpret_cast<double *>(_pui8Dst);
+		size_t I = 0;
+#ifdef __AVX512F__
+		if ( UseTier( CSampleConverter::PW_T_AVX512 ) ) {
+			I = F64ToFloat64_AVX512( _ppdSrc, _stSrcIdx, _stFrames, _uiChannels, pdDst );
+		}
+#endif	// #ifdef __AVX512F__
+#ifdef __AVX2__
+		if ( UseTier( CSampleConverter::PW_T_AVX2 ) ) {
+			I += F64ToFloat64_AVX2( _ppdSrc, _stSrcIdx + I, _stFrames - I, _uiChannels, pdDst + I * _uiChannels );
+		}
+#endif	// #ifdef __AVX2__
+
+		for ( pdDst += I * _uiChannels; I < _stFrames; ++I ) {
+			for ( uint16_t C = 0; C < _uiChannels; ++C ) {
+				(*pdDst++) = _ppdSrc[C][_stSrcIdx+I];
+			}
+		}
+	}
+
+	/**
+	 * Converts PCM samples from one bit depth to another without going through floating point.  Widening is an exact shift; narrowing
+	 *	truncates, rounds to the nearest code with halves away from zero, or adds triangular dither and then rounds, saturating at the
+	 *	top of the range of the output.  Channels do not matter, so whole interleaved frames can be passed as samples.
+	 *
+	 * \param _pui8Src The first sample to convert.
+	 * \param _uiSrcBits The bits per source sample.  8, 16, 24, or 32.
+	 * \param _pui8Dst The buffer to which to write the samples.  Must have room for _stSamples * _uiDstBits / 8 bytes.
+	 * \param _uiDstBits The bits per output sample.  8, 16, 24, or 32.
+	 * \param _stSamples The number of samples to convert.
+	 * \param _nNarrowing How to drop bits when _uiDstBits is less than _uiSrcBits.
+	 * \param _ui32Dither The state of the dither noise, carried across calls so that consecutive blocks continue the same noise.  Must
+	 *	not be 0.
+	 * \return Returns false if either bit depth is not supported.
+	 */
+	static bool PcmToPcmSamples( const uint8_t * _pui8Src, uint16_t _uiSrcBits, uint8_t * _pui8Dst, uint16_t _uiDstBits, size_t _stSamples,
+		CSampleConverter::PW_NARROWING _nNarrowing, uint32_t &_ui32Dither ) {
+		auto aSupported = []( uint16_t _uiBits ) { return _uiBits == 8 || _uiBits == 16 || _uiBits == 24 || _uiBits == 32; };
+		if ( !aSupported( _uiSrcBits ) || !aSupported( _uiDstBits ) ) { return false; }
+		if ( _uiSrcBits == _uiDstBits ) {
+			std::memcpy( _pui8Dst, _pui8Src, _stSamples * (_uiSrcBits / 8) );
+			return true;
+		}
+
+		// Every sample is moved to the top of a 32-bit value, shifted down to the output depth, and packed.
+		const uint32_t ui32Shift = 32 - _uiDstBits;
+		const bool bNarrowing = _uiDstBits < _uiSrcBits;
+		alignas( 64 ) int32_t i32Block[CSampleConverter::PW_D_BLOCK_SAMPLES];
+		for ( size_t I = 0; I < _stSamples; I += CSampleConverter::PW_D_BLOCK_SAMPLES ) {
+			const size_t stCount = Min<size_t>( _stSamples - I, CSampleConverter::PW_D_BLOCK_SAMPLES );
+			const uint8_t * pui8Src = _pui8Src + I * (_uiSrcBits / 8);
+			switch ( _uiSrcBits ) {
+				case 8 : { Pcm8ToInt32( pui8Src, stCount, i32Block ); break; }
+				case 16 : { Pcm16ToInt32( pui8Src, stCount, i32Block ); break; }
+				case 24 : { Pcm24ToInt32( pui8Src, stCount, i32Block ); break; }
+				case 32 : { std::memcpy( i32Block, pui8Src, stCount * sizeof( int32_t ) ); break; }
+			}
+
+			if ( ui32Shift ) {
+				// When widening, the dropped bits are all 0 and every policy gives the same result.
+				if ( bNarrowing && _nNarrowing == CSampleConverter::PW_N_DITHER ) {
+					DitherInt32( i32Block, stCount, ui32Shift, _ui32Dither );
+				}
+				else {
+					NarrowInt32( i32Block, stCount, ui32Shift, bNarrowing && _nNarrowing == CSampleConverter::PW_N_ROUND );
+				}
+			}
+
+			uint8_t * pui8Dst = _pui8Dst + I * (_uiDstBits / 8);
+			switch ( _uiDstBits ) {
+				case 8 : { Int32ToPcm8( i32Block, stCount, pui8Dst ); break; }
+				case 16 : { Int32ToPcm16( i32Block, stCount, pui8Dst ); break; }
+				case 24 : { Int32ToPcm24( i32Block, stCount, pui8Dst ); break; }
+				case 32 : { std::memcpy( pui8Dst, i32Block, stCount * sizeof( int32_t ) ); break; }
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Fills the decoder table of one format.
+	 *
+	 * \param _pdDst The table to fill, indexed by channel count, with the general decoders at index 0.
+	 */
+	template <bool _bFloat, unsigned _uiBits, size_t... _stChannels>
+	static constexpr void FillDecoders( CSampleConverter::PW_DECODERS * _pdDst, std::index_sequence<_stChannels...> ) {
+		((_pdDst[_stChannels] = MakeDecoders<_bFloat, _uiBits, uint16_t( _stChannels )>()), ...);
+	}
+
+	/**
+	 * Builds the table of every conversion in this file.  It is a constant expression, so the tables are filled before any code runs.
+	 *
+	 * \return Returns the conversions of the tier of this file.
+	 */
+	static constexpr CSampleConverter::PW_KERNELS MakeKernels() {
+		constexpr auto isChannels = std::make_index_sequence<CSampleConverter::PW_D_FIXED_CHANNELS + 1>();
+		CSampleConverter::PW_KERNELS kKernels {};
+		kKernels.tTier = s_tTier;
+		FillDecoders<false, 8>( kKernels.dDecoders[CSampleConverter::PW_SF_PCM8], isChannels );
+		FillDecoders<false, 16>( kKernels.dDecoders[CSampleConverter::PW_SF_PCM16], isChannels );
+		FillDecoders<false, 24>( kKernels.dDecoders[CSampleConverter::PW_SF_PCM24], isChannels );
+		FillDecoders<false, 32>( kKernels.dDecoders[CSampleConverter::PW_SF_PCM32], isChannels );
+		FillDecoders<true, 32>( kKernels.dDecoders[CSampleConverter::PW_SF_FLOAT32], isChannels );
+		FillDecoders<true, 64>( kKernels.dDecoders[CSampleConverter::PW_SF_FLOAT64], isChannels );
+		kKernels.pfEncoders[CSampleConverter::PW_SF_PCM8] = F64ToPcm8Frames;
+		kKernels.pfEncoders[CSampleConverter::PW_SF_PCM16] = F64ToPcm16Frames;
+		kKernels.pfEncoders[CSampleConverter::PW_SF_PCM24] = F64ToPcm24Frames;
+		kKernels.pfEncoders[CSampleConverter::PW_SF_PCM32] = F64ToPcm32Frames;
+		kKernels.pfEncoders[CSampleConverter::PW_SF_FLOAT32] = F64ToFloat32Frames;
+		kKernels.pfEncoders[CSampleConverter::PW_SF_FLOAT64] = F64ToFloat64Frames;
+		kKernels.pfPcmToPcm = PcmToPcmSamples;
+		return kKernels;
+	}
+
+}	// namespace pw
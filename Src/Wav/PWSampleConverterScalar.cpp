@@ -0,0 +1,19 @@
+/**
+ * Copyright L. Spiro 2024
+ *
+ * Written by: Shawn (L. Spiro) Wilcoxen
+ *
+ * Description: The conversions of CSampleConverter without SIMD.  Compile with no instruction set beyond the baseline.
+ */
+
+#define PW_SAMPLE_CONVERTER_TIER										CSampleConverter::PW_T_SCALAR
+#include "PWSampleConverterKernels.h"
+
+
+namespace pw {
+
+	// == Members.
+	/** The conversions for this file's tier. */
+	const CSampleConverter::PW_KERNELS CSampleConverter::m_kScalarKernels = MakeKernels();
+
+}	// namespace pw
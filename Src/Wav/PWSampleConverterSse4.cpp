@@ -0,0 +1,19 @@
+/**
+ * Copyright L. Spiro 2024
+ *
+ * Written by: Shawn (L. Spiro) Wilcoxen
+ *
+ * Description: The conversions of CSampleConverter for SSE 4.1.  Compile with -msse4.1, or on MSVC with __SSE4_1__=1 defined.
+ */
+
+#define PW_SAMPLE_CONVERTER_TIER										CSampleConverter::PW_T_SSE4
+#include "PWSampleConverterKernels.h"
+
+
+namespace pw {
+
+	// == Members.
+	/** The conversions for this file's tier. */
+	const CSampleConverter::PW_KERNELS CSampleConverter::m_kSse4Kernels = MakeKernels();
+
+}	// namespace pw
@@ -7,11 +7,18 @@
  */
 
 #include "PWWavFile.h"
+#include "PWSampleConverter.h"
+#include "PWWavStreamWriter.h"
 #include "../Files/PWStdFile.h"
 #include "../Utilities/PWUtilities.h"
 
+#include <algorithm>
+#include <atomic>
 #include <codecvt>
+#include <cstring>
+#include <cstddef>
 #include <string>
+#include <type_traits>
 
 // warning C4309: 'static_cast': truncation of constant value
 #pragma warning( disable : 4309 )
@@ -24,7 +31,19 @@ namespace pw {
 		m_uiSampleRate( 0 ),
 		m_uiBitsPerSample( 0 ),
 		m_uiBytesPerSample( 0 ),
-		m_uiBaseNote( 64 ) {
+		m_uiValidBitsPerSample( 0 ),
+		m_uiChannelMask( 0 ),
+		m_bExtensible( false ),
+		m_dDecoders(),
+		m_uiBaseNote( 64 ),
+		m_pui8Samples( nullptr ),
+		m_stSamplesSize( 0 ),
+		m_ui64SourceSize( 0 ),
+		m_i64SourceTime( 0 ),
+		m_ui64SamplesOffset( 0 ),
+		m_stThreads( 1 ),
+		m_paArena( nullptr ),
+		m_bTrackDirty( false ) {
 	}
 	CWavFile::~CWavFile() {
 		Reset();
@@ -38,9 +57,27 @@ namespace pw {
 	 * \return Returns true if the file was opened.
 	 */
 	bool CWavFile::Open( const char8_t * _pcPath ) {
+		if ( m_paArena ) {
+			// The file is loaded into the arena's buffer and the samples are read from it in place, reusing the memory of the last file.
+			Reset();
+			std::vector<uint8_t> & vFile = m_paArena->vFile;
+			if ( !CStdFile::LoadToMemory( _pcPath, vFile ) ) { return false; }
+			if ( !LoadFromBuffer( vFile.data(), vFile.size(), false ) ) {
+				Reset();
+				return false;
+			}
+			m_sSourcePath = _pcPath;
+			m_ui64SourceSize = vFile.size();
+			m_i64SourceTime = CFileBase::LastWriteTime( m_sSourcePath.c_str() );
+			return true;
+		}
 		std::vector<uint8_t> vFile;
 		if ( !CStdFile::LoadToMemory( _pcPath, vFile ) ) { return false; }
-		return LoadFromMemory( vFile );
+		if ( !LoadFromMemory( vFile ) ) { return false; }
+		m_sSourcePath = _pcPath;
+		m_ui64SourceSize = vFile.size();
+		m_i64SourceTime = CFileBase::LastWriteTime( m_sSourcePath.c_str() );
+		return true;
 		//return Open( std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>{}.from_bytes( _pcPath ).c_str() );
 	}
 
@@ -51,9 +88,75 @@ namespace pw {
 	 * \return Returns true if the file was opened.
 	 */
 	bool CWavFile::Open( const char16_t * _pwcPath ) {
+		if ( m_paArena ) {
+			// The file is loaded into the arena's buffer and the samples are read from it in place, reusing the memory of the last file.
+			Reset();
+			std::vector<uint8_t> & vFile = m_paArena->vFile;
+			if ( !CStdFile::LoadToMemory( _pwcPath, vFile ) ) { return false; }
+			if ( !LoadFromBuffer( vFile.data(), vFile.size(), false ) ) {
+				Reset();
+				return false;
+			}
+			m_sSourcePath = CUtilities::Utf16ToUtf8( _pwcPath );
+			m_ui64SourceSize = vFile.size();
+			m_i64SourceTime = CFileBase::LastWriteTime( m_sSourcePath.c_str() );
+			return true;
+		}
 		std::vector<uint8_t> vFile;
 		if ( !CStdFile::LoadToMemory( _pwcPath, vFile ) ) { return false; }
-		return LoadFromMemory( vFile );
+		if ( !LoadFromMemory( vFile ) ) { return false; }
+		m_sSourcePath = CUtilities::Utf16ToUtf8( _pwcPath );
+		m_ui64SourceSize = vFile.size();
+		m_i64SourceTime = CFileBase::LastWriteTime( m_sSourcePath.c_str() );
+		return true;
+	}
+
+	/**
+	 * Loads a WAV file by memory-mapping it.  The sample data is not copied; it is read directly from the mapping, which
+	 *	remains open until Reset() is called or another file is opened.  The file must not be overwritten while it is mapped.
+	 *
+	 * \param _pcPath The UTF-8 path to open.
+	 * \return Returns true if the file was opened.
+	 */
+	bool CWavFile::OpenMapped( const char8_t * _pcPath ) {
+		Reset();
+		if ( !m_mfMap.Open( _pcPath ) ) { return false; }
+		if ( m_mfMap.Size() != size_t( m_mfMap.Size() ) ) {
+			Reset();
+			return false;
+		}
+		if ( !LoadFromBuffer( m_mfMap.Data(), size_t( m_mfMap.Size() ), false ) ) {
+			Reset();
+			return false;
+		}
+		m_sSourcePath = _pcPath;
+		m_ui64SourceSize = m_mfMap.Size();
+		m_i64SourceTime = CFileBase::LastWriteTime( m_sSourcePath.c_str() );
+		return true;
+	}
+
+	/**
+	 * Loads a WAV file by memory-mapping it.  The sample data is not copied; it is read directly from the mapping, which
+	 *	remains open until Reset() is called or another file is opened.  The file must not be overwritten while it is mapped.
+	 *
+	 * \param _pwcPath The UTF-16 path to open.
+	 * \return Returns true if the file was opened.
+	 */
+	bool CWavFile::OpenMapped( const char16_t * _pwcPath ) {
+		Reset();
+		if ( !m_mfMap.Open( _pwcPath ) ) { return false; }
+		if ( m_mfMap.Size() != size_t( m_mfMap.Size() ) ) {
+			Reset();
+			return false;
+		}
+		if ( !LoadFromBuffer( m_mfMap.Data(), size_t( m_mfMap.Size() ), false ) ) {
+			Reset();
+			return false;
+		}
+		m_sSourcePath = CUtilities::Utf16ToUtf8( _pwcPath );
+		m_ui64SourceSize = m_mfMap.Size();
+		m_i64SourceTime = CFileBase::LastWriteTime( m_sSourcePath.c_str() );
+		return true;
 	}
 
 	/**
@@ -64,11 +167,23 @@ namespace pw {
 	 */
 	bool CWavFile::LoadFromMemory( const std::vector<uint8_t> &_vData ) {
 		Reset();
+		return LoadFromBuffer( _vData.data(), _vData.size(), true );
+	}
+
+	/**
+	 * Loads a WAV file from a buffer.
+	 *
+	 * \param _pui8Data The in-memory file to load.
+	 * \param _stSize The size of the buffer to which _pui8Data points.
+	 * \param _bCopySamples If true, the "data" chunk is copied into m_vSamples; otherwise m_pui8Samples points into _pui8Data, which must outlive this object's use of it.
+	 * \return Returns true if the file is a valid WAV file.
+	 */
+	bool CWavFile::LoadFromBuffer( const uint8_t * _pui8Data, size_t _stSize, bool _bCopySamples ) {
 		size_t stOffset = 0;
 		const uint32_t * pui32Scratch;
 		//const uint16_t * pui16Scratch;
 
-#define PW_PTR_SIZE( TYPE, OFFSET, SIZE )			((OFFSET) + SIZE) > _vData.size() ? nullptr : reinterpret_cast<const TYPE *>(&_vData[OFFSET])
+#define PW_PTR_SIZE( TYPE, OFFSET, SIZE )			((SIZE) > _stSize || (OFFSET) > _stSize - (SIZE)) ? nullptr : reinterpret_cast<const TYPE *>(&_pui8Data[size_t( OFFSET )])
 #define PW_PTR( TYPE, OFFSET )						PW_PTR_SIZE( TYPE, OFFSET, sizeof( TYPE ) )
 #define PW_READ_32( VAL )							pui32Scratch = PW_PTR( uint32_t, stOffset ); if ( !pui32Scratch ) { return false; } stOffset += sizeof( uint32_t ); VAL = (*pui32Scratch)
 //#define PW_READ_16( VAL )							pui16Scratch = PW_PTR( uint16_t, stOffset ); if ( !pui16Scratch ) { return false; } stOffset += sizeof( uint16_t ); VAL = (*pui16Scratch)
@@ -78,62 +193,98 @@ namespace pw {
 		do {
 			PW_CHUNK cCurChunk;
 			PW_READ_32( cCurChunk.u.uiName );
-			if ( cCurChunk.u.uiName != PW_C_RIFF ) { return false; }
+			if ( cCurChunk.u.uiName != PW_C_RIFF && cCurChunk.u.uiName != PW_C_RF64 && cCurChunk.u.uiName != PW_C_BW64 ) { return false; }
 			PW_READ_32( cCurChunk.uiSize );
 			PW_READ_32( cCurChunk.u2.uiFormat );
 			if ( cCurChunk.u2.uiFormat != PW_C_WAVE ) { return false; }
+			uint64_t ui64RiffSize = cCurChunk.uiSize;
+
+			// RF64 and BW64 files store their 64-bit sizes in a "ds64" chunk that must come first.
+			const PW_DS64_CHUNK * pdcDs64 = nullptr;
+			uint32_t ui32Ds64Entries = 0;
+			if ( cCurChunk.u.uiName != PW_C_RIFF ) {
+				const size_t stDs64Header = offsetof( PW_DS64_CHUNK, teTable );
+				pdcDs64 = PW_PTR_SIZE( PW_DS64_CHUNK, stOffset, stDs64Header );
+				if ( !pdcDs64 || pdcDs64->chHeader.u.uiId != PW_C_DS64 ||
+					pdcDs64->chHeader.uiSize < stDs64Header - sizeof( PW_CHUNK_HEADER ) ) { return false; }
+				if ( cCurChunk.uiSize == 0xFFFFFFFF ) { ui64RiffSize = pdcDs64->ui64RiffSize; }
+				ui32Ds64Entries = std::min<uint32_t>( pdcDs64->ui32TableLength,
+					static_cast<uint32_t>((pdcDs64->chHeader.uiSize - (stDs64Header - sizeof( PW_CHUNK_HEADER ))) / sizeof( PW_DS64_TABLE_ENTRY )) );
+				const uint8_t * pui8Table = PW_PTR_SIZE( uint8_t, stOffset, stDs64Header + ui32Ds64Entries * sizeof( PW_DS64_TABLE_ENTRY ) );
+				if ( !pui8Table ) { return false; }
+			}
+
 			size_t stStartOff = stOffset;
 			std::vector<PW_CHUNK_ENTRY> ceChunks;
 			PW_CHUNK_ENTRY ceThis = { 0 };
-			while ( (stOffset - stStartOff) < cCurChunk.uiSize && stOffset < _vData.size() ) {
-				ceThis.uiOffset = static_cast<uint32_t>(stOffset);
+			while ( (stOffset - stStartOff) < ui64RiffSize && stOffset < _stSize ) {
+				ceThis.ui64Offset = stOffset;
 				PW_READ_32( ceThis.u.uiName );
 				if ( ceThis.u.uiName == 0 ) { break; }
-				PW_READ_32( ceThis.uiSize );
+				uint32_t ui32Size;
+				PW_READ_32( ui32Size );
+				ceThis.ui64Size = ui32Size;
+				if ( pdcDs64 && ui32Size == 0xFFFFFFFF ) {
+					if ( ceThis.u.uiName == PW_C_DATA ) { ceThis.ui64Size = pdcDs64->ui64DataSize; }
+					else {
+						for ( uint32_t T = 0; T < ui32Ds64Entries; ++T ) {
+							if ( pdcDs64->teTable[T].u.uiId == ceThis.u.uiName ) {
+								ceThis.ui64Size = pdcDs64->teTable[T].ui64Size;
+								break;
+							}
+						}
+					}
+				}
 
 				ceChunks.push_back( ceThis );
-				stOffset += ceThis.uiSize;
+				stOffset = ceThis.ui64Size > _stSize - stOffset ? _stSize : stOffset + size_t( ceThis.ui64Size );
 			}
 
 			for ( size_t I = 0; I < ceChunks.size(); ++I ) {
 				switch ( ceChunks[I].u.uiName ) {
 					case PW_C_FMT_ : {		// "fmt "
-						const PW_FMT_CHUNK * pfcFmt = PW_PTR_SIZE( PW_FMT_CHUNK, ceChunks[I].uiOffset, ceChunks[I].uiSize );
+						const PW_FMT_CHUNK * pfcFmt = PW_PTR_SIZE( PW_FMT_CHUNK, ceChunks[I].ui64Offset, ceChunks[I].ui64Size );
 						if ( !pfcFmt ) { return false; }
 
-						if ( !LoadFmt( pfcFmt ) ) { return false; }
+						// The size is only checked from the start of the chunk, so the end of a truncated file can cut it short.
+						size_t stFmtData = size_t( ceChunks[I].ui64Offset ) + sizeof( PW_CHUNK_HEADER );
+						uint64_t ui64FmtSize = stFmtData < _stSize ? std::min<uint64_t>( ceChunks[I].ui64Size, _stSize - stFmtData ) : 0;
+						if ( !LoadFmt( pfcFmt, ui64FmtSize ) ) { return false; }
 						break;
 					}
 					case PW_C_DATA : {		// "data"
-						const PW_DATA_CHUNK * pfcData = PW_PTR_SIZE( PW_DATA_CHUNK, ceChunks[I].uiOffset, ceChunks[I].uiSize );
+						// The samples start after the chunk header, so the header and all of the samples have to fit inside the buffer.
+						if ( ceChunks[I].ui64Size > _stSize - sizeof( PW_CHUNK_HEADER ) ) { return false; }
+						const PW_DATA_CHUNK * pfcData = PW_PTR_SIZE( PW_DATA_CHUNK, ceChunks[I].ui64Offset, ceChunks[I].ui64Size + sizeof( PW_CHUNK_HEADER ) );
 						if ( !pfcData ) { return false; }
 
-						if ( !LoadData( pfcData ) ) { return false; }
+						if ( !LoadData( pfcData, ceChunks[I].ui64Size, _bCopySamples ) ) { return false; }
+						m_ui64SamplesOffset = ceChunks[I].ui64Offset + sizeof( PW_CHUNK_HEADER );
 						break;
 					}
 					case PW_C_SMPL : {		// "smpl"
-						const PW_SMPL_CHUNK * pfcSmpl = PW_PTR_SIZE( PW_SMPL_CHUNK, ceChunks[I].uiOffset, ceChunks[I].uiSize );
+						const PW_SMPL_CHUNK * pfcSmpl = PW_PTR_SIZE( PW_SMPL_CHUNK, ceChunks[I].ui64Offset, ceChunks[I].ui64Size );
 						if ( !pfcSmpl ) { return false; }
 
 						if ( !LoadSmpl( pfcSmpl ) ) { return false; }
 						break;
 					}
 					case PW_C_LIST : {		// "LIST"
-						const PW_LIST_CHUNK * plcList = PW_PTR_SIZE( PW_LIST_CHUNK, ceChunks[I].uiOffset, ceChunks[I].uiSize );
+						const PW_LIST_CHUNK * plcList = PW_PTR_SIZE( PW_LIST_CHUNK, ceChunks[I].ui64Offset, ceChunks[I].ui64Size );
 						if ( !plcList ) { return false; }
 
 						if ( !LoadList( plcList ) ) { return false; }
 						break;
 					}
 					case PW_C_ID3_ : {		// "id3 "
-						const PW_ID3_CHUNK * picList = PW_PTR_SIZE( PW_ID3_CHUNK, ceChunks[I].uiOffset, ceChunks[I].uiSize );
+						const PW_ID3_CHUNK * picList = PW_PTR_SIZE( PW_ID3_CHUNK, ceChunks[I].ui64Offset, ceChunks[I].ui64Size );
 						if ( !picList ) { return false; }
 
 						if ( !LoadId3( picList ) ) { return false; }
 						break;
 					}
 					case PW_C_INST : {		// "inst"
-						const PW_INST_CHUNK * picList = PW_PTR_SIZE( PW_INST_CHUNK, ceChunks[I].uiOffset, ceChunks[I].uiSize );
+						const PW_INST_CHUNK * picList = PW_PTR_SIZE( PW_INST_CHUNK, ceChunks[I].ui64Offset, ceChunks[I].ui64Size );
 						if ( !picList ) { return false; }
 
 						if ( !LoadInst( picList ) ) { return false; }
@@ -152,7 +303,7 @@ namespace pw {
 				default : { return false; }
 			}*/
 			//m_vChunks.push_back( cCurChunk );
-		} while ( stOffset < _vData.size() );
+		} while ( stOffset < _stSize );
 
 
 #undef PW_READ_STRUCT
@@ -163,7 +314,7 @@ namespace pw {
 	}
 
 	/**
-	 * Saves as a PCM WAV file.
+	 * Saves as a PCM WAV file, or an IEEE float WAV file if PW_SAVE_DATA::fFormat asks for one.
 	 *
 	 * \param _pcPath The path to where the file will be saved.
 	 * \param _vSamples The samples to convert and write to the file.
@@ -172,127 +323,177 @@ namespace pw {
 	 */
 	bool CWavFile::SaveAsPcm( const char8_t * _pcPath, const lwaudio &_vSamples,
 		const PW_SAVE_DATA * _psdSaveSettings ) const {
-		if ( !_vSamples.size() ) { return false; }
-		std::u8string sPath = _pcPath;
-		std::u8string sFolder = CFileBase::GetFilePath( sPath );
-		std::u8string sName = CFileBase::GetFileName( sPath );
-		
-
-		std::u8string sCopy = sName;
-		const struct PW_TABLE {
-			const char8_t *					pcReplaceMe;
-			const char8_t *					pcWithMe;
-		} tTable[] = {
-			{ u8"?", u8"-" },
-			{ u8"*", u8"˙" },
-			{ u8":", u8" -" },
-			{ u8"\\", u8"-" },
-			{ u8"/", u8"∕" },
-			{ u8"<", u8"‹" },
-			{ u8">", u8"›" },
-			{ u8"|", u8"¦" },
-			{ u8"\"", u8"‟" },
-		};
-		for ( auto I = sizeof( tTable ) / sizeof( tTable[0] ); I--; ) {
-			sCopy = CUtilities::Replace<std::u8string>( sCopy, reinterpret_cast<const char8_t *>(tTable[I].pcReplaceMe), reinterpret_cast<const char8_t *>(tTable[I].pcWithMe) );
-		};
-
-		sPath = sFolder + sCopy;
+		return SaveSamples( _pcPath, _vSamples, _psdSaveSettings );
+	}
 
-		CStdFile sfFile;
-		if ( !sfFile.Create( sPath.c_str() ) ) {
-			std::wprintf( L"Failed to create PCM file: %s.\r\n", reinterpret_cast<const wchar_t *>(CUtilities::Utf8ToUtf16( sPath.c_str() ).c_str()) );
-			return false;
-		}
-		PW_FMT_CHUNK fcChunk = CreateFmt( PW_F_PCM, static_cast<uint16_t>(_vSamples.size()),
-			_psdSaveSettings );
-		std::vector<uint8_t> vLoops, vList;
-		if ( m_vLoops.size() ) {
-			vLoops = CreateSmpl();
-		}
-		if ( m_vListEntries.size() ) {
-			vList = CreateList();
-		}
-		
+	/**
+	 * Saves as a PCM WAV file from float samples, or an IEEE float WAV file if PW_SAVE_DATA::fFormat asks for one.
+	 *
+	 * \param _pcPath The path to where the file will be saved.
+	 * \param _vSamples The samples to convert and write to the file.
+	 * \param _psdSaveSettings Settings to override this class's settings.
+	 * \return Returns true if the file was created and saved.
+	 */
+	bool CWavFile::SaveAsPcm( const char8_t * _pcPath, const lwaudiof &_vSamples,
+		const PW_SAVE_DATA * _psdSaveSettings ) const {
+		return SaveSamples( _pcPath, _vSamples, _psdSaveSettings );
+	}
 
-		uint32_t uiFmtSize = fcChunk.chHeader.uiSize + 8;
-		uint32_t ui32DataSize = CalcSize( static_cast<PW_FORMAT>(fcChunk.uiAudioFormat), static_cast<uint32_t>(_vSamples[0].size()), static_cast<uint16_t>(_vSamples.size()), fcChunk.uiBitsPerSample );
+	/**
+	 * Saves as a PCM WAV file from planar samples, or an IEEE float WAV file if PW_SAVE_DATA::fFormat asks for one.
+	 *
+	 * \param _pcPath The path to where the file will be saved.
+	 * \param _bSamples The samples to convert and write to the file.
+	 * \param _psdSaveSettings Settings to override this class's settings.
+	 * \return Returns true if the file was created and saved.
+	 */
+	bool CWavFile::SaveAsPcm( const char8_t * _pcPath, const lwblock &_bSamples,
+		const PW_SAVE_DATA * _psdSaveSettings ) const {
+		return SaveSamples( _pcPath, _bSamples, _psdSaveSettings );
+	}
 
-		uint32_t ui32Size = 4 +						// "WAVE".
-			uiFmtSize +								// "fmt " chunk.
-			ui32DataSize + 8 +						// "data" chunk.
-			static_cast<uint32_t>(vLoops.size()) +	// "smpl" chunk.
-			static_cast<uint32_t>(vList.size()) +	// "LIST" chunk.
-			0;
+	/**
+	 * Saves as a PCM WAV file from planar float samples, or an IEEE float WAV file if PW_SAVE_DATA::fFormat asks for one.
+	 *
+	 * \param _pcPath The path to where the file will be saved.
+	 * \param _bSamples The samples to convert and write to the file.
+	 * \param _psdSaveSettings Settings to override this class's settings.
+	 * \return Returns true if the file was created and saved.
+	 */
+	bool CWavFile::SaveAsPcm( const char8_t * _pcPath, const lwblockf &_bSamples,
+		const PW_SAVE_DATA * _psdSaveSettings ) const {
+		return SaveSamples( _pcPath, _bSamples, _psdSaveSettings );
+	}
 
-		std::vector<uint8_t> vRet;
-		vRet.reserve( ui32Size + 8 );
-#define PW_PUSH32( VAL )		vRet.push_back( static_cast<uint8_t>((VAL) >> 0) ); vRet.push_back( static_cast<uint8_t>((VAL) >> 8) ); vRet.push_back( static_cast<uint8_t>((VAL) >> 16) ); vRet.push_back( static_cast<uint8_t>((VAL) >> 24) )
-		PW_PUSH32( PW_C_RIFF );						// "RIFF"
-		
-		PW_PUSH32( ui32Size );
-		PW_PUSH32( PW_C_WAVE );
-		
-		// Append the "fmt " chunk.
-		for ( size_t I = 0; I < uiFmtSize; ++I ) {
-			vRet.push_back( reinterpret_cast<const uint8_t *>(&fcChunk)[I] );
+	/**
+	 * Gets the bits per sample in a saved file.  Unless the settings override it, the loaded bit depth is kept if the output format
+	 *	supports it, otherwise 32 bits are used.
+	 *
+	 * \param _psdSaveSettings Settings to override this class's settings.
+	 * \return Returns the bits per sample in a saved file.
+	 */
+	uint16_t CWavFile::OutputBits( const PW_SAVE_DATA * _psdSaveSettings ) const {
+		if ( _psdSaveSettings && _psdSaveSettings->uiBitsPerSample ) { return _psdSaveSettings->uiBitsPerSample; }
+		if ( OutputFormat( _psdSaveSettings ) == PW_F_IEEE_FLOAT ) {
+			return m_uiBitsPerSample == 64 ? 64 : 32;
 		}
+		return (m_uiBitsPerSample == 8 || m_uiBitsPerSample == 16 || m_uiBitsPerSample == 24) ? m_uiBitsPerSample : 32;
+	}
 
-		// Append the "data" chunk.
-		PW_PUSH32( PW_C_DATA );
-		PW_PUSH32( ui32DataSize );
-		switch ( fcChunk.uiAudioFormat ) {
+	/**
+	 * Determines if SaveAsPcmCopy() can be used with the given settings to copy the samples verbatim.  The loaded samples must be
+	 *	8-, 16-, 24-, or 32-bit PCM or 32- or 64-bit float, and the output must have the same format and bit depth.
+	 *
+	 * \param _psdSaveSettings Settings to override this class's settings.
+	 * \return Returns true if the loaded sample data can be copied verbatim to the output file.
+	 */
+	bool CWavFile::CanCopySamples( const PW_SAVE_DATA * _psdSaveSettings ) const {
+		if ( !m_uiNumChannels || nullptr == m_pui8Samples ) { return false; }
+		switch ( m_fFormat ) {
 			case PW_F_PCM : {
-				switch ( fcChunk.uiBitsPerSample ) {
-					case 8 : {
-						if ( !BatchF64ToPcm8( _vSamples, vRet ) ) {
-							return false;
-						}
-						break;
-					}
-					case 16 : {
-						if ( !BatchF64ToPcm16( _vSamples, vRet ) ) {
-							return false;
-						}
-						break;
-					}
-					case 24 : {
-						if ( !BatchF64ToPcm24( _vSamples, vRet ) ) {
-							return false;
-						}
-						break;
-					}
-					case 32 : {
-						if ( !BatchF64ToPcm32( _vSamples, vRet ) ) {
-							return false;
-						}
-						break;
-					}
-					default : {
-						return false;
-					}
-				}
+				if ( m_uiBitsPerSample != 8 && m_uiBitsPerSample != 16 && m_uiBitsPerSample != 24 && m_uiBitsPerSample != 32 ) { return false; }
 				break;
 			}
-			default : {
-				return false;
+			case PW_F_IEEE_FLOAT : {
+				if ( m_uiBitsPerSample != 32 && m_uiBitsPerSample != 64 ) { return false; }
+				break;
 			}
+			default : { return false; }
 		}
+		return OutputFormat( _psdSaveSettings ) == m_fFormat && OutputBits( _psdSaveSettings ) == m_uiBitsPerSample;
+	}
 
-		// Append "smpl" chunk.
-		for ( size_t I = 0; I < vLoops.size(); ++I ) {
-			vRet.push_back( vLoops[I] );
+	/**
+	 * Determines if SaveAsPcmCopy() can be used with the given settings.  Either CanCopySamples() returns true, or the loaded
+	 *	samples are 8-, 16-, 24-, or 32-bit PCM and so is the output.
+	 *
+	 * \param _psdSaveSettings Settings to override this class's settings.
+	 * \return Returns true if the loaded sample data can be copied to the output file, converting only its bit depth.
+	 */
+	bool CWavFile::CanConvertSamples( const PW_SAVE_DATA * _psdSaveSettings ) const {
+		if ( CanCopySamples( _psdSaveSettings ) ) { return true; }
+		if ( m_fFormat == PW_F_PCM && CanCopySamples() && OutputFormat( _psdSaveSettings ) == PW_F_PCM ) {
+			uint16_t uiBits = OutputBits( _psdSaveSettings );
+			return uiBits == 8 || uiBits == 16 || uiBits == 24 || uiBits == 32;
 		}
+		return false;
+	}
 
-		// Append "LIST" chunk.
-		for ( size_t I = 0; I < vList.size(); ++I ) {
-			vRet.push_back( vList[I] );
+	/**
+	 * Determines if the samples can be worked on as float instead of double without changing an unmodified save.  The loaded
+	 *	samples must be 32-bit float, or 8-, 16-, or 24-bit PCM saved at the same bit depth.  Every such code is held in a float
+	 *	closely enough to encode back to itself, so float tracks take half the memory and bandwidth of double tracks for the same
+	 *	output.
+	 *
+	 * \param _psdSaveSettings Settings to override this class's settings.
+	 * \return Returns true if decoding to and saving from float tracks gives the same file as doing so with double tracks.
+	 */
+	bool CWavFile::FloatIsLossless( const PW_SAVE_DATA * _psdSaveSettings ) const {
+		if ( m_fFormat == PW_F_IEEE_FLOAT ) {
+			// Widening a float to double is exact, so the double encoders see the same values either way.
+			return m_uiNumChannels && nullptr != m_pui8Samples && m_uiBitsPerSample == 32;
 		}
-		if ( !sfFile.WriteToFile( vRet ) ) { return false; }
+		// A PCM code decoded to float is off by less than half a code at its own bit depth, but not at a higher one.
+		return m_uiBitsPerSample <= 24 && CanCopySamples( _psdSaveSettings );
+	}
 
-#undef PW_PUSH32
-		return true;
+	/**
+	 * Saves as a WAV file, copying the loaded sample data instead of decoding and re-encoding it.  If the format and bit depth are
+	 *	unchanged the samples are copied verbatim and only the header and metadata chunks are rebuilt; otherwise PCM samples are
+	 *	converted with CSampleConverter::PcmToPcm().  Fails if CanConvertSamples() returns false.
+	 *
+	 * \param _pcPath The path to where the file will be saved.
+	 * \param _psdSaveSettings Settings to override this class's settings.
+	 * \return Returns true if the file was created and saved.
+	 */
+	bool CWavFile::SaveAsPcmCopy( const char8_t * _pcPath, const PW_SAVE_DATA * _psdSaveSettings ) const {
+		if ( !CanConvertSamples( _psdSaveSettings ) ) { return false; }
+		std::u8string sPath = SanitizePath( _pcPath );
+
+		CWavStreamWriter wswWriter;
+		uint64_t ui64Total = TotalSamples();
+		bool bVerbatim = CanCopySamples( _psdSaveSettings );
+		// Padding the header to line the samples up with the source's blocks only pays off if they can be cloned.
+		bool bClone = m_sSourcePath.size() && bVerbatim && CStdFile::CanCloneRange( m_sSourcePath.c_str(), sPath.c_str() );
+		if ( !wswWriter.Create( sPath.c_str(), (*this), m_uiNumChannels, _psdSaveSettings, ui64Total,
+			bClone ? m_ui64SamplesOffset : UINT64_MAX ) ) {
+			std::wprintf( L"Failed to create PCM file: %s.\r\n", reinterpret_cast<const wchar_t *>(CUtilities::Utf8ToUtf16( sPath.c_str() ).c_str()) );
+			return false;
+		}
 
+		if ( !bVerbatim ) {
+			// Convert the bit depth a block at a time with integer shifts; nothing is decoded to floating point.  The dither seed is
+			//	fixed so that saving the same file twice gives the same output.
+			uint16_t uiBits = OutputBits( _psdSaveSettings );
+			CSampleConverter::PW_NARROWING nNarrowing = _psdSaveSettings->nNarrowing;
+			uint32_t ui32Dither = 0x50574156;
+			size_t stBlockSamples = CWavStreamWriter::PW_D_BLOCK_FRAMES * m_uiNumChannels;
+			size_t stTotal = size_t( ui64Total ) * m_uiNumChannels;
+			std::vector<uint8_t> vOwnConverted;
+			std::vector<uint8_t> & vConverted = m_paArena ? m_paArena->vEncoded : vOwnConverted;
+			try {
+				vConverted.resize( std::min( stBlockSamples, stTotal ) * (uiBits / 8) );
+			}
+			catch ( ... ) { return false; }
+			for ( size_t I = 0; I < stTotal; I += stBlockSamples ) {
+				size_t stCount = std::min( stBlockSamples, stTotal - I );
+				CSampleConverter::PcmToPcm( m_pui8Samples + I * m_uiBytesPerSample, m_uiBitsPerSample, vConverted.data(), uiBits, stCount,
+					nNarrowing, ui32Dither );
+				if ( !wswWriter.WriteRaw( vConverted.data(), stCount * (uiBits / 8) ) ) { return false; }
+			}
+			return wswWriter.Finalize();
+		}
+		// Any partial frame at the end of the "data" chunk is dropped, just as it is when decoding.
+		uint64_t ui64Bytes = ui64Total * m_uiNumChannels * m_uiBytesPerSample;
+
+		// Let the OS copy or clone the samples straight from the source file if it is still the file that was loaded, judged by its
+		//	size and the time it was last written.  The source is opened after the output is created so that saving over it is caught
+		//	(it is either truncated or locked by then), in which case the samples already in memory are written instead.
+		CStdFile sfSource;
+		bool bCopied = m_sSourcePath.size() && sfSource.Open( m_sSourcePath.c_str() ) && sfSource.Size() == m_ui64SourceSize &&
+			CFileBase::LastWriteTime( m_sSourcePath.c_str() ) == m_i64SourceTime && wswWriter.WriteRawFrom( sfSource, m_ui64SamplesOffset, ui64Bytes );
+		if ( !bCopied && !wswWriter.WriteRaw( m_pui8Samples, size_t( ui64Bytes ) ) ) { return false; }
+		return wswWriter.Finalize();
 	}
 
 	/**
@@ -301,6 +502,13 @@ namespace pw {
 	void CWavFile::Reset() {
 		//m_vChunks.clear();
 		m_vSamples.clear();
+		m_pui8Samples = nullptr;
+		m_stSamplesSize = 0;
+		m_mfMap.Close();
+		m_sSourcePath.clear();
+		m_ui64SourceSize = 0;
+		m_i64SourceTime = 0;
+		m_ui64SamplesOffset = 0;
 		m_vLoops.clear();
 		m_vListEntries.clear();
 		m_vId3Entries.clear();
@@ -309,7 +517,64 @@ namespace pw {
 		m_uiSampleRate = 0;
 		m_uiBytesPerSample = 0;
 		m_uiBitsPerSample = 0;
+		m_uiValidBitsPerSample = 0;
+		m_uiChannelMask = 0;
+		m_bExtensible = false;
+		m_dDecoders = CSampleConverter::PW_DECODERS();
 		m_uiBaseNote = 64;
+		MarkAllDirty();
+	}
+
+	/**
+	 * Declares that the samples most recently obtained with GetAllSamples() have not been modified.  From then on SaveAsPcm() only
+	 *	re-encodes the ranges passed to MarkDirty() and copies every other sample verbatim from the loaded data, as long as the
+	 *	output format, channel count, and length match the loaded file.
+	 */
+	void CWavFile::MarkClean() {
+		try {
+			m_vDirty.assign( m_uiNumChannels, std::vector<PW_RANGE>() );
+			m_bTrackDirty = true;
+		}
+		catch ( ... ) { MarkAllDirty(); }
+	}
+
+	/**
+	 * Records that a range of samples on a channel has been modified.  Does nothing unless MarkClean() has been called.
+	 *
+	 * \param _uiChan The channel that was modified.
+	 * \param _stFrom The first modified sample.
+	 * \param _stTo The sample after the last modified sample.
+	 */
+	void CWavFile::MarkDirty( uint16_t _uiChan, size_t _stFrom, size_t _stTo ) {
+		if ( !m_bTrackDirty || _stFrom >= _stTo ) { return; }
+		if ( _uiChan >= m_vDirty.size() ) {
+			// Not a channel of the loaded file, so the samples no longer line up with it.
+			MarkAllDirty();
+			return;
+		}
+		try {
+			AddRange( m_vDirty[_uiChan], _stFrom, _stTo );
+		}
+		catch ( ... ) { MarkAllDirty(); }
+	}
+
+	/**
+	 * Records that any sample may have been modified, so that SaveAsPcm() re-encodes everything.  This is the state after loading.
+	 */
+	void CWavFile::MarkAllDirty() {
+		m_bTrackDirty = false;
+		m_vDirty = std::vector<std::vector<PW_RANGE>>();
+	}
+
+	/**
+	 * Gets the modified ranges of a channel, sorted and non-overlapping.  Only meaningful if AllDirty() returns false.
+	 *
+	 * \param _uiChan The channel whose modified ranges are to be returned.
+	 * \return Returns the modified ranges of the channel.
+	 */
+	const std::vector<CWavFile::PW_RANGE> & CWavFile::DirtyRanges( uint16_t _uiChan ) const {
+		static const std::vector<PW_RANGE> vEmpty;
+		return _uiChan < m_vDirty.size() ? m_vDirty[_uiChan] : vEmpty;
 	}
 
 #pragma optimize( "gt", on )
@@ -322,85 +587,317 @@ namespace pw {
 	 * \return Returns true if the vector was able to fit all samples.
 	 */
 	bool CWavFile::GetAllSamples( uint16_t _uiChan, lwtrack &_vResult ) const {
-		if ( _uiChan >= m_uiNumChannels ) { return false; }
-		switch ( m_uiBitsPerSample ) {
-			case 8 : {
-				return Pcm8ToF64( 0, static_cast<uint32_t>(TotalSamples()), _uiChan, _vResult );
-			}
-			case 16 : {
-				return Pcm16ToF64( 0, static_cast<uint32_t>(TotalSamples()), _uiChan, _vResult );
-			}
-			case 24 : {
-				return Pcm24ToF64( 0, static_cast<uint32_t>(TotalSamples()), _uiChan, _vResult );
-			}
-			case 32 : {
-				switch ( m_fFormat ) {
-					case PW_F_IEEE_FLOAT : {
-						return F32ToF64( 0, static_cast<uint32_t>(TotalSamples()), _uiChan, _vResult );
-					}
-					case PW_F_PCM : {
-						return Pcm32ToF64( 0, static_cast<uint32_t>(TotalSamples()), _uiChan, _vResult );
-					}
-				}
-			}
+		return GetSamples( _uiChan, _vResult, 0, size_t( TotalSamples() ) );
+	}
 
+	/**
+	 * Fills a vector with the whole range of samples for a given channel.
+	 *
+	 * \param _uiChan The channel whose sample data is to be obtained.
+	 * \param _vResult The vector containing the samples.
+	 * \param _stFrom The starting sample to get.
+	 * \param _stTo The ending sample to get, exclusive.
+	 * \return Returns true if the vector was able to fit all samples.
+	 */
+	bool CWavFile::GetSamples( uint16_t _uiChan, lwtrack &_vResult, size_t _stFrom, size_t _stTo ) const {
+		if ( _uiChan >= m_uiNumChannels || _stFrom > _stTo ) { return false; }
+		size_t stOffset = _vResult.size();
+		try {
+			_vResult.resize( stOffset + (_stTo - _stFrom) );
 		}
-		return false;
+		catch ( ... ) { return false; }
+		if ( !DecodeSamples( _uiChan, _stFrom, _stTo, _vResult.data() + stOffset ) ) {
+			_vResult.resize( stOffset );
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Appends a range of samples on every channel to an array of vectors, one per channel.  The interleaved sample data is read
+	 *	only once for all channels.
+	 *
+	 * \param _vResult The array of vectors to which to append the samples.  Resized to the number of channels.
+	 * \param _stFrom The starting sample to get.
+	 * \param _stTo The ending sample to get, exclusive.
+	 * \return Returns true if the vectors were able to fit all samples.
+	 */
+	bool CWavFile::GetSamples( lwaudio &_vResult, size_t _stFrom, size_t _stTo ) const {
+		return AppendSamples( _vResult, _stFrom, _stTo );
+	}
+
+	/**
+	 * Fills an array of vectors.  There is an array of vectors for each channel, and each vector contains all
+	 *	of the samples for that channel.
+	 *
+	 * \param _vResult The array of vectors to be filled with all samples in this file.
+	 * \return Returns true if the vector(s) was/were able to fit all samples.
+	 */
+	bool CWavFile::GetAllSamples( lwaudio &_vResult ) const {
+		return AppendAllSamples( _vResult );
+	}
+
+	/**
+	 * Appends a range of samples on every channel to an array of float vectors, one per channel.  The interleaved sample data is
+	 *	read only once for all channels.  32-bit PCM cannot be decoded to float.
+	 *
+	 * \param _vResult The array of vectors to which to append the samples.  Resized to the number of channels.
+	 * \param _stFrom The starting sample to get.
+	 * \param _stTo The ending sample to get, exclusive.
+	 * \return Returns true if the vectors were able to fit all samples.
+	 */
+	bool CWavFile::GetSamples( lwaudiof &_vResult, size_t _stFrom, size_t _stTo ) const {
+		return AppendSamples( _vResult, _stFrom, _stTo );
+	}
+
+	/**
+	 * Fills an array of float vectors.  There is an array of vectors for each channel, and each vector contains all of the
+	 *	samples for that channel.  32-bit PCM cannot be decoded to float.
+	 *
+	 * \param _vResult The array of vectors to be filled with all samples in this file.
+	 * \return Returns true if the vector(s) was/were able to fit all samples.
+	 */
+	bool CWavFile::GetAllSamples( lwaudiof &_vResult ) const {
+		return AppendAllSamples( _vResult );
+	}
+
+	/**
+	 * Fills a planar buffer with every sample.  The buffer is resized to the channels and frames of the file, reusing its block
+	 *	if it is large enough.
+	 *
+	 * \param _bResult The buffer to be filled with all samples in this file.
+	 * \return Returns true if the buffer was able to fit all samples.
+	 */
+	bool CWavFile::GetAllSamples( lwblock &_bResult ) const {
+		return FillAllSamples( _bResult );
+	}
+
+	/**
+	 * Fills a planar float buffer with every sample.  The buffer is resized to the channels and frames of the file, reusing its
+	 *	block if it is large enough.  32-bit PCM cannot be decoded to float.
+	 *
+	 * \param _bResult The buffer to be filled with all samples in this file.
+	 * \return Returns true if the buffer was able to fit all samples.
+	 */
+	bool CWavFile::GetAllSamples( lwblockf &_bResult ) const {
+		return FillAllSamples( _bResult );
+	}
+
+	/**
+	 * Converts a range of samples on a channel to double using the converter for the loaded format.
+	 *
+	 * \param _uiChan The channel whose sample data is to be obtained.
+	 * \param _ui64From Starting sample index.
+	 * \param _ui64To Ending sample index, exclusive.  Must not exceed TotalSamples().
+	 * \param _pdResult The buffer to fill.  Must have room for (_ui64To - _ui64From) values.
+	 * \return Returns true if the format is supported and the range is valid.
+	 */
+	bool CWavFile::DecodeSamples( uint16_t _uiChan, uint64_t _ui64From, uint64_t _ui64To, double * _pdResult ) const {
+		if ( _uiChan >= m_uiNumChannels || _ui64From > _ui64To || _ui64To > TotalSamples() ) { return false; }
+		if ( !m_dDecoders.pfDecodeChannel ) { return false; }
+		uint32_t uiStride;
+		m_dDecoders.pfDecodeChannel( &m_pui8Samples[CalcOffsetsForSample( _uiChan, _ui64From, uiStride )], size_t( _ui64To - _ui64From ), m_uiNumChannels, _pdResult );
+		return true;
+	}
+
+	/**
+	 * Converts a range of frames on all channels to double in a single pass over the interleaved sample data.
+	 *
+	 * \param _ui64From Starting frame index.
+	 * \param _ui64To Ending frame index, exclusive.  Must not exceed TotalSamples().
+	 * \param _ppdResult One buffer per channel.  Frame I is written to _ppdResult[C][_stDstIdx+I-_ui64From].
+	 * \param _stDstIdx The index in each buffer at which to write the first frame.
+	 * \return Returns true if the format is supported and the range is valid.
+	 */
+	bool CWavFile::DecodeFrames( uint64_t _ui64From, uint64_t _ui64To, double * const * _ppdResult, size_t _stDstIdx ) const {
+		if ( _ui64From > _ui64To || _ui64To > TotalSamples() ) { return false; }
+		if ( !m_dDecoders.pfDecode ) { return false; }
+		uint32_t uiStride;
+		m_dDecoders.pfDecode( &m_pui8Samples[CalcOffsetsForSample( 0, _ui64From, uiStride )], size_t( _ui64To - _ui64From ), m_uiNumChannels, _ppdResult, _stDstIdx );
+		return true;
+	}
+
+	/**
+	 * Converts a range of frames on all channels to float in a single pass over the interleaved sample data.
+	 *
+	 * \param _ui64From Starting frame index.
+	 * \param _ui64To Ending frame index, exclusive.  Must not exceed TotalSamples().
+	 * \param _ppfResult One buffer per channel.  Frame I is written to _ppfResult[C][_stDstIdx+I-_ui64From].
+	 * \param _stDstIdx The index in each buffer at which to write the first frame.
+	 * \return Returns true if the format can be decoded to float and the range is valid.
+	 */
+	bool CWavFile::DecodeFrames( uint64_t _ui64From, uint64_t _ui64To, float * const * _ppfResult, size_t _stDstIdx ) const {
+		if ( _ui64From > _ui64To || _ui64To > TotalSamples() ) { return false; }
+		if ( !m_dDecoders.pfDecodeF ) { return false; }
+		uint32_t uiStride;
+		m_dDecoders.pfDecodeF( &m_pui8Samples[CalcOffsetsForSample( 0, _ui64From, uiStride )], size_t( _ui64To - _ui64From ), m_uiNumChannels, _ppfResult, _stDstIdx );
+		return true;
 	}
 
 	/**
-	 * Fills a vector with the whole range of samples for a given channel.
+	 * Appends a range of samples on every channel to an array of vectors, one per channel.
 	 *
-	 * \param _uiChan The channel whose sample data is to be obtained.
-	 * \param _vResult The vector containing the samples.
+	 * \param _vResult The array of vectors to which to append the samples.  Resized to the number of channels.
 	 * \param _stFrom The starting sample to get.
 	 * \param _stTo The ending sample to get, exclusive.
-	 * \return Returns true if the vector was able to fit all samples.
+	 * \return Returns true if the vectors were able to fit all samples.
 	 */
-	bool CWavFile::GetSamples( uint16_t _uiChan, lwtrack &_vResult, size_t _stFrom, size_t _stTo ) const {
-		if ( _uiChan >= m_uiNumChannels ) { return false; }
-		switch ( m_uiBitsPerSample ) {
-			case 8 : {
-				return Pcm8ToF64( static_cast<uint32_t>(_stFrom), static_cast<uint32_t>(_stTo), _uiChan, _vResult );
-			}
-			case 16 : {
-				return Pcm16ToF64( static_cast<uint32_t>(_stFrom), static_cast<uint32_t>(_stTo), _uiChan, _vResult );
-			}
-			case 24 : {
-				return Pcm24ToF64( static_cast<uint32_t>(_stFrom), static_cast<uint32_t>(_stTo), _uiChan, _vResult );
+	template <typename _tType>
+	bool CWavFile::AppendSamples( lwaudio_t<_tType> &_vResult, size_t _stFrom, size_t _stTo ) const {
+		if ( _stFrom > _stTo ) { return false; }
+		try {
+			_vResult.resize( m_uiNumChannels );
+			std::vector<_tType *> vDst( m_uiNumChannels );
+			std::vector<size_t> vOffsets( m_uiNumChannels );
+			for ( auto I = m_uiNumChannels; I--; ) {
+				vOffsets[I] = _vResult[I].size();
+				_vResult[I].resize( vOffsets[I] + (_stTo - _stFrom) );
+				vDst[I] = _vResult[I].data() + vOffsets[I];
 			}
-			case 32 : {
-				switch ( m_fFormat ) {
-					case PW_F_IEEE_FLOAT : {
-						return F32ToF64( static_cast<uint32_t>(_stFrom), static_cast<uint32_t>(_stTo), _uiChan, _vResult );
-					}
-					case PW_F_PCM : {
-						return Pcm32ToF64( static_cast<uint32_t>(_stFrom), static_cast<uint32_t>(_stTo), _uiChan, _vResult );
-					}
+			if ( !DecodeFrames( _stFrom, _stTo, vDst.data(), 0 ) ) {
+				for ( auto I = m_uiNumChannels; I--; ) {
+					_vResult[I].resize( vOffsets[I] );
 				}
+				return false;
 			}
-
+			return true;
 		}
-		return false;
+		catch ( ... ) { return false; }
 	}
 
 	/**
-	 * Fills an array of vectors.  There is an array of vectors for each channel, and each vector contains all
-	 *	of the samples for that channel.
+	 * Fills an array of vectors with every sample, decoding tiles on m_stThreads threads.
 	 *
 	 * \param _vResult The array of vectors to be filled with all samples in this file.
 	 * \return Returns true if the vector(s) was/were able to fit all samples.
 	 */
-	bool CWavFile::GetAllSamples( lwaudio &_vResult ) const {
+	template <typename _tType>
+	bool CWavFile::AppendAllSamples( lwaudio_t<_tType> &_vResult ) const {
 		try {
 			_vResult.resize( m_uiNumChannels );
 			if ( _vResult.size() != m_uiNumChannels ) { return false; }
+			uint64_t ui64Total = TotalSamples();
+			std::vector<_tType *> vDst( m_uiNumChannels );
 			for ( auto I = m_uiNumChannels; I--; ) {
-				if ( !GetAllSamples( I, _vResult[I] ) ) { return false; }
+				size_t stOffset = _vResult[I].size();
+				_vResult[I].resize( stOffset + size_t( ui64Total ) );
+				vDst[I] = _vResult[I].data() + stOffset;
+			}
+			return DecodeAllFrames( vDst.data() );
+		}
+		catch ( ... ) { return false; }
+	}
+
+	/**
+	 * Fills a planar buffer with every sample, decoding tiles on m_stThreads threads.
+	 *
+	 * \param _pbResult The buffer to be filled with all samples in this file.
+	 * \return Returns true if the buffer was able to fit all samples.
+	 */
+	template <typename _tType>
+	bool CWavFile::FillAllSamples( CPlanarBuffer<_tType> &_pbResult ) const {
+		try {
+			if ( !_pbResult.Resize( m_uiNumChannels, size_t( TotalSamples() ) ) ) { return false; }
+			std::vector<_tType *> vDst( m_uiNumChannels );
+			for ( auto I = m_uiNumChannels; I--; ) {
+				vDst[I] = _pbResult[I].data();
+			}
+			return DecodeAllFrames( vDst.data() );
+		}
+		catch ( ... ) { return false; }
+	}
+
+	/**
+	 * Decodes every frame tile by tile on m_stThreads threads.
+	 *
+	 * \param _pptDst One pointer per channel to where to store the samples.  Each must have room for TotalSamples() samples.
+	 * \return Returns true if every tile was decoded.
+	 */
+	template <typename _tType>
+	bool CWavFile::DecodeAllFrames( _tType * const * _pptDst ) const {
+		// Decode tile by tile, each in a single pass over its interleaved source data.  Tiles are independent, so they are spread over
+		//	m_stThreads threads.
+		uint64_t ui64Total = TotalSamples();
+		std::atomic<bool> aSuccess( true );
+		size_t stTiles = size_t( (ui64Total + PW_D_TILE_FRAMES - 1) / PW_D_TILE_FRAMES );
+		bool bRan = CUtilities::ParallelFor( stTiles, m_stThreads, [&]( size_t _stTile, size_t /*_stWorker*/ ) {
+			uint64_t ui64From = uint64_t( _stTile ) * PW_D_TILE_FRAMES;
+			uint64_t ui64To = std::min<uint64_t>( ui64From + PW_D_TILE_FRAMES, ui64Total );
+			if ( !DecodeFrames( ui64From, ui64To, _pptDst, size_t( ui64From ) ) ) { aSuccess = false; }
+		} );
+		return bRan && aSuccess;
+	}
+
+	/**
+	 * Saves as a PCM or IEEE float WAV file from double or float samples.
+	 *
+	 * \param _pcPath The path to where the file will be saved.
+	 * \param _vSamples The samples to convert and write to the file.  An lwaudio_t or a CPlanarBuffer.
+	 * \param _psdSaveSettings Settings to override this class's settings.
+	 * \return Returns true if the file was created and saved.
+	 */
+	template <typename _tAudio>
+	bool CWavFile::SaveSamples( const char8_t * _pcPath, const _tAudio &_vSamples, const PW_SAVE_DATA * _psdSaveSettings ) const {
+		if ( !_vSamples.size() ) { return false; }
+		size_t stTotal = _vSamples[0].size();
+		// With nothing modified, only the bit depth can differ, and that needs no decoding.
+		if ( m_bTrackDirty && CanConvertSamples( _psdSaveSettings ) && _vSamples.size() == m_uiNumChannels && stTotal == TotalSamples() &&
+			std::all_of( m_vDirty.begin(), m_vDirty.end(), []( const std::vector<PW_RANGE> &_vRanges ) { return _vRanges.empty(); } ) ) {
+			return SaveAsPcmCopy( _pcPath, _psdSaveSettings );
+		}
+		std::u8string sPath = SanitizePath( _pcPath );
+
+		CWavStreamWriter wswWriter;
+		if ( !wswWriter.Create( sPath.c_str(), (*this), static_cast<uint16_t>(_vSamples.size()), _psdSaveSettings, stTotal ) ) {
+			std::wprintf( L"Failed to create PCM file: %s.\r\n", reinterpret_cast<const wchar_t *>(CUtilities::Utf8ToUtf16( sPath.c_str() ).c_str()) );
+			return false;
+		}
+
+		// Encode and write in blocks so that only one block of encoded samples per thread is in memory at a time.
+		size_t stBlock = CWavStreamWriter::PW_D_BLOCK_FRAMES * m_stThreads;
+		if ( !m_bTrackDirty || !CanCopySamples( _psdSaveSettings ) || _vSamples.size() != m_uiNumChannels || stTotal != TotalSamples() ) {
+			for ( size_t I = 0; I < stTotal; I += stBlock ) {
+				if ( !wswWriter.WriteBlock( _vSamples, I, std::min<size_t>( I + stBlock, stTotal ) ) ) { return false; }
+			}
+			return wswWriter.Finalize();
+		}
+
+		// Only the modified ranges are re-encoded.  Everything else is copied from the loaded data, so it comes out exactly as it went
+		//	in and the cost of saving a small edit does not depend on the length of the file.
+		std::vector<PW_RANGE> vSpans;
+		try {
+			for ( auto C = m_vDirty.size(); C--; ) {
+				for ( const auto & rRange : m_vDirty[C] ) {
+					AddRange( vSpans, rRange.stFrom, std::min( rRange.stTo, stTotal ) );
+				}
 			}
-			return true;
 		}
 		catch ( ... ) { return false; }
+
+		size_t stFrameSize = size_t( m_uiNumChannels ) * m_uiBytesPerSample;
+		size_t stPos = 0;
+		std::vector<uint8_t> vOwnEncoded;
+		std::vector<uint8_t> & vEncoded = m_paArena ? m_paArena->vEncoded : vOwnEncoded;
+		for ( const auto & rSpan : vSpans ) {
+			if ( !wswWriter.WriteRaw( m_pui8Samples + stPos * stFrameSize, (rSpan.stFrom - stPos) * stFrameSize ) ) { return false; }
+			for ( size_t I = rSpan.stFrom; I < rSpan.stTo; I += stBlock ) {
+				size_t stTo = std::min<size_t>( I + stBlock, rSpan.stTo );
+				bool bAll = true;
+				for ( uint16_t C = 0; C < m_uiNumChannels && bAll; ++C ) {
+					bAll = ChannelDirty( C, I, stTo );
+				}
+				if ( bAll ) {
+					if ( !wswWriter.WriteBlock( _vSamples, I, stTo ) ) { return false; }
+				}
+				else {
+					vEncoded.clear();
+					if ( !EncodeDirty( _vSamples, I, stTo, vEncoded ) || !wswWriter.WriteRaw( vEncoded.data(), vEncoded.size() ) ) { return false; }
+				}
+			}
+			stPos = rSpan.stTo;
+		}
+		if ( !wswWriter.WriteRaw( m_pui8Samples + stPos * stFrameSize, (stTotal - stPos) * stFrameSize ) ) { return false; }
+		return wswWriter.Finalize();
 	}
 
 	/**
@@ -640,17 +1137,41 @@ namespace pw {
 	}
 
 	/**
-	 * Loads data from the "fmt ".
+	 * Loads data from the "fmt ".  WAVE_FORMAT_EXTENSIBLE chunks load their sub-format into m_fFormat, so their samples go
+	 *	through the same decoders as plain PCM and IEEE float files.
 	 *
 	 * \param _pfcChunk The chunk of data to load
+	 * \param _ui64Size The number of bytes in the chunk after its header.
 	 * \return Returns true if everything loaded fine.
 	 */
-	bool CWavFile::LoadFmt( const PW_FMT_CHUNK * _pfcChunk ) {
+	bool CWavFile::LoadFmt( const PW_FMT_CHUNK * _pfcChunk, uint64_t _ui64Size ) {
 		m_uiNumChannels = _pfcChunk->uiNumChannels;
 		m_uiSampleRate = _pfcChunk->uiSampleRate;
 		m_uiBitsPerSample = _pfcChunk->uiBitsPerSample;
 		m_uiBytesPerSample = m_uiBitsPerSample / 8;
 		m_fFormat = static_cast<PW_FORMAT>(_pfcChunk->uiAudioFormat);
+		m_uiValidBitsPerSample = m_uiBitsPerSample;
+		m_uiChannelMask = 0;
+		m_bExtensible = false;
+		if ( m_fFormat == PW_F_EXTENSIBLE && _ui64Size >= sizeof( PW_FMT_CHUNK ) - sizeof( PW_CHUNK_HEADER ) &&
+			_pfcChunk->uiExtraParamSize >= sizeof( PW_FMT_CHUNK ) - offsetof( PW_FMT_CHUNK, uiValidBitsPerSample ) ) {
+			// Only sub-formats with a format code in front of the standard GUID tail map onto a PW_FORMAT.  Others stay
+			//	PW_F_EXTENSIBLE and are not decoded.
+			if ( std::memcmp( &_pfcChunk->ui8SubFormat[2], m_ui8SubFormatBase, sizeof( m_ui8SubFormatBase ) ) == 0 ) {
+				m_fFormat = static_cast<PW_FORMAT>(_pfcChunk->ui8SubFormat[0] | (_pfcChunk->ui8SubFormat[1] << 8));
+			}
+			// 0 means the writer did not say, in which case every bit is valid.
+			if ( _pfcChunk->uiValidBitsPerSample && _pfcChunk->uiValidBitsPerSample <= m_uiBitsPerSample ) {
+				m_uiValidBitsPerSample = _pfcChunk->uiValidBitsPerSample;
+			}
+			m_uiChannelMask = _pfcChunk->uiChannelMask;
+			m_bExtensible = true;
+		}
+		// The layout is fixed from here on, so the decoders are selected once rather than on every call.
+		m_dDecoders = CSampleConverter::PW_DECODERS();
+		if ( m_fFormat == PW_F_PCM || m_fFormat == PW_F_IEEE_FLOAT ) {
+			m_dDecoders = CSampleConverter::Decoders( m_fFormat == PW_F_IEEE_FLOAT, m_uiBitsPerSample, m_uiNumChannels );
+		}
 		return true;
 	}
 
@@ -658,12 +1179,25 @@ namespace pw {
 	 * Loads the "data" chunk.
 	 *
 	 * \param _pdcChunk The chunk of data to load
+	 * \param _ui64Size The size of the sample data, which comes from the "ds64" chunk in RF64 files.
+	 * \param _bCopySamples If true, the samples are copied into m_vSamples, otherwise they are referenced in-place.
 	 * \return Returns true if everything loaded fine.
 	 */
-	bool CWavFile::LoadData( const PW_DATA_CHUNK * _pdcChunk ) {
-		m_vSamples.resize( _pdcChunk->chHeader.uiSize );
-		if ( m_vSamples.size() != _pdcChunk->chHeader.uiSize ) { return false; }
+	bool CWavFile::LoadData( const PW_DATA_CHUNK * _pdcChunk, uint64_t _ui64Size, bool _bCopySamples ) {
+		if ( !_bCopySamples ) {
+			m_vSamples.clear();
+			m_pui8Samples = _pdcChunk->ui8Data;
+			m_stSamplesSize = size_t( _ui64Size );
+			return true;
+		}
+		try {
+			m_vSamples.resize( size_t( _ui64Size ) );
+		}
+		catch ( ... ) { return false; }
+		if ( m_vSamples.size() != _ui64Size ) { return false; }
 		std::memcpy( m_vSamples.data(), _pdcChunk->ui8Data, m_vSamples.size() );
+		m_pui8Samples = m_vSamples.data();
+		m_stSamplesSize = m_vSamples.size();
 		return true;
 	}
 
@@ -676,7 +1210,7 @@ namespace pw {
 	bool CWavFile::LoadSmpl( const PW_SMPL_CHUNK * _pscChunk ) {
 		m_uiBaseNote = _pscChunk->uiMIDIUnityNote;
 		for ( size_t I = 0; I < _pscChunk->uiNumSampleLoops; ++I ) {
-			if ( _pscChunk->lpLoops[I].uiStart < m_vSamples.size() && _pscChunk->lpLoops[I].uiEnd < m_vSamples.size() ) {
+			if ( _pscChunk->lpLoops[I].uiStart < m_stSamplesSize && _pscChunk->lpLoops[I].uiEnd < m_stSamplesSize ) {
 				m_vLoops.push_back( _pscChunk->lpLoops[I] );
 			}
 		}
@@ -774,254 +1308,191 @@ namespace pw {
 	}
 
 	/**
-	 * Converts a bunch of 8-bit PCM samples to double.
+	 * Converts a batch of F64 samples to PCM samples.
 	 *
-	 * \param _ui32From Starting sample index.
-	 * \param _ui32To Ending sample index.
-	 * \param _uiChan The channel whose sample data is to be obtained.
-	 * \param _vResult The vector containing the samples.
-	 * \return Returns true if the vector was able to hold all of the values.
+	 * \param _ppdSrc One pointer per channel to the samples to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _stFrom The index of the first frame to convert.
+	 * \param _stTo The index of the frame after the last frame to convert.
+	 * \param _vDst The buffer to which to convert the samples.
+	 * \return Returns trye if all samples were added to the buffer.
 	 */
-	bool CWavFile::Pcm8ToF64( uint32_t _ui32From, uint32_t _ui32To, uint16_t _uiChan, lwtrack &_vResult ) const {
-		size_t sFinalSize = _vResult.size() + (_ui32To - _ui32From);
-		_vResult.reserve( sFinalSize );
-		uint32_t uiStride;
-		size_t sIdx = CalcOffsetsForSample( _uiChan, _ui32From, uiStride );
-		const int8_t * pi8Samples = reinterpret_cast<const int8_t *>(&m_vSamples.data()[sIdx]);
-		while ( _ui32From < _ui32To ) {
-			_vResult.push_back( (static_cast<int32_t>((*pi8Samples)) - 128) / 127.0 );
-
-			pi8Samples += m_uiNumChannels;
-			++_ui32From;
+	bool CWavFile::BatchF64ToPcm8( const double * const * _ppdSrc, uint16_t _uiChannels, size_t _stFrom, size_t _stTo, std::vector<uint8_t> &_vDst ) {
+		try {
+			size_t stOffset = _vDst.size();
+			_vDst.resize( stOffset + (_stTo - _stFrom) * _uiChannels * sizeof( uint8_t ) );
+			CSampleConverter::F64ToPcm8( _ppdSrc, _stFrom, _stTo - _stFrom, _uiChannels, _vDst.data() + stOffset );
+			return true;
 		}
-		return true;
+		catch ( ... ) { return false; }
 	}
 
 	/**
-	 * Converts a bunch of 16-bit PCM samples to double.
+	 * Converts a batch of F64 samples to PCM samples.
 	 *
-	 * \param _ui32From Starting sample index.
-	 * \param _ui32To Ending sample index.
-	 * \param _uiChan The channel whose sample data is to be obtained.
-	 * \param _vResult The vector containing the samples.
-	 * \return Returns true if the vector was able to hold all of the values.
+	 * \param _ppdSrc One pointer per channel to the samples to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _stFrom The index of the first frame to convert.
+	 * \param _stTo The index of the frame after the last frame to convert.
+	 * \param _vDst The buffer to which to convert the samples.
+	 * \return Returns trye if all samples were added to the buffer.
 	 */
-	bool CWavFile::Pcm16ToF64( uint32_t _ui32From, uint32_t _ui32To, uint16_t _uiChan, lwtrack &_vResult ) const {
-		const double dFactor = std::pow( 2.0, 16.0 - 1.0 ) - 1.0;
-		size_t sFinalSize = _vResult.size() + (_ui32To - _ui32From);
-		_vResult.reserve( sFinalSize );
-		uint32_t uiStride;
-		size_t sIdx = CalcOffsetsForSample( _uiChan, _ui32From, uiStride );
-		const int16_t * pi16Samples = reinterpret_cast<const int16_t *>(&m_vSamples.data()[sIdx]);
-		while ( _ui32From < _ui32To ) {
-			_vResult.push_back( (*pi16Samples) / dFactor );
-
-			pi16Samples += m_uiNumChannels;
-			++_ui32From;
+	bool CWavFile::BatchF64ToPcm16( const double * const * _ppdSrc, uint16_t _uiChannels, size_t _stFrom, size_t _stTo, std::vector<uint8_t> &_vDst ) {
+		try {
+			size_t stOffset = _vDst.size();
+			_vDst.resize( stOffset + (_stTo - _stFrom) * _uiChannels * sizeof( int16_t ) );
+			CSampleConverter::F64ToPcm16( _ppdSrc, _stFrom, _stTo - _stFrom, _uiChannels, _vDst.data() + stOffset );
+			return true;
 		}
-		return true;
+		catch ( ... ) { return false; }
 	}
 
 	/**
-	 * Converts a bunch of 24-bit PCM samples to double.
+	 * Converts a batch of F64 samples to PCM samples.
 	 *
-	 * \param _ui32From Starting sample index.
-	 * \param _ui32To Ending sample index.
-	 * \param _uiChan The channel whose sample data is to be obtained.
-	 * \param _vResult The vector containing the samples.
-	 * \return Returns true if the vector was able to hold all of the values.
+	 * \param _ppdSrc One pointer per channel to the samples to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _stFrom The index of the first frame to convert.
+	 * \param _stTo The index of the frame after the last frame to convert.
+	 * \param _vDst The buffer to which to convert the samples.
+	 * \return Returns trye if all samples were added to the buffer.
 	 */
-	bool CWavFile::Pcm24ToF64( uint32_t _ui32From, uint32_t _ui32To, uint16_t _uiChan, lwtrack &_vResult ) const {
-		const double dFactor = (std::pow( 2.0, 24.0 - 1.0 ) - 1.0) * 256.0;
-		size_t sFinalSize = _vResult.size() + (_ui32To - _ui32From);
-		_vResult.reserve( sFinalSize );
-		uint32_t uiStride;
-		size_t sIdx = CalcOffsetsForSample( _uiChan, _ui32From, uiStride );
-		while ( _ui32From < _ui32To ) {
-			if ( sIdx >= m_vSamples.size() ) {
-				_vResult.push_back( 0.0 );
-			}
-			else {
-				const int32_t * pi32Samples = reinterpret_cast<const int32_t *>(&m_vSamples.data()[sIdx]);
-
-				_vResult.push_back( ((*pi32Samples) << 8) / dFactor );
-			}
-
-			sIdx += uiStride;
-			++_ui32From;
+	bool CWavFile::BatchF64ToPcm24( const double * const * _ppdSrc, uint16_t _uiChannels, size_t _stFrom, size_t _stTo, std::vector<uint8_t> &_vDst ) {
+		try {
+			size_t stOffset = _vDst.size();
+			_vDst.resize( stOffset + (_stTo - _stFrom) * _uiChannels * 3 );
+			CSampleConverter::F64ToPcm24( _ppdSrc, _stFrom, _stTo - _stFrom, _uiChannels, _vDst.data() + stOffset );
+			return true;
 		}
-		return true;
+		catch ( ... ) { return false; }
 	}
 
 	/**
-	 * Converts a bunch of 32-bit PCM samples to double.
+	 * Converts a batch of F64 samples to PCM samples.
 	 *
-	 * \param _ui32From Starting sample index.
-	 * \param _ui32To Ending sample index.
-	 * \param _uiChan The channel whose sample data is to be obtained.
-	 * \param _vResult The vector containing the samples.
-	 * \return Returns true if the vector was able to hold all of the values.
+	 * \param _ppdSrc One pointer per channel to the samples to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _stFrom The index of the first frame to convert.
+	 * \param _stTo The index of the frame after the last frame to convert.
+	 * \param _vDst The buffer to which to convert the samples.
+	 * \return Returns trye if all samples were added to the buffer.
 	 */
-	bool CWavFile::Pcm32ToF64( uint32_t _ui32From, uint32_t _ui32To, uint16_t _uiChan, lwtrack &_vResult ) const {
-		const double dFactor = std::pow( 2.0, 32.0 - 1.0 ) - 1.0;
-		size_t sFinalSize = _vResult.size() + (_ui32To - _ui32From);
-		_vResult.reserve( sFinalSize );
-		uint32_t uiStride;
-		size_t sIdx = CalcOffsetsForSample( _uiChan, _ui32From, uiStride );
-		const int32_t * pi32Samples = reinterpret_cast<const int32_t *>(&m_vSamples.data()[sIdx]);
-		while ( _ui32From < _ui32To ) {
-			_vResult.push_back( (*pi32Samples) / dFactor );
-
-			pi32Samples += m_uiNumChannels;
-			++_ui32From;
+	bool CWavFile::BatchF64ToPcm32( const double * const * _ppdSrc, uint16_t _uiChannels, size_t _stFrom, size_t _stTo, std::vector<uint8_t> &_vDst ) {
+		try {
+			size_t stOffset = _vDst.size();
+			_vDst.resize( stOffset + (_stTo - _stFrom) * _uiChannels * sizeof( int32_t ) );
+			CSampleConverter::F64ToPcm32( _ppdSrc, _stFrom, _stTo - _stFrom, _uiChannels, _vDst.data() + stOffset );
+			return true;
 		}
-		return true;
+		catch ( ... ) { return false; }
 	}
 
 	/**
-	 * Converts a bunch of 32-bit float samples to double.
+	 * Converts a batch of F64 samples to 32-bit float samples.
 	 *
-	 * \param _ui32From Starting sample index.
-	 * \param _ui32To Ending sample index.
-	 * \param _uiChan The channel whose sample data is to be obtained.
-	 * \param _vResult The vector containing the samples.
-	 * \return Returns true if the vector was able to hold all of the values.
+	 * \param _ppdSrc One pointer per channel to the samples to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _stFrom The index of the first frame to convert.
+	 * \param _stTo The index of the frame after the last frame to convert.
+	 * \param _vDst The buffer to which to convert the samples.
+	 * \return Returns true if all samples were added to the buffer.
 	 */
-	bool CWavFile::F32ToF64( uint32_t _ui32From, uint32_t _ui32To, uint16_t _uiChan, lwtrack &_vResult ) const {
-		size_t sFinalSize = _vResult.size() + (_ui32To - _ui32From);
-		_vResult.reserve( sFinalSize );
-		uint32_t uiStride;
-		size_t sIdx = CalcOffsetsForSample( _uiChan, _ui32From, uiStride );
-		const float * pfSamples = reinterpret_cast<const float *>(&m_vSamples.data()[sIdx]);
-		while ( _ui32From < _ui32To ) {
-			_vResult.push_back( (*pfSamples) );
-
-			pfSamples += m_uiNumChannels;
-			++_ui32From;
+	bool CWavFile::BatchF64ToFloat32( const double * const * _ppdSrc, uint16_t _uiChannels, size_t _stFrom, size_t _stTo, std::vector<uint8_t> &_vDst ) {
+		try {
+			size_t stOffset = _vDst.size();
+			_vDst.resize( stOffset + (_stTo - _stFrom) * _uiChannels * sizeof( float ) );
+			CSampleConverter::F64ToFloat32( _ppdSrc, _stFrom, _stTo - _stFrom, _uiChannels, _vDst.data() + stOffset );
+			return true;
 		}
-		return true;
+		catch ( ... ) { return false; }
 	}
 
 	/**
-	 * Converts a batch of F64 samples to PCM samples.
+	 * Converts a batch of F64 samples to 64-bit float samples.
 	 *
-	 * \param _vSrc The samples to convert.
+	 * \param _ppdSrc One pointer per channel to the samples to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _stFrom The index of the first frame to convert.
+	 * \param _stTo The index of the frame after the last frame to convert.
 	 * \param _vDst The buffer to which to convert the samples.
-	 * \return Returns trye if all samples were added to the buffer.
+	 * \return Returns true if all samples were added to the buffer.
 	 */
-	bool CWavFile::BatchF64ToPcm8( const lwaudio &_vSrc, std::vector<uint8_t> &_vDst ) {
-		for ( size_t I = 0; I < _vSrc[0].size(); ++I ) {
-			for ( size_t J = 0; J < _vSrc.size(); ++J ) {
-				int8_t iSample = static_cast<int8_t>(std::round( std::clamp( _vSrc[J][I], -1.0, 1.0 ) * 127.0 + 128.0 ));
-				_vDst.push_back( static_cast<uint8_t>(iSample) );
-			}
+	bool CWavFile::BatchF64ToFloat64( const double * const * _ppdSrc, uint16_t _uiChannels, size_t _stFrom, size_t _stTo, std::vector<uint8_t> &_vDst ) {
+		try {
+			size_t stOffset = _vDst.size();
+			_vDst.resize( stOffset + (_stTo - _stFrom) * _uiChannels * sizeof( double ) );
+			CSampleConverter::F64ToFloat64( _ppdSrc, _stFrom, _stTo - _stFrom, _uiChannels, _vDst.data() + stOffset );
+			return true;
 		}
-		return true;
+		catch ( ... ) { return false; }
 	}
 
 	/**
-	 * Converts a batch of F64 samples to PCM samples.
+	 * Converts a batch of F32 samples to PCM or float samples.  A block at a time is widened to double, which is exact, and encoded
+	 *	with the double encoders, so the result is the same as encoding the same values held as doubles.
 	 *
-	 * \param _vSrc The samples to convert.
+	 * \param _ppfSrc One pointer per channel to the samples to convert.
+	 * \param _uiChannels The number of channels.
+	 * \param _stFrom The index of the first frame to convert.
+	 * \param _stTo The index of the frame after the last frame to convert.
+	 * \param _fFormat The output format.  PW_F_PCM or PW_F_IEEE_FLOAT.
+	 * \param _uiBits The bits per output sample.  8, 16, 24, or 32 for PCM; 32 or 64 for float.
 	 * \param _vDst The buffer to which to convert the samples.
-	 * \return Returns trye if all samples were added to the buffer.
+	 * \return Returns true if all samples were added to the buffer.
 	 */
-	bool CWavFile::BatchF64ToPcm16( const lwaudio &_vSrc, std::vector<uint8_t> &_vDst ) {
-		try {
-			const double dFactor = std::pow( 2.0, 16.0 - 1.0 ) - 1.0;
-			auto stNumSamples = _vSrc[0].size();
-			auto stNumChannels = _vSrc.size();
-			auto aSize = _vDst.size();
-			_vDst.reserve( _vDst.size() + stNumSamples * stNumChannels * sizeof( int16_t ) );
-			int16_t * pi16Dst = reinterpret_cast<int16_t *>(_vDst.data() + aSize);
-
-#ifdef __AVX512BW__
-			if ( CUtilities::IsAvx512BWSupported() ) {
-				// Constants for AVX-512 operations
-				__m512d vdFactor = _mm512_set1_pd( dFactor );
-				__m512d vdMin = _mm512_set1_pd( -1.0 );
-				__m512d vdMax = _mm512_set1_pd( 1.0 );
-				std::vector<std::vector<uint16_t>, CAlignmentAllocator<std::vector<uint16_t>, 64>> vSamples;
-				vSamples.resize( stNumChannels );
-				for ( auto I = stNumChannels; I--; ) {
-					vSamples[I].resize( stNumSamples );
-				}
-				
-				for ( auto C = stNumChannels; C--; ) {
-					lwaudio::size_type stIdx = 0;
-					while ( stIdx < stNumSamples - (8 - 1) ) {
-						__m512d vdSamples = _mm512_load_pd( &_vSrc[C][stIdx] );
-
-						// Clamp samples between -1.0 and 1.0.
-						vdSamples = _mm512_max_pd( vdSamples, vdMin );
-						vdSamples = _mm512_min_pd( vdSamples, vdMax );
-
-						// Multiply by scaling factor.
-						vdSamples = _mm512_mul_pd( vdSamples, vdFactor );
-
-						// Round to nearest integer and convert to int32_t
-						__m256i viInt32 = _mm512_cvt_roundpd_epi32( vdSamples, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC );
-
-						// Convert int32_t to int16_t with saturation
-						__m128i viInt16 = _mm256_cvtsepi32_epi16( viInt32 );
-
-						_mm_store_si128( reinterpret_cast<__m128i *>(&vSamples[C][stIdx]), viInt16 );
-
-
-						stIdx += sizeof( __m512d ) / sizeof( double );
-					}
-
-					while ( stIdx < stNumSamples ) {
-						vSamples[C][stIdx++] = static_cast<int16_t>(std::round( std::clamp( _vSrc[C][stIdx], -1.0, 1.0 ) * dFactor ));
-					}
+	bool CWavFile::BatchF32Encode( const float * const * _ppfSrc, uint16_t _uiChannels, size_t _stFrom, size_t _stTo, PW_FORMAT _fFormat, uint16_t _uiBits, std::vector<uint8_t> &_vDst ) {
+		void (* pfEncode)( const double * const *, size_t, size_t, uint16_t, uint8_t * ) = nullptr;
+		if ( _fFormat == PW_F_IEEE_FLOAT ) {
+			switch ( _uiBits ) {
+				case 32 : {
+					pfEncode = CSampleConverter::F64ToFloat32;
+					break;
 				}
-
-				for ( size_t I = 0; I < _vSrc[0].size(); ++I ) {
-					for ( size_t J = 0; J < _vSrc.size(); ++J ) {
-						(*pi16Dst++) = vSamples[J][I];
-					}
+				case 64 : {
+					pfEncode = CSampleConverter::F64ToFloat64;
+					break;
 				}
-
-				return true;
+				default : { return false; }
 			}
-#endif	// #ifdef __AVX512BW__
-
-			for ( size_t I = 0; I < _vSrc[0].size(); ++I ) {
-				for ( size_t J = 0; J < _vSrc.size(); ++J ) {
-					(*pi16Dst++) = static_cast<int16_t>(std::round( std::clamp( _vSrc[J][I], -1.0, 1.0 ) * dFactor ));
+		}
+		else {
+			switch ( _uiBits ) {
+				case 8 : {
+					pfEncode = CSampleConverter::F64ToPcm8;
+					break;
+				}
+				case 16 : {
+					pfEncode = CSampleConverter::F64ToPcm16;
+					break;
+				}
+				case 24 : {
+					pfEncode = CSampleConverter::F64ToPcm24;
+					break;
+				}
+				case 32 : {
+					pfEncode = CSampleConverter::F64ToPcm32;
+					break;
 				}
+				default : { return false; }
 			}
-			return true;
 		}
-		catch ( ... ) { return false; }
-	}
-
-	/**
-	 * Converts a batch of F64 samples to PCM samples.
-	 *
-	 * \param _vSrc The samples to convert.
-	 * \param _vDst The buffer to which to convert the samples.
-	 * \return Returns trye if all samples were added to the buffer.
-	 */
-	bool CWavFile::BatchF64ToPcm24( const lwaudio &_vSrc, std::vector<uint8_t> &_vDst ) {
 		try {
-			const double dFactor = std::pow( 2.0, 24.0 - 1.0 ) - 1.0;
-			auto stNumSamples = _vSrc[0].size();
-			auto stNumChannels = _vSrc.size();
-			auto aSize = _vDst.size();
-			_vDst.resize( _vDst.size() + stNumSamples * stNumChannels * 3 );
-			int8_t * pi8Dst = reinterpret_cast<int8_t *>(_vDst.data() + aSize);
-
-			for ( size_t I = 0; I < _vSrc[0].size(); ++I ) {
-				for ( size_t J = 0; J < _vSrc.size(); ++J ) {
-					int32_t iSample = static_cast<int32_t>(std::round( std::clamp( _vSrc[J][I], -1.0, 1.0 ) * dFactor ));
-					(*pi8Dst++) = static_cast<uint8_t>(iSample);
-					(*pi8Dst++) = static_cast<uint8_t>(iSample >> 8);
-					(*pi8Dst++) = static_cast<uint8_t>(iSample >> 16);
-					/*_vDst.push_back( static_cast<uint8_t>(iSample) );
-					_vDst.push_back( static_cast<uint8_t>(iSample >> 8) );
-					_vDst.push_back( static_cast<uint8_t>(iSample >> 16) );*/
+			const size_t stChannels = _uiChannels;
+			if ( !stChannels ) { return _stFrom == _stTo; }
+			const size_t stBlock = std::max<size_t>( CSampleConverter::PW_D_BLOCK_SAMPLES / stChannels, 1 );
+			lwtrack vStage( std::min( stBlock, _stTo - _stFrom ) * stChannels );
+			std::vector<const double *> vSrc( stChannels );
+			size_t stOffset = _vDst.size();
+			_vDst.resize( stOffset + (_stTo - _stFrom) * stChannels * (_uiBits / 8) );
+			for ( size_t I = _stFrom; I < _stTo; I += stBlock ) {
+				size_t stFrames = std::min( stBlock, _stTo - I );
+				for ( size_t C = 0; C < stChannels; ++C ) {
+					double * pdStage = vStage.data() + C * stFrames;
+					const float * pfSrc = _ppfSrc[C] + I;
+					for ( size_t J = 0; J < stFrames; ++J ) { pdStage[J] = pfSrc[J]; }
+					vSrc[C] = pdStage;
 				}
+				pfEncode( vSrc.data(), 0, stFrames, static_cast<uint16_t>(stChannels), _vDst.data() + stOffset + (I - _stFrom) * stChannels * (_uiBits / 8) );
 			}
 			return true;
 		}
@@ -1029,91 +1500,131 @@ namespace pw {
 	}
 
 	/**
-	 * Converts a batch of F64 samples to PCM samples.
+	 * Encodes a range of frames in the loaded format, then copies the samples of every channel that were not modified in the
+	 *	range back from the loaded data.
 	 *
-	 * \param _vSrc The samples to convert.
-	 * \param _vDst The buffer to which to convert the samples.
-	 * \return Returns trye if all samples were added to the buffer.
+	 * \param _vSrc The samples to encode.  An lwaudio_t or a CPlanarBuffer with one channel per channel of the loaded file.
+	 * \param _stFrom The index of the first frame to encode.
+	 * \param _stTo The index of the frame after the last frame to encode.
+	 * \param _vDst The buffer to which to append the encoded frames.
+	 * \return Returns true if the frames were encoded.
 	 */
-	bool CWavFile::BatchF64ToPcm32( const lwaudio &_vSrc, std::vector<uint8_t> &_vDst ) {
+	template <typename _tAudio>
+	bool CWavFile::EncodeDirty( const _tAudio &_vSrc, size_t _stFrom, size_t _stTo, std::vector<uint8_t> &_vDst ) const {
+		size_t stOffset = _vDst.size();
+		bool bEncoded = false;
+		std::vector<const typename _tAudio::value_type::value_type *> vSrc;
 		try {
-			const double dFactor = std::pow( 2.0, 32.0 - 1.0 ) - 1.0;
-			auto stNumSamples = _vSrc[0].size();
-			auto stNumChannels = _vSrc.size();
-			auto aSize = _vDst.size();
-			_vDst.resize( _vDst.size() + stNumSamples * stNumChannels * sizeof( int32_t ) );
-			int32_t * pi32Dst = reinterpret_cast<int32_t *>(_vDst.data() + aSize);
-
-#ifdef __AVX512BW__
-			if ( CUtilities::IsAvx512BWSupported() ) {
-				// Constants for AVX-512 operations
-				__m512d vdFactor = _mm512_set1_pd( dFactor );
-				__m512d vdMin = _mm512_set1_pd( -1.0 );
-				__m512d vdMax = _mm512_set1_pd( 1.0 );
-				std::vector<std::vector<uint32_t>, CAlignmentAllocator<std::vector<uint32_t>, 64>> vSamples;
-				vSamples.resize( stNumChannels );
-				for ( auto I = stNumChannels; I--; ) {
-					vSamples[I].resize( stNumSamples );
+			vSrc = ChannelData( _vSrc );
+		}
+		catch ( ... ) { return false; }
+		const uint16_t uiChannels = static_cast<uint16_t>(vSrc.size());
+		if constexpr ( std::is_same_v<typename _tAudio::value_type::value_type, float> ) {
+			bEncoded = BatchF32Encode( vSrc.data(), uiChannels, _stFrom, _stTo, m_fFormat, m_uiBitsPerSample, _vDst );
+		}
+		else if ( m_fFormat == PW_F_IEEE_FLOAT ) {
+			switch ( m_uiBitsPerSample ) {
+				case 32 : {
+					bEncoded = BatchF64ToFloat32( vSrc.data(), uiChannels, _stFrom, _stTo, _vDst );
+					break;
 				}
-				
-				for ( auto C = stNumChannels; C--; ) {
-					lwaudio::size_type stIdx = 0;
-					while ( stIdx < stNumSamples - (8 - 1) ) {
-						__m512d vdSamples = _mm512_load_pd( &_vSrc[C][stIdx] );
-
-						// Clamp samples between -1.0 and 1.0.
-						vdSamples = _mm512_max_pd( vdSamples, vdMin );
-						vdSamples = _mm512_min_pd( vdSamples, vdMax );
-
-						// Multiply by scaling factor.
-						vdSamples = _mm512_mul_pd( vdSamples, vdFactor );
-
-						// Round to nearest integer and convert to int32_t
-						__m256i viInt32 = _mm512_cvt_roundpd_epi32( vdSamples, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC );
-
-						// Store the int32_t samples.
-						_mm256_store_si256( reinterpret_cast<__m256i*>(&vSamples[C][stIdx]), viInt32 );
-
-
-						stIdx += sizeof( __m512d ) / sizeof( double );
-					}
-
-					while ( stIdx < stNumSamples ) {
-						vSamples[C][stIdx++] = static_cast<int32_t>(std::round( std::clamp( _vSrc[C][stIdx], -1.0, 1.0 ) * dFactor ));
-					}
+				case 64 : {
+					bEncoded = BatchF64ToFloat64( vSrc.data(), uiChannels, _stFrom, _stTo, _vDst );
+					break;
 				}
-
-				for ( size_t I = 0; I < _vSrc[0].size(); ++I ) {
-					for ( size_t J = 0; J < _vSrc.size(); ++J ) {
-						(*pi32Dst++) = vSamples[J][I];
-					}
+			}
+		}
+		else {
+			switch ( m_uiBitsPerSample ) {
+				case 8 : {
+					bEncoded = BatchF64ToPcm8( vSrc.data(), uiChannels, _stFrom, _stTo, _vDst );
+					break;
+				}
+				case 16 : {
+					bEncoded = BatchF64ToPcm16( vSrc.data(), uiChannels, _stFrom, _stTo, _vDst );
+					break;
+				}
+				case 24 : {
+					bEncoded = BatchF64ToPcm24( vSrc.data(), uiChannels, _stFrom, _stTo, _vDst );
+					break;
+				}
+				case 32 : {
+					bEncoded = BatchF64ToPcm32( vSrc.data(), uiChannels, _stFrom, _stTo, _vDst );
+					break;
 				}
-
-				return true;
 			}
-#endif	// #ifdef __AVX512BW__
-
-			for ( size_t I = 0; I < _vSrc[0].size(); ++I ) {
-				for ( size_t J = 0; J < _vSrc.size(); ++J ) {
-					(*pi32Dst++) = static_cast<int32_t>(std::round( std::clamp( _vSrc[J][I], -1.0, 1.0 ) * dFactor ));
+		}
+		if ( !bEncoded ) { return false; }
+
+		size_t stFrameSize = size_t( m_uiNumChannels ) * m_uiBytesPerSample;
+		for ( uint16_t C = 0; C < m_uiNumChannels; ++C ) {
+			// Walk the gaps between this channel's modified ranges that fall inside [_stFrom,_stTo).
+			const std::vector<PW_RANGE> & vRanges = m_vDirty[C];
+			auto aIt = std::upper_bound( vRanges.begin(), vRanges.end(), _stFrom, []( size_t _stVal, const PW_RANGE &_rRange ) { return _stVal < _rRange.stTo; } );
+			size_t stPos = _stFrom;
+			while ( stPos < _stTo ) {
+				size_t stEnd = (aIt == vRanges.end()) ? _stTo : std::min( std::max( aIt->stFrom, stPos ), _stTo );
+				size_t stByte = size_t( C ) * m_uiBytesPerSample;
+				for ( size_t I = stPos; I < stEnd; ++I ) {
+					std::memcpy( _vDst.data() + stOffset + (I - _stFrom) * stFrameSize + stByte, m_pui8Samples + I * stFrameSize + stByte, m_uiBytesPerSample );
 				}
+				if ( aIt == vRanges.end() ) { break; }
+				stPos = std::max( aIt->stTo, stPos );
+				++aIt;
 			}
-			return true;
 		}
-		catch ( ... ) { return false; }
+		return true;
+	}
+
+	/**
+	 * Determines whether a channel was modified over the whole of a range.
+	 *
+	 * \param _uiChan The channel to check.
+	 * \param _stFrom The first frame in the range.
+	 * \param _stTo The frame after the last frame in the range.
+	 * \return Returns true if every frame in the range is inside one of the channel's modified ranges.
+	 */
+	bool CWavFile::ChannelDirty( uint16_t _uiChan, size_t _stFrom, size_t _stTo ) const {
+		if ( !m_bTrackDirty ) { return true; }
+		if ( _uiChan >= m_vDirty.size() ) { return false; }
+		// Ranges are merged when added, so a range covering all of [_stFrom,_stTo) must be the first one ending after _stFrom.
+		const std::vector<PW_RANGE> & vRanges = m_vDirty[_uiChan];
+		auto aIt = std::upper_bound( vRanges.begin(), vRanges.end(), _stFrom, []( size_t _stVal, const PW_RANGE &_rRange ) { return _stVal < _rRange.stTo; } );
+		return aIt != vRanges.end() && aIt->stFrom <= _stFrom && aIt->stTo >= _stTo;
+	}
+
+	/**
+	 * Adds a range to a sorted, non-overlapping list of ranges, merging it with any ranges it overlaps or touches.
+	 *
+	 * \param _vRanges The list of ranges to which to add the range.
+	 * \param _stFrom The first frame in the range.
+	 * \param _stTo The frame after the last frame in the range.
+	 */
+	void CWavFile::AddRange( std::vector<PW_RANGE> &_vRanges, size_t _stFrom, size_t _stTo ) {
+		if ( _stFrom >= _stTo ) { return; }
+		// The first range that ends at or after _stFrom and the first that starts after _stTo bound the ranges to merge.
+		auto aFirst = std::lower_bound( _vRanges.begin(), _vRanges.end(), _stFrom, []( const PW_RANGE &_rRange, size_t _stVal ) { return _rRange.stTo < _stVal; } );
+		auto aLast = std::upper_bound( aFirst, _vRanges.end(), _stTo, []( size_t _stVal, const PW_RANGE &_rRange ) { return _stVal < _rRange.stFrom; } );
+		if ( aFirst == aLast ) {
+			_vRanges.insert( aFirst, PW_RANGE{ _stFrom, _stTo } );
+			return;
+		}
+		aFirst->stFrom = std::min( aFirst->stFrom, _stFrom );
+		aFirst->stTo = std::max( (aLast - 1)->stTo, _stTo );
+		_vRanges.erase( aFirst + 1, aLast );
 	}
 
 	/**
 	 * Gets the byte indices of PCM data given an offset and channel.
 	 *
 	 * \param _uiChan The channel.
-	 * \param _uiIdx The sample index.
+	 * \param _ui64Idx The sample index.
 	 * \param _uiStride The returned stride.
 	 * \return Returns the byte index calculated using the given information and the sample depth.
 	 */
-	size_t CWavFile::CalcOffsetsForSample( uint16_t _uiChan, uint32_t _uiIdx, uint32_t &_uiStride ) const {
+	size_t CWavFile::CalcOffsetsForSample( uint16_t _uiChan, uint64_t _ui64Idx, uint32_t &_uiStride ) const {
 		_uiStride = m_uiNumChannels * m_uiBytesPerSample;
-		return _uiStride * _uiIdx + (_uiChan * m_uiBytesPerSample);
+		return size_t( uint64_t( _uiStride ) * _ui64Idx + (_uiChan * m_uiBytesPerSample) );
 	}
 
 	/**
@@ -1130,7 +1641,43 @@ namespace pw {
 	}
 
 	/**
-	 * Creates an "fmt " chunk based off either this object's parameters or optional given overrides.
+	 * Replaces characters that are not allowed in file names with look-alikes.  Only the file-name part of the path is changed.
+	 *
+	 * \param _pcPath The path to sanitize.
+	 * \return Returns the sanitized path.
+	 */
+	std::u8string CWavFile::SanitizePath( const char8_t * _pcPath ) {
+		std::u8string sPath = _pcPath;
+		std::u8string sFolder = CFileBase::GetFilePath( sPath );
+		std::u8string sName = CFileBase::GetFileName( sPath );
+		
+
+		std::u8string sCopy = sName;
+		const struct PW_TABLE {
+			const char8_t *					pcReplaceMe;
+			const char8_t *					pcWithMe;
+		} tTable[] = {
+			{ u8"?", u8"-" },
+			{ u8"*", u8"˙" },
+			{ u8":", u8" -" },
+			{ u8"\\", u8"-" },
+			{ u8"/", u8"∕" },
+			{ u8"<", u8"‹" },
+			{ u8">", u8"›" },
+			{ u8"|", u8"¦" },
+			{ u8"\"", u8"‟" },
+		};
+		for ( auto I = sizeof( tTable ) / sizeof( tTable[0] ); I--; ) {
+			sCopy = CUtilities::Replace<std::u8string>( sCopy, reinterpret_cast<const char8_t *>(tTable[I].pcReplaceMe), reinterpret_cast<const char8_t *>(tTable[I].pcWithMe) );
+		};
+
+		return sFolder + sCopy;
+	}
+
+	/**
+	 * Creates an "fmt " chunk based off either this object's parameters or optional given overrides.  The chunk is
+	 *	WAVE_FORMAT_EXTENSIBLE, with _fFormat as its sub-format, if this file was loaded from one or if the overrides give a
+	 *	channel mask.
 	 *
 	 * \param _fFormat The format to set.
 	 * \param _uiChannels The total channels.
@@ -1140,14 +1687,30 @@ namespace pw {
 	CWavFile::PW_FMT_CHUNK CWavFile::CreateFmt( PW_FORMAT _fFormat, uint16_t _uiChannels, const PW_SAVE_DATA * _psdSaveSettings ) const {
 		PW_FMT_CHUNK fcChunk = { 0 };
 		fcChunk.chHeader.u.uiId = PW_C_FMT_;
-		fcChunk.chHeader.uiSize = 16;
+		// Formats other than PCM must have the extension size, even when it is 0.
+		fcChunk.chHeader.uiSize = _fFormat == PW_F_PCM ? 16 : 18;
 		fcChunk.uiAudioFormat = _fFormat;
-		fcChunk.uiBitsPerSample = (_psdSaveSettings && _psdSaveSettings->uiBitsPerSample) ? _psdSaveSettings->uiBitsPerSample : BitsPerSample();
+		fcChunk.uiBitsPerSample = OutputBits( _psdSaveSettings );
 		fcChunk.uiNumChannels = _uiChannels;
 		fcChunk.uiSampleRate = (_psdSaveSettings && _psdSaveSettings->uiHz) ? _psdSaveSettings->uiHz : Hz();
 		fcChunk.uiBlockAlign = fcChunk.uiBitsPerSample * fcChunk.uiNumChannels / 8;
 		fcChunk.uiByteRate = fcChunk.uiBlockAlign * fcChunk.uiSampleRate;
 
+		if ( m_bExtensible || (_psdSaveSettings && _psdSaveSettings->uiChannelMask) ) {
+			fcChunk.chHeader.uiSize = sizeof( PW_FMT_CHUNK ) - sizeof( PW_CHUNK_HEADER );
+			fcChunk.uiAudioFormat = PW_F_EXTENSIBLE;
+			fcChunk.uiExtraParamSize = sizeof( PW_FMT_CHUNK ) - offsetof( PW_FMT_CHUNK, uiValidBitsPerSample );
+			// The loaded valid bits only still apply if the samples keep their format and size.
+			fcChunk.uiValidBitsPerSample = (_fFormat == m_fFormat && fcChunk.uiBitsPerSample == m_uiBitsPerSample && m_uiValidBitsPerSample) ?
+				m_uiValidBitsPerSample : fcChunk.uiBitsPerSample;
+			// The loaded speaker positions only still apply if the channels do.
+			if ( _psdSaveSettings && _psdSaveSettings->uiChannelMask ) { fcChunk.uiChannelMask = _psdSaveSettings->uiChannelMask; }
+			else if ( _uiChannels == m_uiNumChannels ) { fcChunk.uiChannelMask = m_uiChannelMask; }
+			fcChunk.ui8SubFormat[0] = static_cast<uint8_t>(_fFormat);
+			fcChunk.ui8SubFormat[1] = static_cast<uint8_t>(_fFormat >> 8);
+			std::memcpy( &fcChunk.ui8SubFormat[2], m_ui8SubFormatBase, sizeof( m_ui8SubFormatBase ) );
+		}
+
 		return fcChunk;
 	}
 
@@ -9,8 +9,11 @@
 
 #pragma once
 
+#include "../Files/PWMappedFile.h"
 #include "../Utilities/PWAlignmentAllocator.h"
 #include "../Utilities/PWUtilities.h"
+#include "PWPlanarBuffer.h"
+#include "PWSampleConverter.h"
 
 #include <cinttypes>
 #include <string>
@@ -32,6 +35,11 @@ namespace pw {
 
 
 		// == Enumerations.
+		/** Defaults. */
+		enum PW_DEFAULTS : size_t {
+			PW_D_TILE_FRAMES											= 8 * 1024,				// Frames per tile when decoding or encoding on multiple threads.  A multiple of 8.
+		};
+
 		/** Formats. */
 		enum PW_FORMAT : uint16_t {
 			PW_F_PCM													= 0x1,
@@ -61,6 +69,11 @@ namespace pw {
 			PW_C_LABL													= 0x6C62616C,
 			PW_C_ADTL													= 0x6C746461,
 			PW_C_DISP													= 0x70736964,	// Or 0x64697370?
+			PW_C_RF64													= 0x34364652,
+			PW_C_BW64													= 0x34365742,
+			PW_C_DS64													= 0x34367364,
+			PW_C_JUNK													= 0x4B4E554A,
+			PW_C_FACT													= 0x74636166,
 		};
 
 		/** Metadata. */
@@ -77,17 +90,31 @@ namespace pw {
 
 
 		// == Types.
-		typedef std::vector<double, CAlignmentAllocator<double, 64>>	lwtrack;
-		typedef std::vector<lwtrack>									lwaudio;
+		template <typename _tType>
+		using lwtrack_t													= std::vector<_tType, CAlignmentAllocator<_tType, 64>>;
+		template <typename _tType>
+		using lwaudio_t													= std::vector<lwtrack_t<_tType>>;
+		typedef lwtrack_t<double>										lwtrack;
+		typedef lwaudio_t<double>										lwaudio;
+		typedef lwtrack_t<float>										lwtrackf;
+		typedef lwaudio_t<float>										lwaudiof;
+		typedef CPlanarBuffer<double>									lwblock;
+		typedef CPlanarBuffer<float>									lwblockf;
 
 		/** The save data. */
 		struct PW_SAVE_DATA {
 			uint32_t													uiHz;					// Only overrides if not 0.
 			uint16_t													uiBitsPerSample;		// Only overrides if not 0.
+			CSampleConverter::PW_NARROWING								nNarrowing;				// How PCM samples copied to a lower bit depth drop bits.
+			PW_FORMAT													fFormat;				// PW_F_PCM (8, 16, 24, or 32 bits) or PW_F_IEEE_FLOAT (32 or 64 bits).
+			uint32_t													uiChannelMask;			// Only overrides if not 0.  Writes WAVE_FORMAT_EXTENSIBLE.
 
 			PW_SAVE_DATA() :
 				uiHz( 0 ),
-				uiBitsPerSample( 0 ) {}
+				uiBitsPerSample( 0 ),
+				nNarrowing( CSampleConverter::PW_N_ROUND ),
+				fFormat( PW_F_PCM ),
+				uiChannelMask( 0 ) {}
 		};
 
 		/** Loop points. */
@@ -100,6 +127,22 @@ namespace pw {
 			uint32_t													uiPlayCount;
 		};
 
+		/** A range of frames. */
+		struct PW_RANGE {
+			size_t														stFrom;					// The first frame in the range.
+			size_t														stTo;					// The frame after the last frame in the range.
+		};
+
+		/** Buffers that a batch worker keeps from one file to the next so that each file reuses the memory of the last. */
+		struct PW_ARENA {
+			std::vector<uint8_t>										vFile;					// The whole file loaded by Open(); the samples are read from it in place.
+			lwblock														bSamples;				// Decoded double samples for the caller.
+			lwblockf													bSamplesF;				// Decoded float samples for the caller.
+			std::vector<uint8_t>										vBlock;					// A block encoded by CWavStreamWriter.
+			std::vector<std::vector<uint8_t>>							vTiles;					// Tiles encoded by CWavStreamWriter on multiple threads.
+			std::vector<uint8_t>										vEncoded;				// Dirty or narrowed frames encoded by SaveAsPcm() and SaveAsPcmCopy().
+		};
+
 
 		// == Functions.
 		/**
@@ -118,6 +161,24 @@ namespace pw {
 		 */
 		bool															Open( const char16_t * _pwcPath );
 
+		/**
+		 * Loads a WAV file by memory-mapping it.  The sample data is not copied; it is read directly from the mapping, which
+		 *	remains open until Reset() is called or another file is opened.  The file must not be overwritten while it is mapped.
+		 *
+		 * \param _pcPath The UTF-8 path to open.
+		 * \return Returns true if the file was opened.
+		 */
+		bool															OpenMapped( const char8_t * _pcPath );
+
+		/**
+		 * Loads a WAV file by memory-mapping it.  The sample data is not copied; it is read directly from the mapping, which
+		 *	remains open until Reset() is called or another file is opened.  The file must not be overwritten while it is mapped.
+		 *
+		 * \param _pwcPath The UTF-16 path to open.
+		 * \return Returns true if the file was opened.
+		 */
+		bool															OpenMapped( const char16_t * _pwcPath );
+
 //#ifdef _WIN32
 //		/**
 //		 * Loads a WAV file.
@@ -145,7 +206,7 @@ namespace pw {
 		bool															LoadFromMemory( const std::vector<uint8_t> &_vData );
 
 		/**
-		 * Saves as a PCM WAV file.
+		 * Saves as a PCM WAV file, or an IEEE float WAV file if PW_SAVE_DATA::fFormat asks for one.
 		 *
 		 * \param _pcPath The path to where the file will be saved.
 		 * \param _vSamples The samples to convert and write to the file.
@@ -156,7 +217,7 @@ namespace pw {
 			const PW_SAVE_DATA * _psdSaveSettings = nullptr ) const;
 
 		/**
-		 * Saves as a PCM WAV file.
+		 * Saves as a PCM WAV file, or an IEEE float WAV file if PW_SAVE_DATA::fFormat asks for one.
 		 *
 		 * \param _pcPath The path to where the file will be saved.
 		 * \param _vSamples The samples to convert and write to the file.
@@ -169,7 +230,79 @@ namespace pw {
 		}
 
 		/**
-		 * Saves as a PCM WAV file.
+		 * Saves as a PCM WAV file from float samples, or an IEEE float WAV file if PW_SAVE_DATA::fFormat asks for one.
+		 *
+		 * \param _pcPath The path to where the file will be saved.
+		 * \param _vSamples The samples to convert and write to the file.
+		 * \param _psdSaveSettings Settings to override this class's settings.
+		 * \return Returns true if the file was created and saved.
+		 */
+		bool															SaveAsPcm( const char8_t * _pcPath, const lwaudiof &_vSamples,
+			const PW_SAVE_DATA * _psdSaveSettings = nullptr ) const;
+
+		/**
+		 * Saves as a PCM WAV file from float samples, or an IEEE float WAV file if PW_SAVE_DATA::fFormat asks for one.
+		 *
+		 * \param _pcPath The path to where the file will be saved.
+		 * \param _vSamples The samples to convert and write to the file.
+		 * \param _psdSaveSettings Settings to override this class's settings.
+		 * \return Returns true if the file was created and saved.
+		 */
+		bool															SaveAsPcm( const char16_t * _pcPath, const lwaudiof &_vSamples,
+			const PW_SAVE_DATA * _psdSaveSettings = nullptr ) const {
+			return SaveAsPcm( CUtilities::Utf16ToUtf8( _pcPath ).c_str(), _vSamples, _psdSaveSettings );
+		}
+
+		/**
+		 * Saves as a PCM WAV file from planar samples, or an IEEE float WAV file if PW_SAVE_DATA::fFormat asks for one.
+		 *
+		 * \param _pcPath The path to where the file will be saved.
+		 * \param _bSamples The samples to convert and write to the file.
+		 * \param _psdSaveSettings Settings to override this class's settings.
+		 * \return Returns true if the file was created and saved.
+		 */
+		bool															SaveAsPcm( const char8_t * _pcPath, const lwblock &_bSamples,
+			const PW_SAVE_DATA * _psdSaveSettings = nullptr ) const;
+
+		/**
+		 * Saves as a PCM WAV file from planar samples, or an IEEE float WAV file if PW_SAVE_DATA::fFormat asks for one.
+		 *
+		 * \param _pcPath The path to where the file will be saved.
+		 * \param _bSamples The samples to convert and write to the file.
+		 * \param _psdSaveSettings Settings to override this class's settings.
+		 * \return Returns true if the file was created and saved.
+		 */
+		bool															SaveAsPcm( const char16_t * _pcPath, const lwblock &_bSamples,
+			const PW_SAVE_DATA * _psdSaveSettings = nullptr ) const {
+			return SaveAsPcm( CUtilities::Utf16ToUtf8( _pcPath ).c_str(), _bSamples, _psdSaveSettings );
+		}
+
+		/**
+		 * Saves as a PCM WAV file from planar float samples, or an IEEE float WAV file if PW_SAVE_DATA::fFormat asks for one.
+		 *
+		 * \param _pcPath The path to where the file will be saved.
+		 * \param _bSamples The samples to convert and write to the file.
+		 * \param _psdSaveSettings Settings to override this class's settings.
+		 * \return Returns true if the file was created and saved.
+		 */
+		bool															SaveAsPcm( const char8_t * _pcPath, const lwblockf &_bSamples,
+			const PW_SAVE_DATA * _psdSaveSettings = nullptr ) const;
+
+		/**
+		 * Saves as a PCM WAV file from planar float samples, or an IEEE float WAV file if PW_SAVE_DATA::fFormat asks for one.
+		 *
+		 * \param _pcPath The path to where the file will be saved.
+		 * \param _bSamples The samples to convert and write to the file.
+		 * \param _psdSaveSettings Settings to override this class's settings.
+		 * \return Returns true if the file was created and saved.
+		 */
+		bool															SaveAsPcm( const char16_t * _pcPath, const lwblockf &_bSamples,
+			const PW_SAVE_DATA * _psdSaveSettings = nullptr ) const {
+			return SaveAsPcm( CUtilities::Utf16ToUtf8( _pcPath ).c_str(), _bSamples, _psdSaveSettings );
+		}
+
+		/**
+		 * Saves as a PCM WAV file, or an IEEE float WAV file if PW_SAVE_DATA::fFormat asks for one.
 		 *
 		 * \param _pcPath The path to where the file will be saved.
 		 * \param _vSamples The samples to convert and write to the file.
@@ -185,7 +318,7 @@ namespace pw {
 		}
 
 		/**
-		 * Saves as a PCM WAV file.
+		 * Saves as a PCM WAV file, or an IEEE float WAV file if PW_SAVE_DATA::fFormat asks for one.
 		 *
 		 * \param _pcPath The path to where the file will be saved.
 		 * \param _vSamples The samples to convert and write to the file.
@@ -197,6 +330,124 @@ namespace pw {
 			return SaveAsPcm( CUtilities::Utf16ToUtf8( _pcPath ).c_str(), _vSamples, _psdSaveSettings );
 		}
 
+		/**
+		 * Gets the format of the samples in a saved file.
+		 *
+		 * \param _psdSaveSettings Settings to override this class's settings.
+		 * \return Returns PW_F_IEEE_FLOAT if the settings ask for float samples, otherwise PW_F_PCM.
+		 */
+		static inline PW_FORMAT											OutputFormat( const PW_SAVE_DATA * _psdSaveSettings ) {
+			return (_psdSaveSettings && _psdSaveSettings->fFormat == PW_F_IEEE_FLOAT) ? PW_F_IEEE_FLOAT : PW_F_PCM;
+		}
+
+		/**
+		 * Gets the bits per sample in a saved file.  Unless the settings override it, the loaded bit depth is kept if the output format
+		 *	supports it, otherwise 32 bits are used.
+		 *
+		 * \param _psdSaveSettings Settings to override this class's settings.
+		 * \return Returns the bits per sample in a saved file.
+		 */
+		uint16_t														OutputBits( const PW_SAVE_DATA * _psdSaveSettings ) const;
+
+		/**
+		 * Determines if SaveAsPcmCopy() can be used with the given settings to copy the samples verbatim.  The loaded samples must be
+		 *	8-, 16-, 24-, or 32-bit PCM or 32- or 64-bit float, and the output must have the same format and bit depth.
+		 *
+		 * \param _psdSaveSettings Settings to override this class's settings.
+		 * \return Returns true if the loaded sample data can be copied verbatim to the output file.
+		 */
+		bool															CanCopySamples( const PW_SAVE_DATA * _psdSaveSettings = nullptr ) const;
+
+		/**
+		 * Determines if SaveAsPcmCopy() can be used with the given settings.  Either CanCopySamples() returns true, or the loaded
+		 *	samples are 8-, 16-, 24-, or 32-bit PCM and so is the output.
+		 *
+		 * \param _psdSaveSettings Settings to override this class's settings.
+		 * \return Returns true if the loaded sample data can be copied to the output file, converting only its bit depth.
+		 */
+		bool															CanConvertSamples( const PW_SAVE_DATA * _psdSaveSettings = nullptr ) const;
+
+		/**
+		 * Determines if the samples can be worked on as float instead of double without changing an unmodified save.  The loaded
+		 *	samples must be 32-bit float, or 8-, 16-, or 24-bit PCM saved at the same bit depth.  Every such code is held in a float
+		 *	closely enough to encode back to itself, so float tracks take half the memory and bandwidth of double tracks for the same
+		 *	output.
+		 *
+		 * \param _psdSaveSettings Settings to override this class's settings.
+		 * \return Returns true if decoding to and saving from float tracks gives the same file as doing so with double tracks.
+		 */
+		bool															FloatIsLossless( const PW_SAVE_DATA * _psdSaveSettings = nullptr ) const;
+
+		/**
+		 * Saves as a WAV file, copying the loaded sample data instead of decoding and re-encoding it.  If the format and bit depth are
+		 *	unchanged the samples are copied verbatim and only the header and metadata chunks are rebuilt; otherwise PCM samples are
+		 *	converted with CSampleConverter::PcmToPcm().  Fails if CanConvertSamples() returns false.
+		 *
+		 * \param _pcPath The path to where the file will be saved.
+		 * \param _psdSaveSettings Settings to override this class's settings.
+		 * \return Returns true if the file was created and saved.
+		 */
+		bool															SaveAsPcmCopy( const char8_t * _pcPath, const PW_SAVE_DATA * _psdSaveSettings = nullptr ) const;
+
+		/**
+		 * Saves as a WAV file, copying the loaded sample data instead of decoding and re-encoding it.  If the format and bit depth are
+		 *	unchanged the samples are copied verbatim and only the header and metadata chunks are rebuilt; otherwise PCM samples are
+		 *	converted with CSampleConverter::PcmToPcm().  Fails if CanConvertSamples() returns false.
+		 *
+		 * \param _pcPath The path to where the file will be saved.
+		 * \param _psdSaveSettings Settings to override this class's settings.
+		 * \return Returns true if the file was created and saved.
+		 */
+		bool															SaveAsPcmCopy( const char16_t * _pcPath, const PW_SAVE_DATA * _psdSaveSettings = nullptr ) const {
+			return SaveAsPcmCopy( CUtilities::Utf16ToUtf8( _pcPath ).c_str(), _psdSaveSettings );
+		}
+
+		/**
+		 * Declares that the samples most recently obtained with GetAllSamples() have not been modified.  From then on SaveAsPcm() only
+		 *	re-encodes the ranges passed to MarkDirty() and copies every other sample verbatim from the loaded data, as long as the
+		 *	output format, channel count, and length match the loaded file.
+		 */
+		void															MarkClean();
+
+		/**
+		 * Records that a range of samples on a channel has been modified.  Does nothing unless MarkClean() has been called.
+		 *
+		 * \param _uiChan The channel that was modified.
+		 * \param _stFrom The first modified sample.
+		 * \param _stTo The sample after the last modified sample.
+		 */
+		void															MarkDirty( uint16_t _uiChan, size_t _stFrom, size_t _stTo );
+
+		/**
+		 * Records that a range of samples on every channel has been modified.  Does nothing unless MarkClean() has been called.
+		 *
+		 * \param _stFrom The first modified sample.
+		 * \param _stTo The sample after the last modified sample.
+		 */
+		void															MarkDirty( size_t _stFrom, size_t _stTo ) {
+			for ( uint16_t C = 0; C < m_uiNumChannels; ++C ) { MarkDirty( C, _stFrom, _stTo ); }
+		}
+
+		/**
+		 * Records that any sample may have been modified, so that SaveAsPcm() re-encodes everything.  This is the state after loading.
+		 */
+		void															MarkAllDirty();
+
+		/**
+		 * Determines whether every sample is treated as modified.
+		 *
+		 * \return Returns true if MarkClean() has not been called since loading or since the last call to MarkAllDirty().
+		 */
+		inline bool														AllDirty() const { return !m_bTrackDirty; }
+
+		/**
+		 * Gets the modified ranges of a channel, sorted and non-overlapping.  Only meaningful if AllDirty() returns false.
+		 *
+		 * \param _uiChan The channel whose modified ranges are to be returned.
+		 * \return Returns the modified ranges of the channel.
+		 */
+		const std::vector<PW_RANGE> &									DirtyRanges( uint16_t _uiChan ) const;
+
 		/**
 		 * Resets the object back to scratch.
 		 */
@@ -207,7 +458,7 @@ namespace pw {
 		 *
 		 * \return Returns the number of samples in the loaded file.
 		 */
-		inline uint32_t													TotalSamples() const { return static_cast<uint32_t>(m_vSamples.size() / (m_uiNumChannels * m_uiBytesPerSample)); }
+		inline uint64_t													TotalSamples() const { return uint64_t( m_stSamplesSize / (m_uiNumChannels * m_uiBytesPerSample) ); }
 
 		/**
 		 * Fills a vector with the whole range of samples for a given channel.
@@ -229,6 +480,17 @@ namespace pw {
 		 */
 		bool															GetSamples( uint16_t _uiChan, lwtrack &_vResult, size_t _stFrom, size_t _stTo ) const;
 
+		/**
+		 * Appends a range of samples on every channel to an array of vectors, one per channel.  The interleaved sample data is read
+		 *	only once for all channels.
+		 *
+		 * \param _vResult The array of vectors to which to append the samples.  Resized to the number of channels.
+		 * \param _stFrom The starting sample to get.
+		 * \param _stTo The ending sample to get, exclusive.
+		 * \return Returns true if the vectors were able to fit all samples.
+		 */
+		bool															GetSamples( lwaudio &_vResult, size_t _stFrom, size_t _stTo ) const;
+
 		/**
 		 * Fills an array of vectors.  There is an array of vectors for each channel, and each vector contains all
 		 *	of the samples for that channel.
@@ -238,6 +500,44 @@ namespace pw {
 		 */
 		bool															GetAllSamples( lwaudio &_vResult ) const;
 
+		/**
+		 * Appends a range of samples on every channel to an array of float vectors, one per channel.  The interleaved sample data is
+		 *	read only once for all channels.  32-bit PCM cannot be decoded to float.
+		 *
+		 * \param _vResult The array of vectors to which to append the samples.  Resized to the number of channels.
+		 * \param _stFrom The starting sample to get.
+		 * \param _stTo The ending sample to get, exclusive.
+		 * \return Returns true if the vectors were able to fit all samples.
+		 */
+		bool															GetSamples( lwaudiof &_vResult, size_t _stFrom, size_t _stTo ) const;
+
+		/**
+		 * Fills an array of float vectors.  There is an array of vectors for each channel, and each vector contains all of the
+		 *	samples for that channel.  32-bit PCM cannot be decoded to float.
+		 *
+		 * \param _vResult The array of vectors to be filled with all samples in this file.
+		 * \return Returns true if the vector(s) was/were able to fit all samples.
+		 */
+		bool															GetAllSamples( lwaudiof &_vResult ) const;
+
+		/**
+		 * Fills a planar buffer with every sample.  The buffer is resized to the channels and frames of the file, reusing its block
+		 *	if it is large enough.
+		 *
+		 * \param _bResult The buffer to be filled with all samples in this file.
+		 * \return Returns true if the buffer was able to fit all samples.
+		 */
+		bool															GetAllSamples( lwblock &_bResult ) const;
+
+		/**
+		 * Fills a planar float buffer with every sample.  The buffer is resized to the channels and frames of the file, reusing its
+		 *	block if it is large enough.  32-bit PCM cannot be decoded to float.
+		 *
+		 * \param _bResult The buffer to be filled with all samples in this file.
+		 * \return Returns true if the buffer was able to fit all samples.
+		 */
+		bool															GetAllSamples( lwblockf &_bResult ) const;
+
 		/**
 		 * Gets the Hz.
 		 *
@@ -259,19 +559,82 @@ namespace pw {
 		 */
 		inline uint16_t													BitsPerSample() const { return m_uiBitsPerSample; }
 
+		/**
+		 * Gets the sample format.  For WAVE_FORMAT_EXTENSIBLE files this is the sub-format.
+		 *
+		 * \return Returns the sample format.
+		 */
+		inline PW_FORMAT												Format() const { return m_fFormat; }
+
+		/**
+		 * Gets the number of bits actually used within each sample.  Only WAVE_FORMAT_EXTENSIBLE files can use fewer than
+		 *	BitsPerSample(), and the samples are decoded by their full size either way.
+		 *
+		 * \return Returns the number of valid bits per sample.
+		 */
+		inline uint16_t													ValidBitsPerSample() const { return m_uiValidBitsPerSample; }
+
+		/**
+		 * Gets the speaker positions of the channels as a mask of SPEAKER_* bits.  Only WAVE_FORMAT_EXTENSIBLE files have one.
+		 *
+		 * \return Returns the channel mask, or 0 if the file does not assign speaker positions.
+		 */
+		inline uint32_t													ChannelMask() const { return m_uiChannelMask; }
+
+		/**
+		 * Determines if the file was loaded from a WAVE_FORMAT_EXTENSIBLE "fmt " chunk.  Its sub-format is then used as the format, and
+		 *	saved files keep the extension.
+		 *
+		 * \return Returns true if the file was loaded from a WAVE_FORMAT_EXTENSIBLE "fmt " chunk.
+		 */
+		inline bool														IsExtensible() const { return m_bExtensible; }
+
+		/**
+		 * Sets the number of threads used by GetAllSamples() and SaveAsPcm() to decode and encode this file.  The samples are split
+		 *	into tiles of PW_D_TILE_FRAMES frames, and the results are the same regardless of the number of threads.
+		 *
+		 * \param _stThreads The number of threads to use, or 0 to use one thread per logical core.
+		 */
+		inline void														SetThreads( size_t _stThreads ) { m_stThreads = CUtilities::ThreadCount( _stThreads ); }
+
+		/**
+		 * Gets the number of threads used to decode and encode this file.
+		 *
+		 * \return Returns the number of threads used to decode and encode this file.
+		 */
+		inline size_t													Threads() const { return m_stThreads; }
+
+		/**
+		 * Sets the buffers that Open(), SaveAsPcm(), and SaveAsPcmCopy() use instead of allocating their own.  Open() then loads the
+		 *	file into the arena and reads the samples from it in place rather than copying them.  Like SetThreads(), this is kept
+		 *	across Reset() and Open().  The arena must outlive this object's use of it and must not be shared by objects in use at the
+		 *	same time.
+		 *
+		 * \param _paArena The buffers to use, or nullptr to allocate per file.
+		 */
+		inline void														SetArena( PW_ARENA * _paArena ) { m_paArena = _paArena; }
+
+		/**
+		 * Gets the buffers set with SetArena().
+		 *
+		 * \return Returns the buffers set with SetArena(), or nullptr if none are set.
+		 */
+		inline PW_ARENA *												Arena() const { return m_paArena; }
+
 		/**
 		 * Calculates the size of a buffer needed to hold the given number of samples on the given number of channels in te given format.
 		 *
 		 * \param _fFormat The format of the samples.
-		 * \param _uiSamples The number of samples per channel.
+		 * \param _ui64Samples The number of samples per channel.
 		 * \param _uiChannels The number of channels.
 		 * \param _uiBitsPerPixel The number of bits per sample.
 		 * \return RETURN
 		 */
-		inline uint32_t													CalcSize( PW_FORMAT _fFormat, uint32_t _uiSamples, uint16_t _uiChannels, uint16_t _uiBitsPerPixel ) const {
+		inline uint64_t													CalcSize( PW_FORMAT _fFormat, uint64_t _ui64Samples, uint16_t _uiChannels, uint16_t _uiBitsPerPixel ) const {
 			switch ( _fFormat ) {
-				case PW_F_PCM : {
-					return uint32_t( uint64_t( _uiSamples ) * _uiChannels * _uiBitsPerPixel / 8 );
+				case PW_F_PCM :
+				case PW_F_IEEE_FLOAT : {
+					return _ui64Samples * _uiChannels * _uiBitsPerPixel / 8;
 				}
 			}
 			return 0;
@@ -304,6 +667,10 @@ namespace pw {
 
 
 	protected :
+		friend class CPcmBuffer;
+		friend class CPieceTable;
+		friend class CWavStreamWriter;
+
 		// == Types.
 #pragma pack( push, 1 )
 		// Chunk.
@@ -340,10 +707,15 @@ namespace pw {
 			uint32_t													uiByteRate;				// SampleRate * NumChannels * BitsPerSample / 8.
 			uint16_t													uiBlockAlign;			// NumChannels * BitsPerSample / 8.
 			uint16_t													uiBitsPerSample;		// 8, 16, etc.
-			uint16_t													uiExtraParamSize;		// Invalid on PCM.
-			uint8_t														ui8ExtraParams[1];		// uiExtraParamSize bytes of extra data.
+			uint16_t													uiExtraParamSize;		// Invalid on PCM.  22 on WAVE_FORMAT_EXTENSIBLE.
+			uint16_t													uiValidBitsPerSample;	// WAVE_FORMAT_EXTENSIBLE only.  Bits used within uiBitsPerSample.
+			uint32_t													uiChannelMask;			// WAVE_FORMAT_EXTENSIBLE only.  SPEAKER_* positions of the channels.
+			uint8_t														ui8SubFormat[16];		// WAVE_FORMAT_EXTENSIBLE only.  The GUID of the format, which is in its first 2 bytes.
 		};
 
+		/** The last 14 bytes of every WAVE_FORMAT_EXTENSIBLE sub-format GUID (KSDATAFORMAT_SUBTYPE_*) this class reads or writes. */
+		static constexpr uint8_t										m_ui8SubFormatBase[14] = { 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71 };
+
 		// DATA chunk.
 		struct PW_DATA_CHUNK {
 			PW_CHUNK_HEADER												chHeader;
@@ -352,6 +724,25 @@ namespace pw {
 			uint8_t														ui8Data[1];				// Sample data (length = uiSubchunk2Size).
 		};
 
+		// DS64 table entry.
+		struct PW_DS64_TABLE_ENTRY {
+			union {
+				char8_t													cName[4];
+				uint32_t												uiId;
+			}															u;
+			uint64_t													ui64Size;
+		};
+
+		// DS64 chunk (RF64/BW64 only).
+		struct PW_DS64_CHUNK {
+			PW_CHUNK_HEADER												chHeader;
+			uint64_t													ui64RiffSize;			// Replaces the RIFF size when that is 0xFFFFFFFF.
+			uint64_t													ui64DataSize;			// Replaces the "data" size when that is 0xFFFFFFFF.
+			uint64_t													ui64SampleCount;		// Frames in the "data" chunk.
+			uint32_t													ui32TableLength;		// Number of entries in teTable.
+			PW_DS64_TABLE_ENTRY											teTable[1];				// Sizes of any other chunks larger than 4 gigabytes.
+		};
+
 		// SAMPL chunk.
 		struct PW_SMPL_CHUNK {
 			PW_CHUNK_HEADER												chHeader;
@@ -407,8 +798,8 @@ namespace pw {
 				char8_t													cName[4];
 				uint32_t												uiName;
 			}															u;
-			uint32_t													uiOffset;
-			uint32_t													uiSize;
+			uint64_t													ui64Offset;
+			uint64_t													ui64Size;
 		};
 
 		// A LIST entry.
@@ -464,10 +855,32 @@ namespace pw {
 		uint16_t														m_uiBitsPerSample;		// 8, 16, etc.
 		/** The bytes per sample. */
 		uint16_t														m_uiBytesPerSample;		// m_uiBitsPerSample / 8.
+		/** The valid bits per sample. */
+		uint16_t														m_uiValidBitsPerSample;	// m_uiBitsPerSample unless a WAVE_FORMAT_EXTENSIBLE file says otherwise.
+		/** The speaker positions of the channels. */
+		uint32_t														m_uiChannelMask;		// SPEAKER_* bits, or 0.
+		/** If true, the "fmt " chunk was WAVE_FORMAT_EXTENSIBLE and m_fFormat holds its sub-format. */
+		bool															m_bExtensible;
+		/** The decoders for the format and channel count, selected when the "fmt " chunk is loaded. */
+		CSampleConverter::PW_DECODERS									m_dDecoders;
 		/** Base note. */
 		uint32_t														m_uiBaseNote;
-		/** The raw sample data. */
+		/** The raw sample data, used when the file is neither memory-mapped nor loaded into an arena. */
 		std::vector<uint8_t>											m_vSamples;
+		/** A read-only view of the raw sample data.  Points into m_vSamples, m_mfMap, or the vFile of m_paArena. */
+		const uint8_t *													m_pui8Samples;
+		/** The size of the raw sample data in bytes. */
+		size_t															m_stSamplesSize;
+		/** The memory-mapped file, if opened with OpenMapped(). */
+		CMappedFile														m_mfMap;
+		/** The path of the file from which the samples were loaded, or empty if they were loaded from memory. */
+		std::u8string													m_sSourcePath;
+		/** The size of that file when it was loaded. */
+		uint64_t														m_ui64SourceSize;
+		/** The time at which that file was last written when it was loaded, from CFileBase::LastWriteTime(). */
+		int64_t															m_i64SourceTime;
+		/** The offset of the samples in that file. */
+		uint64_t														m_ui64SamplesOffset;
 		/** Loop points. */
 		std::vector<PW_LOOP_POINT>										m_vLoops;
 		/** "LIST" metadata. */
@@ -478,24 +891,46 @@ namespace pw {
 		std::vector<PW_DISP_ENTRY>										m_vDisp;
 		/** Instrument metadata. */
 		PW_INST_ENTRY													m_ieInstEntry;
+		/** The number of threads used to decode and encode. */
+		size_t															m_stThreads;
+		/** Buffers reused from file to file, or nullptr. */
+		PW_ARENA *														m_paArena;
+		/** The modified ranges of each channel, sorted and non-overlapping.  Only used if m_bTrackDirty is true. */
+		std::vector<std::vector<PW_RANGE>>								m_vDirty;
+		/** If true, only the ranges in m_vDirty have been modified; otherwise every sample is treated as modified. */
+		bool															m_bTrackDirty;
 
 
 		// == Functions.
 		/**
-		 * Loads data from the "fmt ".
+		 * Loads a WAV file from a buffer.
+		 *
+		 * \param _pui8Data The in-memory file to load.
+		 * \param _stSize The size of the buffer to which _pui8Data points.
+		 * \param _bCopySamples If true, the "data" chunk is copied into m_vSamples; otherwise m_pui8Samples points into _pui8Data, which must outlive this object's use of it.
+		 * \return Returns true if the file is a valid WAV file.
+		 */
+		bool															LoadFromBuffer( const uint8_t * _pui8Data, size_t _stSize, bool _bCopySamples );
+
+		/**
+		 * Loads data from the "fmt ".  WAVE_FORMAT_EXTENSIBLE chunks load their sub-format into m_fFormat, so their samples go
+		 *	through the same decoders as plain PCM and IEEE float files.
 		 *
 		 * \param _pfcChunk The chunk of data to load
+		 * \param _ui64Size The number of bytes in the chunk after its header.
 		 * \return Returns true if everything loaded fine.
 		 */
-		bool															LoadFmt( const PW_FMT_CHUNK * _pfcChunk );
+		bool															LoadFmt( const PW_FMT_CHUNK * _pfcChunk, uint64_t _ui64Size );
 
 		/**
 		 * Loads the "data" chunk.
 		 *
 		 * \param _pdcChunk The chunk of data to load
+		 * \param _ui64Size The size of the sample data, which comes from the "ds64" chunk in RF64 files.
+		 * \param _bCopySamples If true, the samples are copied into m_vSamples, otherwise they are referenced in-place.
 		 * \return Returns true if everything loaded fine.
 		 */
-		bool															LoadData( const PW_DATA_CHUNK * _pdcChunk );
+		bool															LoadData( const PW_DATA_CHUNK * _pdcChunk, uint64_t _ui64Size, bool _bCopySamples );
 
 		/**
 		 * Loads the "smpl" chunk.
@@ -530,105 +965,230 @@ namespace pw {
 		bool															LoadInst( const PW_INST_CHUNK * _picChunk );
 
 		/**
-		 * Converts a bunch of 8-bit PCM samples to double.
+		 * Converts a range of samples on a channel to double using the converter for the loaded format.
 		 *
-		 * \param _ui32From Starting sample index.
-		 * \param _ui32To Ending sample index.
 		 * \param _uiChan The channel whose sample data is to be obtained.
-		 * \param _vResult The vector containing the samples.
-		 * \return Returns true if the vector was able to hold all of the values.
+		 * \param _ui64From Starting sample index.
+		 * \param _ui64To Ending sample index, exclusive.  Must not exceed TotalSamples().
+		 * \param _pdResult The buffer to fill.  Must have room for (_ui64To - _ui64From) values.
+		 * \return Returns true if the format is supported and the range is valid.
 		 */
-		bool															Pcm8ToF64( uint32_t _ui32From, uint32_t _ui32To, uint16_t _uiChan, lwtrack &_vResult ) const;
+		bool															DecodeSamples( uint16_t _uiChan, uint64_t _ui64From, uint64_t _ui64To, double * _pdResult ) const;
 
 		/**
-		 * Converts a bunch of 16-bit PCM samples to double.
+		 * Converts a range of frames on all channels to double in a single pass over the interleaved sample data.
 		 *
-		 * \param _ui32From Starting sample index.
-		 * \param _ui32To Ending sample index.
-		 * \param _uiChan The channel whose sample data is to be obtained.
-		 * \param _vResult The vector containing the samples.
-		 * \return Returns true if the vector was able to hold all of the values.
+		 * \param _ui64From Starting frame index.
+		 * \param _ui64To Ending frame index, exclusive.  Must not exceed TotalSamples().
+		 * \param _ppdResult One buffer per channel.  Frame I is written to _ppdResult[C][_stDstIdx+I-_ui64From].
+		 * \param _stDstIdx The index in each buffer at which to write the first frame.
+		 * \return Returns true if the format is supported and the range is valid.
 		 */
-		bool															Pcm16ToF64( uint32_t _ui32From, uint32_t _ui32To, uint16_t _uiChan, lwtrack &_vResult ) const;
+		bool															DecodeFrames( uint64_t _ui64From, uint64_t _ui64To, double * const * _ppdResult, size_t _stDstIdx ) const;
 
 		/**
-		 * Converts a bunch of 24-bit PCM samples to double.
+		 * Converts a range of frames on all channels to float in a single pass over the interleaved sample data.
 		 *
-		 * \param _ui32From Starting sample index.
-		 * \param _ui32To Ending sample index.
-		 * \param _uiChan The channel whose sample data is to be obtained.
-		 * \param _vResult The vector containing the samples.
-		 * \return Returns true if the vector was able to hold all of the values.
+		 * \param _ui64From Starting frame index.
+		 * \param _ui64To Ending frame index, exclusive.  Must not exceed TotalSamples().
+		 * \param _ppfResult One buffer per channel.  Frame I is written to _ppfResult[C][_stDstIdx+I-_ui64From].
+		 * \param _stDstIdx The index in each buffer at which to write the first frame.
+		 * \return Returns true if the format can be decoded to float and the range is valid.
 		 */
-		bool															Pcm24ToF64( uint32_t _ui32From, uint32_t _ui32To, uint16_t _uiChan, lwtrack &_vResult ) const;
+		bool															DecodeFrames( uint64_t _ui64From, uint64_t _ui64To, float * const * _ppfResult, size_t _stDstIdx ) const;
 
 		/**
-		 * Converts a bunch of 32-bit PCM samples to double.
+		 * Appends a range of samples on every channel to an array of vectors, one per channel.
 		 *
-		 * \param _ui32From Starting sample index.
-		 * \param _ui32To Ending sample index.
-		 * \param _uiChan The channel whose sample data is to be obtained.
-		 * \param _vResult The vector containing the samples.
-		 * \return Returns true if the vector was able to hold all of the values.
+		 * \param _vResult The array of vectors to which to append the samples.  Resized to the number of channels.
+		 * \param _stFrom The starting sample to get.
+		 * \param _stTo The ending sample to get, exclusive.
+		 * \return Returns true if the vectors were able to fit all samples.
 		 */
-		bool															Pcm32ToF64( uint32_t _ui32From, uint32_t _ui32To, uint16_t _uiChan, lwtrack &_vResult ) const;
+		template <typename _tType>
+		bool															AppendSamples( lwaudio_t<_tType> &_vResult, size_t _stFrom, size_t _stTo ) const;
 
 		/**
-		 * Converts a bunch of 32-bit float samples to double.
+		 * Fills an array of vectors with every sample, decoding tiles on m_stThreads threads.
 		 *
-		 * \param _ui32From Starting sample index.
-		 * \param _ui32To Ending sample index.
-		 * \param _uiChan The channel whose sample data is to be obtained.
-		 * \param _vResult The vector containing the samples.
-		 * \return Returns true if the vector was able to hold all of the values.
+		 * \param _vResult The array of vectors to be filled with all samples in this file.
+		 * \return Returns true if the vector(s) was/were able to fit all samples.
 		 */
-		bool															F32ToF64( uint32_t _ui32From, uint32_t _ui32To, uint16_t _uiChan, lwtrack &_vResult ) const;
+		template <typename _tType>
+		bool															AppendAllSamples( lwaudio_t<_tType> &_vResult ) const;
+
+		/**
+		 * Fills a planar buffer with every sample, decoding tiles on m_stThreads threads.
+		 *
+		 * \param _pbResult The buffer to be filled with all samples in this file.
+		 * \return Returns true if the buffer was able to fit all samples.
+		 */
+		template <typename _tType>
+		bool															FillAllSamples( CPlanarBuffer<_tType> &_pbResult ) const;
+
+		/**
+		 * Decodes every frame tile by tile on m_stThreads threads.
+		 *
+		 * \param _pptDst One pointer per channel to where to store the samples.  Each must have room for TotalSamples() samples.
+		 * \return Returns true if every tile was decoded.
+		 */
+		template <typename _tType>
+		bool															DecodeAllFrames( _tType * const * _pptDst ) const;
+
+		/**
+		 * Saves as a PCM or IEEE float WAV file from double or float samples.
+		 *
+		 * \param _pcPath The path to where the file will be saved.
+		 * \param _vSamples The samples to convert and write to the file.  An lwaudio_t or a CPlanarBuffer.
+		 * \param _psdSaveSettings Settings to override this class's settings.
+		 * \return Returns true if the file was created and saved.
+		 */
+		template <typename _tAudio>
+		bool															SaveSamples( const char8_t * _pcPath, const _tAudio &_vSamples, const PW_SAVE_DATA * _psdSaveSettings ) const;
+
+		/**
+		 * Gathers a pointer to the first sample of each channel of an lwaudio_t or a CPlanarBuffer, as the encoders take them.
+		 *
+		 * \param _vSamples The samples.
+		 * \return Returns one pointer per channel.  Throws std::bad_alloc on failure.
+		 */
+		template <typename _tAudio>
+		static auto														ChannelData( const _tAudio &_vSamples ) {
+			std::vector<const typename _tAudio::value_type::value_type *> vRet( _vSamples.size() );
+			for ( auto C = _vSamples.size(); C--; ) {
+				vRet[C] = _vSamples[C].data();
+			}
+			return vRet;
+		}
 
 		/**
 		 * Converts a batch of F64 samples to PCM samples.
 		 *
-		 * \param _vSrc The samples to convert.
+		 * \param _ppdSrc One pointer per channel to the samples to convert.
+		 * \param _uiChannels The number of channels.
+		 * \param _stFrom The index of the first frame to convert.
+		 * \param _stTo The index of the frame after the last frame to convert.
 		 * \param _vDst The buffer to which to convert the samples.
 		 * \return Returns trye if all samples were added to the buffer.
 		 */
-		static bool														BatchF64ToPcm8( const lwaudio &_vSrc, std::vector<uint8_t> &_vDst );
+		static bool														BatchF64ToPcm8( const double * const * _ppdSrc, uint16_t _uiChannels, size_t _stFrom, size_t _stTo, std::vector<uint8_t> &_vDst );
 
 		/**
 		 * Converts a batch of F64 samples to PCM samples.
 		 *
-		 * \param _vSrc The samples to convert.
+		 * \param _ppdSrc One pointer per channel to the samples to convert.
+		 * \param _uiChannels The number of channels.
+		 * \param _stFrom The index of the first frame to convert.
+		 * \param _stTo The index of the frame after the last frame to convert.
 		 * \param _vDst The buffer to which to convert the samples.
 		 * \return Returns trye if all samples were added to the buffer.
 		 */
-		static bool														BatchF64ToPcm16( const lwaudio &_vSrc, std::vector<uint8_t> &_vDst );
+		static bool														BatchF64ToPcm16( const double * const * _ppdSrc, uint16_t _uiChannels, size_t _stFrom, size_t _stTo, std::vector<uint8_t> &_vDst );
 
 		/**
 		 * Converts a batch of F64 samples to PCM samples.
 		 *
-		 * \param _vSrc The samples to convert.
+		 * \param _ppdSrc One pointer per channel to the samples to convert.
+		 * \param _uiChannels The number of channels.
+		 * \param _stFrom The index of the first frame to convert.
+		 * \param _stTo The index of the frame after the last frame to convert.
 		 * \param _vDst The buffer to which to convert the samples.
 		 * \return Returns trye if all samples were added to the buffer.
 		 */
-		static bool														BatchF64ToPcm24( const lwaudio &_vSrc, std::vector<uint8_t> &_vDst );
+		static bool														BatchF64ToPcm24( const double * const * _ppdSrc, uint16_t _uiChannels, size_t _stFrom, size_t _stTo, std::vector<uint8_t> &_vDst );
 
 		/**
 		 * Converts a batch of F64 samples to PCM samples.
 		 *
-		 * \param _vSrc The samples to convert.
+		 * \param _ppdSrc One pointer per channel to the samples to convert.
+		 * \param _uiChannels The number of channels.
+		 * \param _stFrom The index of the first frame to convert.
+		 * \param _stTo The index of the frame after the last frame to convert.
 		 * \param _vDst The buffer to which to convert the samples.
 		 * \return Returns trye if all samples were added to the buffer.
 		 */
-		static bool														BatchF64ToPcm32( const lwaudio &_vSrc, std::vector<uint8_t> &_vDst );
+		static bool														BatchF64ToPcm32( const double * const * _ppdSrc, uint16_t _uiChannels, size_t _stFrom, size_t _stTo, std::vector<uint8_t> &_vDst );
+
+		/**
+		 * Converts a batch of F64 samples to 32-bit float samples.
+		 *
+		 * \param _ppdSrc One pointer per channel to the samples to convert.
+		 * \param _uiChannels The number of channels.
+		 * \param _stFrom The index of the first frame to convert.
+		 * \param _stTo The index of the frame after the last frame to convert.
+		 * \param _vDst The buffer to which to convert the samples.
+		 * \return Returns true if all samples were added to the buffer.
+		 */
+		static bool														BatchF64ToFloat32( const double * const * _ppdSrc, uint16_t _uiChannels, size_t _stFrom, size_t _stTo, std::vector<uint8_t> &_vDst );
+
+		/**
+		 * Converts a batch of F64 samples to 64-bit float samples.
+		 *
+		 * \param _ppdSrc One pointer per channel to the samples to convert.
+		 * \param _uiChannels The number of channels.
+		 * \param _stFrom The index of the first frame to convert.
+		 * \param _stTo The index of the frame after the last frame to convert.
+		 * \param _vDst The buffer to which to convert the samples.
+		 * \return Returns true if all samples were added to the buffer.
+		 */
+		static bool														BatchF64ToFloat64( const double * const * _ppdSrc, uint16_t _uiChannels, size_t _stFrom, size_t _stTo, std::vector<uint8_t> &_vDst );
+
+		/**
+		 * Converts a batch of F32 samples to PCM or float samples.  A block at a time is widened to double, which is exact, and encoded
+		 *	with the double encoders, so the result is the same as encoding the same values held as doubles.
+		 *
+		 * \param _ppfSrc One pointer per channel to the samples to convert.
+		 * \param _uiChannels The number of channels.
+		 * \param _stFrom The index of the first frame to convert.
+		 * \param _stTo The index of the frame after the last frame to convert.
+		 * \param _fFormat The output format.  PW_F_PCM or PW_F_IEEE_FLOAT.
+		 * \param _uiBits The bits per output sample.  8, 16, 24, or 32 for PCM; 32 or 64 for float.
+		 * \param _vDst The buffer to which to convert the samples.
+		 * \return Returns true if all samples were added to the buffer.
+		 */
+		static bool														BatchF32Encode( const float * const * _ppfSrc, uint16_t _uiChannels, size_t _stFrom, size_t _stTo, PW_FORMAT _fFormat, uint16_t _uiBits, std::vector<uint8_t> &_vDst );
+
+		/**
+		 * Encodes a range of frames in the loaded format, then copies the samples of every channel that were not modified in the
+		 *	range back from the loaded data.
+		 *
+		 * \param _vSrc The samples to encode.  An lwaudio_t or a CPlanarBuffer with one channel per channel of the loaded file.
+		 * \param _stFrom The index of the first frame to encode.
+		 * \param _stTo The index of the frame after the last frame to encode.
+		 * \param _vDst The buffer to which to append the encoded frames.
+		 * \return Returns true if the frames were encoded.
+		 */
+		template <typename _tAudio>
+		bool															EncodeDirty( const _tAudio &_vSrc, size_t _stFrom, size_t _stTo, std::vector<uint8_t> &_vDst ) const;
+
+		/**
+		 * Determines whether a channel was modified over the whole of a range.
+		 *
+		 * \param _uiChan The channel to check.
+		 * \param _stFrom The first frame in the range.
+		 * \param _stTo The frame after the last frame in the range.
+		 * \return Returns true if every frame in the range is inside one of the channel's modified ranges.
+		 */
+		bool															ChannelDirty( uint16_t _uiChan, size_t _stFrom, size_t _stTo ) const;
+
+		/**
+		 * Adds a range to a sorted, non-overlapping list of ranges, merging it with any ranges it overlaps or touches.
+		 *
+		 * \param _vRanges The list of ranges to which to add the range.
+		 * \param _stFrom The first frame in the range.
+		 * \param _stTo The frame after the last frame in the range.
+		 */
+		static void														AddRange( std::vector<PW_RANGE> &_vRanges, size_t _stFrom, size_t _stTo );
 
 		/**
 		 * Gets the byte indices of PCM data given an offset and channel.
 		 *
 		 * \param _uiChan The channel.
-		 * \param _uiIdx The sample index.
+		 * \param _ui64Idx The sample index.
 		 * \param _uiStride The returned stride.
 		 * \return Returns the byte index calculated using the given information and the sample depth.
 		 */
-		size_t															CalcOffsetsForSample( uint16_t _uiChan, uint32_t _uiIdx, uint32_t &_uiStride ) const;
+		size_t															CalcOffsetsForSample( uint16_t _uiChan, uint64_t _ui64Idx, uint32_t &_uiStride ) const;
 
 		/**
 		 * Converts a 28-bit size value from ID3 into regular 32-bit.
@@ -638,6 +1198,14 @@ namespace pw {
 		 */
 		static uint32_t													DecodeSize( uint32_t _uiSize );
 
+		/**
+		 * Replaces characters that are not allowed in file names with look-alikes.  Only the file-name part of the path is changed.
+		 *
+		 * \param _pcPath The path to sanitize.
+		 * \return Returns the sanitized path.
+		 */
+		static std::u8string											SanitizePath( const char8_t * _pcPath );
+
 		/**
 		 * Creates an "fmt " chunk based off either this object's parameters or optional given overrides.
 		 *
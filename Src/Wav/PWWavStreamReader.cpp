@@ -0,0 +1,58 @@
+/**
+ * Copyright L. Spiro 2024
+ *
+ * Written by: Shawn (L. Spiro) Wilcoxen
+ *
+ * Description: Reads decoded frames from a WAV file in fixed-size blocks.
+ */
+
+#include "PWWavStreamReader.h"
+
+#include <algorithm>
+
+
+namespace pw {
+
+	CWavStreamReader::CWavStreamReader( const CWavFile &_wfFile, size_t _stBlockSize ) :
+		m_wfFile( _wfFile ),
+		m_stTotal( (_wfFile.Channels() && _wfFile.BitsPerSample() >= 8) ? size_t( _wfFile.TotalSamples() ) : 0 ),
+		m_stCursor( 0 ),
+		m_stBlockSize( std::max<size_t>( _stBlockSize, 1 ) ) {
+	}
+
+	// == Functions.
+	/**
+	 * Decodes the next block of frames into _aBlock and advances the cursor.  _aBlock is resized to the number of channels and each
+	 *	track holds the same number of samples on return.
+	 *
+	 * \param _aBlock The buffer to fill.  Its tracks are cleared but keep their capacity between calls.
+	 * \return Returns the number of frames decoded, which is less than the block size only at the end of the file.  Returns 0 at the end of the file or on error.
+	 */
+	size_t CWavStreamReader::ReadBlock( CWavFile::lwaudio &_aBlock ) {
+		if ( AtEnd() ) { return 0; }
+		size_t stFrames = std::min( m_stBlockSize, Remaining() );
+		try {
+			_aBlock.resize( m_wfFile.Channels() );
+			for ( uint16_t C = 0; C < m_wfFile.Channels(); ++C ) {
+				_aBlock[C].clear();
+			}
+		}
+		catch ( ... ) { return 0; }
+		if ( !m_wfFile.GetSamples( _aBlock, m_stCursor, m_stCursor + stFrames ) ) { return 0; }
+		m_stCursor += stFrames;
+		return stFrames;
+	}
+
+	/**
+	 * Moves the cursor to the given frame.
+	 *
+	 * \param _stFrame The frame to which to move.
+	 * \return Returns true if the frame is within the file.  The end of the file is a valid position.
+	 */
+	bool CWavStreamReader::Seek( size_t _stFrame ) {
+		if ( _stFrame > m_stTotal ) { return false; }
+		m_stCursor = _stFrame;
+		return true;
+	}
+
+}	// namespace pw
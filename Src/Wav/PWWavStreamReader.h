@@ -0,0 +1,89 @@
+/**
+ * Copyright L. Spiro 2024
+ *
+ * Written by: Shawn (L. Spiro) Wilcoxen
+ *
+ * Description: Reads decoded frames from a WAV file in fixed-size blocks.
+ */
+
+
+#pragma once
+
+#include "PWWavFile.h"
+
+
+namespace pw {
+
+	/**
+	 * Class CWavStreamReader
+	 * \brief Reads decoded frames from a WAV file in fixed-size blocks.
+	 *
+	 * Description: Reads decoded frames from a WAV file in fixed-size blocks.  Each call to ReadBlock() decodes the next block of
+	 *	frames at the cursor into the given buffer, reusing its allocations, so the decoded working set never exceeds one block
+	 *	regardless of the length of the file.  Pair with CWavFile::OpenMapped() to keep the raw samples out of memory as well.
+	 */
+	class CWavStreamReader {
+	public :
+		CWavStreamReader( const CWavFile &_wfFile, size_t _stBlockSize = 4096 );
+
+
+		// == Functions.
+		/**
+		 * Decodes the next block of frames into _aBlock and advances the cursor.  _aBlock is resized to the number of channels and each
+		 *	track holds the same number of samples on return.
+		 *
+		 * \param _aBlock The buffer to fill.  Its tracks are cleared but keep their capacity between calls.
+		 * \return Returns the number of frames decoded, which is less than the block size only at the end of the file.  Returns 0 at the end of the file or on error.
+		 */
+		size_t															ReadBlock( CWavFile::lwaudio &_aBlock );
+
+		/**
+		 * Moves the cursor to the given frame.
+		 *
+		 * \param _stFrame The frame to which to move.
+		 * \return Returns true if the frame is within the file.  The end of the file is a valid position.
+		 */
+		bool															Seek( size_t _stFrame );
+
+		/**
+		 * Gets the cursor.
+		 *
+		 * \return Returns the index of the next frame to be decoded.
+		 */
+		inline size_t													Tell() const { return m_stCursor; }
+
+		/**
+		 * Gets the number of frames left to decode.
+		 *
+		 * \return Returns the number of frames between the cursor and the end of the file.
+		 */
+		inline size_t													Remaining() const { return m_stTotal - m_stCursor; }
+
+		/**
+		 * Determines if the cursor is at the end of the file.
+		 *
+		 * \return Returns true if there are no more frames to decode.
+		 */
+		inline bool														AtEnd() const { return m_stCursor >= m_stTotal; }
+
+		/**
+		 * Gets the number of frames decoded per block.
+		 *
+		 * \return Returns the number of frames decoded per block.
+		 */
+		inline size_t													BlockSize() const { return m_stBlockSize; }
+
+
+	protected :
+		// == Members.
+		/** The file from which to read. */
+		const CWavFile &												m_wfFile;
+		/** The total number of frames in the file. */
+		size_t															m_stTotal;
+		/** The next frame to decode. */
+		size_t															m_stCursor;
+		/** The number of frames per block. */
+		size_t															m_stBlockSize;
+	};
+
+}	// namespace pw
@@ -0,0 +1,446 @@
+/**
+ * Copyright L. Spiro 2024
+ *
+ * Written by: Shawn (L. Spiro) Wilcoxen
+ *
+ * Description: Writes a PCM or IEEE float WAV file incrementally, one block of frames at a time.
+ */
+
+#include "PWWavStreamWriter.h"
+
+#include <atomic>
+
+
+namespace pw {
+
+	CWavStreamWriter::CWavStreamWriter() :
+		m_pwfSource( nullptr ),
+		m_paArena( nullptr ),
+		m_ui64Ds64Pos( 0 ),
+		m_ui64FactPos( 0 ),
+		m_ui64DataSizePos( 0 ),
+		m_ui64DataSize( 0 ),
+		m_ui64Frames( 0 ),
+		m_uiChannels( 0 ),
+		m_uiBitsPerSample( 0 ),
+		m_uiFormat( 0 ) {
+	}
+	CWavStreamWriter::~CWavStreamWriter() {
+		Discard();
+		ReturnArena();
+	}
+
+	// == Functions.
+	/**
+	 * Creates the file and writes the header.  The path is given in UTF-8.
+	 *
+	 * \param _pcPath The path to where the file will be saved.
+	 * \param _wfSource The file whose format and metadata will be written.  Must remain valid until Finalize() is called.
+	 * \param _uiChannels The number of channels to be written.
+	 * \param _psdSaveSettings Settings to override the source file's settings.
+	 * \param _ui64ExpectedFrames The number of frames that will be written, or UINT64_MAX if not known.  Only used to decide whether to
+	 *	reserve space for a "ds64" chunk.
+	 * \param _ui64MatchDataOffset If not UINT64_MAX, a "JUNK" chunk is added if needed so that the samples start at the same offset
+	 *	modulo PW_D_CLONE_ALIGN as this, which lets WriteRawFrom() clone whole blocks from a file whose samples start here.
+	 * \return Returns true if the file was created and the header was written.
+	 */
+	bool CWavStreamWriter::Create( const char8_t * _pcPath, const CWavFile &_wfSource, uint16_t _uiChannels,
+		const CWavFile::PW_SAVE_DATA * _psdSaveSettings, uint64_t _ui64ExpectedFrames, uint64_t _ui64MatchDataOffset ) {
+		Discard();
+		m_ui64Ds64Pos = m_ui64FactPos = m_ui64DataSizePos = m_ui64DataSize = m_ui64Frames = 0;
+		if ( !_uiChannels ) { return false; }
+		ReturnArena();
+		m_paArena = _wfSource.Arena();
+		if ( m_paArena ) {
+			m_vBuffer.swap( m_paArena->vBlock );
+			m_vTiles.swap( m_paArena->vTiles );
+		}
+
+		// The "fmt " chunk may be WAVE_FORMAT_EXTENSIBLE, so the format of the samples is kept separately.
+		CWavFile::PW_FORMAT fFormat = CWavFile::OutputFormat( _psdSaveSettings );
+		CWavFile::PW_FMT_CHUNK fcChunk = _wfSource.CreateFmt( fFormat, _uiChannels, _psdSaveSettings );
+		if ( fFormat == CWavFile::PW_F_IEEE_FLOAT ) {
+			if ( fcChunk.uiBitsPerSample != 32 && fcChunk.uiBitsPerSample != 64 ) { return false; }
+		}
+		else if ( fcChunk.uiBitsPerSample != 8 && fcChunk.uiBitsPerSample != 16 &&
+			fcChunk.uiBitsPerSample != 24 && fcChunk.uiBitsPerSample != 32 ) { return false; }
+		m_uiChannels = _uiChannels;
+		m_uiBitsPerSample = fcChunk.uiBitsPerSample;
+		m_uiFormat = fFormat;
+
+		uint32_t uiFmtSize = fcChunk.chHeader.uiSize + 8;
+		// Formats other than PCM need a "fact" chunk holding the number of frames.
+		uint32_t uiFactSize = m_uiFormat != CWavFile::PW_F_PCM ? 12 : 0;
+
+		// Reserve room for a "ds64" chunk unless the output is known to fit in a RIFF file.
+		bool bReserveDs64 = true;
+		if ( _ui64ExpectedFrames != UINT64_MAX && fcChunk.uiBlockAlign && _ui64ExpectedFrames <= UINT32_MAX ) {
+			uint64_t ui64Size = 4 + uiFmtSize + uiFactSize + 8 + _ui64ExpectedFrames * fcChunk.uiBlockAlign;
+			try {
+				if ( _wfSource.m_vLoops.size() ) { ui64Size += _wfSource.CreateSmpl().size(); }
+				if ( _wfSource.m_vListEntries.size() ) { ui64Size += _wfSource.CreateList().size(); }
+				bReserveDs64 = ui64Size > UINT32_MAX;
+			}
+			catch ( ... ) { return false; }
+		}
+
+		try {
+			m_sPath = _pcPath;
+		}
+		catch ( ... ) { return false; }
+		if ( !m_sfFile.Create( _pcPath ) ) {
+			m_sPath.clear();
+			return false;
+		}
+
+		if ( !Write32( CWavFile::PW_C_RIFF ) ||
+			!Write32( 0 ) ||												// Patched by Finalize().
+			!Write32( CWavFile::PW_C_WAVE ) ) {
+			Discard();
+			return false;
+		}
+		if ( bReserveDs64 ) {
+			m_ui64Ds64Pos = m_sfFile.Tell();
+			const uint8_t ui8Zeros[PW_D_DS64_SIZE] = { 0 };
+			if ( !Write32( CWavFile::PW_C_JUNK ) ||
+				!Write32( static_cast<uint32_t>(PW_D_DS64_SIZE) ) ||
+				!m_sfFile.WriteToFile( ui8Zeros, sizeof( ui8Zeros ) ) ) {
+				Discard();
+				return false;
+			}
+		}
+		if ( !m_sfFile.WriteToFile( reinterpret_cast<const uint8_t *>(&fcChunk), uiFmtSize ) ) {
+			Discard();
+			return false;
+		}
+		if ( uiFactSize ) {
+			if ( !Write32( CWavFile::PW_C_FACT ) || !Write32( uiFactSize - 8 ) ) {
+				Discard();
+				return false;
+			}
+			m_ui64FactPos = m_sfFile.Tell();
+			if ( !Write32( 0 ) ) {											// Patched by Finalize().
+				Discard();
+				return false;
+			}
+		}
+		if ( _ui64MatchDataOffset != UINT64_MAX ) {
+			// Pad so that the samples (after a padding chunk header and the "data" header) line up with those of the source.
+			uint64_t ui64Pad = (_ui64MatchDataOffset % PW_D_CLONE_ALIGN + PW_D_CLONE_ALIGN - (m_sfFile.Tell() + 8) % PW_D_CLONE_ALIGN) % PW_D_CLONE_ALIGN;
+			if ( ui64Pad && ui64Pad < 8 ) { ui64Pad += PW_D_CLONE_ALIGN; }
+			if ( ui64Pad && !(ui64Pad & 1) ) {
+				std::vector<uint8_t> vZeros;
+				try {
+					vZeros.resize( size_t( ui64Pad - 8 ) );
+				}
+				catch ( ... ) {
+					Discard();
+					return false;
+				}
+				if ( !Write32( CWavFile::PW_C_JUNK ) ||
+					!Write32( static_cast<uint32_t>(vZeros.size()) ) ||
+					(vZeros.size() && !m_sfFile.WriteToFile( vZeros )) ) {
+					Discard();
+					return false;
+				}
+			}
+		}
+		if ( !Write32( CWavFile::PW_C_DATA ) ) {
+			Discard();
+			return false;
+		}
+		m_ui64DataSizePos = m_sfFile.Tell();
+		if ( !Write32( 0 ) ) {												// Patched by Finalize().
+			Discard();
+			return false;
+		}
+		m_pwfSource = &_wfSource;
+		return true;
+	}
+
+	/**
+	 * Encodes a range of frames and appends them to the "data" chunk.  If the source file passed to Create() has more than one
+	 *	thread set with CWavFile::SetThreads(), the range is encoded in tiles on that many threads.
+	 *
+	 * \param _vSamples The samples to encode.  Must have as many channels as were passed to Create().
+	 * \param _stFrom The index of the first frame to write.
+	 * \param _stTo The index of the frame after the last frame to write.
+	 * \return Returns true if the frames were encoded and written.
+	 */
+	bool CWavStreamWriter::WriteBlock( const CWavFile::lwaudio &_vSamples, size_t _stFrom, size_t _stTo ) {
+		return EncodeAndWrite( _vSamples, _stFrom, _stTo );
+	}
+
+	/**
+	 * Encodes a range of float frames and appends them to the "data" chunk.  If the source file passed to Create() has more than
+	 *	one thread set with CWavFile::SetThreads(), the range is encoded in tiles on that many threads.
+	 *
+	 * \param _vSamples The samples to encode.  Must have as many channels as were passed to Create().
+	 * \param _stFrom The index of the first frame to write.
+	 * \param _stTo The index of the frame after the last frame to write.
+	 * \return Returns true if the frames were encoded and written.
+	 */
+	bool CWavStreamWriter::WriteBlock( const CWavFile::lwaudiof &_vSamples, size_t _stFrom, size_t _stTo ) {
+		return EncodeAndWrite( _vSamples, _stFrom, _stTo );
+	}
+
+	/**
+	 * Encodes a range of planar frames and appends them to the "data" chunk.  If the source file passed to Create() has more than
+	 *	one thread set with CWavFile::SetThreads(), the range is encoded in tiles on that many threads.
+	 *
+	 * \param _bSamples The samples to encode.  Must have as many channels as were passed to Create().
+	 * \param _stFrom The index of the first frame to write.
+	 * \param _stTo The index of the frame after the last frame to write.
+	 * \return Returns true if the frames were encoded and written.
+	 */
+	bool CWavStreamWriter::WriteBlock( const CWavFile::lwblock &_bSamples, size_t _stFrom, size_t _stTo ) {
+		return EncodeAndWrite( _bSamples, _stFrom, _stTo );
+	}
+
+	/**
+	 * Encodes a range of planar float frames and appends them to the "data" chunk.  If the source file passed to Create() has more
+	 *	than one thread set with CWavFile::SetThreads(), the range is encoded in tiles on that many threads.
+	 *
+	 * \param _bSamples The samples to encode.  Must have as many channels as were passed to Create().
+	 * \param _stFrom The index of the first frame to write.
+	 * \param _stTo The index of the frame after the last frame to write.
+	 * \return Returns true if the frames were encoded and written.
+	 */
+	bool CWavStreamWriter::WriteBlock( const CWavFile::lwblockf &_bSamples, size_t _stFrom, size_t _stTo ) {
+		return EncodeAndWrite( _bSamples, _stFrom, _stTo );
+	}
+
+	/**
+	 * Appends already-encoded frames to the "data" chunk.  The bytes must be in the format written by Create().
+	 *
+	 * \param _pui8Data The encoded frames.
+	 * \param _stSize The number of bytes to which _pui8Data points.  Must be a whole number of frames.
+	 * \return Returns true if the frames were written.  On failure, the "data" chunk is left as it was.
+	 */
+	bool CWavStreamWriter::WriteRaw( const uint8_t * _pui8Data, size_t _stSize ) {
+		if ( nullptr == m_pwfSource ) { return false; }
+		size_t stFrameSize = size_t( m_uiChannels ) * (m_uiBitsPerSample / 8);
+		if ( _stSize % stFrameSize ) { return false; }
+		if ( !_stSize ) { return true; }
+		if ( !m_sfFile.WriteToFile( _pui8Data, _stSize ) ) {
+			m_sfFile.Seek( m_ui64DataSizePos + 4 + m_ui64DataSize );
+			return false;
+		}
+
+		m_ui64DataSize += _stSize;
+		m_ui64Frames += _stSize / stFrameSize;
+		return true;
+	}
+
+	/**
+	 * Appends already-encoded frames from a range of another file to the "data" chunk, letting the OS copy or clone the range
+	 *	without it passing through this process where possible.  The bytes must be in the format written by Create().
+	 *
+	 * \param _sfSrc The opened file containing the frames.
+	 * \param _ui64Offset The offset of the frames in _sfSrc.
+	 * \param _ui64Size The number of bytes to copy.  Must be a whole number of frames.
+	 * \return Returns true if the frames were copied.  On failure, the "data" chunk is left as it was.
+	 */
+	bool CWavStreamWriter::WriteRawFrom( CStdFile &_sfSrc, uint64_t _ui64Offset, uint64_t _ui64Size ) {
+		if ( nullptr == m_pwfSource ) { return false; }
+		uint64_t ui64FrameSize = uint64_t( m_uiChannels ) * (m_uiBitsPerSample / 8);
+		if ( _ui64Size % ui64FrameSize ) { return false; }
+		if ( !_ui64Size ) { return true; }
+		if ( !m_sfFile.CopyRangeFrom( _sfSrc, _ui64Offset, _ui64Size ) ) {
+			m_sfFile.Seek( m_ui64DataSizePos + 4 + m_ui64DataSize );
+			return false;
+		}
+
+		m_ui64DataSize += _ui64Size;
+		m_ui64Frames += _ui64Size / ui64FrameSize;
+		return true;
+	}
+
+	/**
+	 * Appends the "smpl" and "LIST" chunks, patches the "RIFF" and "data" sizes (switching to RF64 if needed), and closes the file.
+	 *
+	 * \return Returns true if the file was completed.  On failure the partial file is deleted.
+	 */
+	bool CWavStreamWriter::Finalize() {
+		if ( nullptr == m_pwfSource ) { return false; }
+		bool bRet = false;
+		try {
+			bRet = true;
+			// Append "smpl" chunk.
+			if ( bRet && m_pwfSource->m_vLoops.size() ) {
+				bRet = m_sfFile.WriteToFile( m_pwfSource->CreateSmpl() );
+			}
+
+			// Append "LIST" chunk.
+			if ( bRet && m_pwfSource->m_vListEntries.size() ) {
+				bRet = m_sfFile.WriteToFile( m_pwfSource->CreateList() );
+			}
+
+			// Patch the sizes.
+			uint64_t ui64RiffSize = m_sfFile.Tell() - 8;
+			if ( m_ui64DataSize <= UINT32_MAX && ui64RiffSize <= UINT32_MAX ) {
+				bRet = bRet &&
+					m_sfFile.Seek( 4 ) && Write32( static_cast<uint32_t>(ui64RiffSize) ) &&
+					m_sfFile.Seek( m_ui64DataSizePos ) && Write32( static_cast<uint32_t>(m_ui64DataSize) ) &&
+					(!m_ui64FactPos || (m_sfFile.Seek( m_ui64FactPos ) && Write32( static_cast<uint32_t>(m_ui64Frames) )));
+			}
+			else {
+				// Too large for RIFF; switch to RF64 and move the real sizes into the reserved "ds64" chunk.
+				bRet = bRet && m_ui64Ds64Pos &&
+					m_sfFile.Seek( 0 ) && Write32( CWavFile::PW_C_RF64 ) && Write32( 0xFFFFFFFF ) &&
+					m_sfFile.Seek( m_ui64Ds64Pos ) && Write32( CWavFile::PW_C_DS64 ) && Write32( static_cast<uint32_t>(PW_D_DS64_SIZE) ) &&
+					Write64( ui64RiffSize ) && Write64( m_ui64DataSize ) && Write64( m_ui64Frames ) && Write32( 0 ) &&
+					m_sfFile.Seek( m_ui64DataSizePos ) && Write32( 0xFFFFFFFF ) &&
+					(!m_ui64FactPos || (m_sfFile.Seek( m_ui64FactPos ) && Write32( 0xFFFFFFFF )));
+			}
+		}
+		catch ( ... ) { bRet = false; }
+		if ( !bRet ) {
+			Discard();
+			return false;
+		}
+		m_sfFile.Close();
+		m_sPath.clear();
+		m_pwfSource = nullptr;
+		return true;
+	}
+
+	/**
+	 * Encodes a range of frames in the output format and appends them to a buffer.
+	 *
+	 * \param _ppdSrc One pointer per channel to the samples to encode.  There must be as many channels as were passed to Create().
+	 * \param _stFrom The index of the first frame to encode.
+	 * \param _stTo The index of the frame after the last frame to encode.
+	 * \param _vDst The buffer to which to append the encoded frames.
+	 * \return Returns true if the frames were encoded.
+	 */
+	bool CWavStreamWriter::Encode( const double * const * _ppdSrc, size_t _stFrom, size_t _stTo, std::vector<uint8_t> &_vDst ) const {
+		if ( m_uiFormat == CWavFile::PW_F_IEEE_FLOAT ) {
+			switch ( m_uiBitsPerSample ) {
+				case 32 : {
+					return CWavFile::BatchF64ToFloat32( _ppdSrc, m_uiChannels, _stFrom, _stTo, _vDst );
+				}
+				case 64 : {
+					return CWavFile::BatchF64ToFloat64( _ppdSrc, m_uiChannels, _stFrom, _stTo, _vDst );
+				}
+			}
+			return false;
+		}
+		switch ( m_uiBitsPerSample ) {
+			case 8 : {
+				return CWavFile::BatchF64ToPcm8( _ppdSrc, m_uiChannels, _stFrom, _stTo, _vDst );
+			}
+			case 16 : {
+				return CWavFile::BatchF64ToPcm16( _ppdSrc, m_uiChannels, _stFrom, _stTo, _vDst );
+			}
+			case 24 : {
+				return CWavFile::BatchF64ToPcm24( _ppdSrc, m_uiChannels, _stFrom, _stTo, _vDst );
+			}
+			case 32 : {
+				return CWavFile::BatchF64ToPcm32( _ppdSrc, m_uiChannels, _stFrom, _stTo, _vDst );
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * Encodes a range of double or float frames and appends them to the "data" chunk, in tiles on multiple threads if the source
+	 *	file has them.
+	 *
+	 * \param _vSamples The samples to encode, an lwaudio_t or a CPlanarBuffer.  Must have as many channels as were passed to Create().
+	 * \param _stFrom The index of the first frame to write.
+	 * \param _stTo The index of the frame after the last frame to write.
+	 * \return Returns true if the frames were encoded and written.  On failure, the "data" chunk is left as it was.
+	 */
+	template <typename _tAudio>
+	bool CWavStreamWriter::EncodeAndWrite( const _tAudio &_vSamples, size_t _stFrom, size_t _stTo ) {
+		if ( nullptr == m_pwfSource || _vSamples.size() != m_uiChannels ) { return false; }
+		if ( _stFrom >= _stTo ) { return _stFrom == _stTo; }
+		for ( auto C = _vSamples.size(); C--; ) {
+			if ( _stTo > _vSamples[C].size() ) { return false; }
+		}
+		std::vector<const typename _tAudio::value_type::value_type *> vSrc;
+		try {
+			vSrc = CWavFile::ChannelData( _vSamples );
+		}
+		catch ( ... ) { return false; }
+
+		size_t stThreads = m_pwfSource->Threads();
+		uint64_t ui64DataSize = m_ui64DataSize;
+		// A short write leaves the file position past the bytes counted so far, so go back to the end of the "data" chunk.
+		auto WriteFailed = [&]() {
+			m_ui64DataSize = ui64DataSize;
+			m_sfFile.Seek( m_ui64DataSizePos + 4 + m_ui64DataSize );
+			return false;
+		};
+		if ( stThreads <= 1 || _stTo - _stFrom <= CWavFile::PW_D_TILE_FRAMES ) {
+			m_vBuffer.clear();
+			if ( !Encode( vSrc.data(), _stFrom, _stTo, m_vBuffer ) ) { return false; }
+			if ( !m_sfFile.WriteToFile( m_vBuffer ) ) { return WriteFailed(); }
+			m_ui64DataSize += m_vBuffer.size();
+		}
+		else {
+			// Encode the tiles in parallel, each into its own buffer, then write them in order.  PW_D_TILE_FRAMES is a multiple of the
+			//	vector width, so every sample takes the same vector or scalar path as it would if the block were encoded in one piece.
+			size_t stTiles = (_stTo - _stFrom + CWavFile::PW_D_TILE_FRAMES - 1) / CWavFile::PW_D_TILE_FRAMES;
+			try {
+				m_vTiles.resize( stTiles );
+			}
+			catch ( ... ) { return false; }
+			std::atomic<bool> aSuccess( true );
+			bool bRan = CUtilities::ParallelFor( stTiles, stThreads, [&]( size_t _stTile, size_t /*_stWorker*/ ) {
+				size_t stFrom = _stFrom + _stTile * CWavFile::PW_D_TILE_FRAMES;
+				m_vTiles[_stTile].clear();
+				if ( !Encode( vSrc.data(), stFrom, std::min<size_t>( stFrom + CWavFile::PW_D_TILE_FRAMES, _stTo ), m_vTiles[_stTile] ) ) { aSuccess = false; }
+			} );
+			if ( !bRan || !aSuccess ) { return false; }
+			for ( size_t I = 0; I < stTiles; ++I ) {
+				if ( !m_sfFile.WriteToFile( m_vTiles[I] ) ) { return WriteFailed(); }
+				m_ui64DataSize += m_vTiles[I].size();
+			}
+		}
+
+		m_ui64Frames += _stTo - _stFrom;
+		return true;
+	}
+
+	/**
+	 * Writes a 32-bit value to the file.
+	 *
+	 * \param _ui32Val The value to write.
+	 * \return Returns true if the value was written.
+	 */
+	bool CWavStreamWriter::Write32( uint32_t _ui32Val ) {
+		uint8_t ui8Bytes[4] = {
+			static_cast<uint8_t>(_ui32Val >> 0),
+			static_cast<uint8_t>(_ui32Val >> 8),
+			static_cast<uint8_t>(_ui32Val >> 16),
+			static_cast<uint8_t>(_ui32Val >> 24),
+		};
+		return m_sfFile.WriteToFile( ui8Bytes, sizeof( ui8Bytes ) );
+	}
+
+	/**
+	 * Closes the file and, if it was created but not finalized, deletes it so that no partial output is left behind.
+	 */
+	void CWavStreamWriter::Discard() {
+		m_sfFile.Close();
+		if ( m_sPath.size() ) {
+			CFileBase::RemoveFile( m_sPath.c_str() );
+			m_sPath.clear();
+		}
+		m_pwfSource = nullptr;
+	}
+
+	/**
+	 * Gives the buffers borrowed from the source file's arena back to it.
+	 */
+	void CWavStreamWriter::ReturnArena() {
+		if ( m_paArena ) {
+			m_vBuffer.swap( m_paArena->vBlock );
+			m_vTiles.swap( m_paArena->vTiles );
+			m_paArena = nullptr;
+		}
+	}
+
+}	// namespace pw
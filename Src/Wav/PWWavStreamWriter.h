@@ -0,0 +1,284 @@
+/**
+ * Copyright L. Spiro 2024
+ *
+ * Written by: Shawn (L. Spiro) Wilcoxen
+ *
+ * Description: Writes a PCM or IEEE float WAV file incrementally, one block of frames at a time.
+ */
+
+
+#pragma once
+
+#include "../Files/PWStdFile.h"
+#include "PWWavFile.h"
+
+
+namespace pw {
+
+	/**
+	 * Class CWavStreamWriter
+	 * \brief Writes a PCM or IEEE float WAV file incrementally, one block of frames at a time.
+	 *
+	 * Description: Writes a PCM or IEEE float WAV file incrementally, one block of frames at a time.  Create() emits the "RIFF"
+	 *	header, the "fmt " chunk, a "fact" chunk for float output, and a "data" header with a placeholder size.  Each WriteBlock()
+	 *	encodes its frames and appends them directly to the file, so only one encoded block is ever held in memory.  Finalize()
+	 *	appends the "smpl" and "LIST" chunks of the source file and then seeks back to patch the "RIFF" and "data" sizes and the
+	 *	"fact" frame count.
+	 *
+	 * If the output might exceed 4 gigabytes, Create() reserves a "JUNK" chunk after the "WAVE" tag, and Finalize() turns it into a
+	 *	"ds64" chunk and the file into RF64 if the sizes no longer fit in 32 bits.  Otherwise the output is a plain RIFF file.
+	 *
+	 * If Create() or Finalize() fails, or the writer is destroyed before Finalize() succeeds, the partial file is deleted rather than
+	 *	left at the output path with unpatched sizes.
+	 *
+	 * If the source file has an arena set with CWavFile::SetArena(), its encoding buffers are borrowed from Create() until the writer
+	 *	is destroyed, so that saving a batch of files does not allocate them anew for each file.
+	 */
+	class CWavStreamWriter {
+	public :
+		CWavStreamWriter();
+		~CWavStreamWriter();
+
+
+		// == Enumerations.
+		/** Defaults. */
+		enum PW_DEFAULTS : size_t {
+			PW_D_BLOCK_FRAMES											= 64 * 1024,			// Frames per block used by CWavFile::SaveAsPcm().
+			PW_D_DS64_SIZE												= 28,					// Size of a "ds64" chunk with no table, excluding its header.
+			PW_D_CLONE_ALIGN											= 4096,					// Block size assumed when lining up copied samples with their source.
+		};
+
+
+		// == Functions.
+		/**
+		 * Creates the file and writes the header.  The path is given in UTF-8.
+		 *
+		 * \param _pcPath The path to where the file will be saved.
+		 * \param _wfSource The file whose format and metadata will be written.  Must remain valid until Finalize() is called.
+		 * \param _uiChannels The number of channels to be written.
+		 * \param _psdSaveSettings Settings to override the source file's settings.
+		 * \param _ui64ExpectedFrames The number of frames that will be written, or UINT64_MAX if not known.  Only used to decide whether to
+		 *	reserve space for a "ds64" chunk.
+		 * \param _ui64MatchDataOffset If not UINT64_MAX, a "JUNK" chunk is added if needed so that the samples start at the same offset
+		 *	modulo PW_D_CLONE_ALIGN as this, which lets WriteRawFrom() clone whole blocks from a file whose samples start here.
+		 * \return Returns true if the file was created and the header was written.
+		 */
+		bool															Create( const char8_t * _pcPath, const CWavFile &_wfSource, uint16_t _uiChannels,
+			const CWavFile::PW_SAVE_DATA * _psdSaveSettings = nullptr, uint64_t _ui64ExpectedFrames = UINT64_MAX, uint64_t _ui64MatchDataOffset = UINT64_MAX );
+
+		/**
+		 * Creates the file and writes the header.  The path is given in UTF-16.
+		 *
+		 * \param _pcPath The path to where the file will be saved.
+		 * \param _wfSource The file whose format and metadata will be written.  Must remain valid until Finalize() is called.
+		 * \param _uiChannels The number of channels to be written.
+		 * \param _psdSaveSettings Settings to override the source file's settings.
+		 * \param _ui64ExpectedFrames The number of frames that will be written, or UINT64_MAX if not known.  Only used to decide whether to
+		 *	reserve space for a "ds64" chunk.
+		 * \param _ui64MatchDataOffset If not UINT64_MAX, a "JUNK" chunk is added if needed so that the samples start at the same offset
+		 *	modulo PW_D_CLONE_ALIGN as this, which lets WriteRawFrom() clone whole blocks from a file whose samples start here.
+		 * \return Returns true if the file was created and the header was written.
+		 */
+		bool															Create( const char16_t * _pcPath, const CWavFile &_wfSource, uint16_t _uiChannels,
+			const CWavFile::PW_SAVE_DATA * _psdSaveSettings = nullptr, uint64_t _ui64ExpectedFrames = UINT64_MAX, uint64_t _ui64MatchDataOffset = UINT64_MAX ) {
+			return Create( CUtilities::Utf16ToUtf8( _pcPath ).c_str(), _wfSource, _uiChannels, _psdSaveSettings, _ui64ExpectedFrames, _ui64MatchDataOffset );
+		}
+
+		/**
+		 * Encodes a range of frames and appends them to the "data" chunk.  If the source file passed to Create() has more than one
+		 *	thread set with CWavFile::SetThreads(), the range is encoded in tiles on that many threads.
+		 *
+		 * \param _vSamples The samples to encode.  Must have as many channels as were passed to Create().
+		 * \param _stFrom The index of the first frame to write.
+		 * \param _stTo The index of the frame after the last frame to write.
+		 * \return Returns true if the frames were encoded and written.
+		 */
+		bool															WriteBlock( const CWavFile::lwaudio &_vSamples, size_t _stFrom, size_t _stTo );
+
+		/**
+		 * Encodes all frames in the given buffer and appends them to the "data" chunk.
+		 *
+		 * \param _vSamples The samples to encode.  Must have as many channels as were passed to Create().
+		 * \return Returns true if the frames were encoded and written.
+		 */
+		bool															WriteBlock( const CWavFile::lwaudio &_vSamples ) {
+			return WriteBlock( _vSamples, 0, _vSamples.size() ? _vSamples[0].size() : 0 );
+		}
+
+		/**
+		 * Encodes a range of float frames and appends them to the "data" chunk.  If the source file passed to Create() has more than
+		 *	one thread set with CWavFile::SetThreads(), the range is encoded in tiles on that many threads.
+		 *
+		 * \param _vSamples The samples to encode.  Must have as many channels as were passed to Create().
+		 * \param _stFrom The index of the first frame to write.
+		 * \param _stTo The index of the frame after the last frame to write.
+		 * \return Returns true if the frames were encoded and written.
+		 */
+		bool															WriteBlock( const CWavFile::lwaudiof &_vSamples, size_t _stFrom, size_t _stTo );
+
+		/**
+		 * Encodes all float frames in the given buffer and appends them to the "data" chunk.
+		 *
+		 * \param _vSamples The samples to encode.  Must have as many channels as were passed to Create().
+		 * \return Returns true if the frames were encoded and written.
+		 */
+		bool															WriteBlock( const CWavFile::lwaudiof &_vSamples ) {
+			return WriteBlock( _vSamples, 0, _vSamples.size() ? _vSamples[0].size() : 0 );
+		}
+
+		/**
+		 * Encodes a range of planar frames and appends them to the "data" chunk.  If the source file passed to Create() has more than
+		 *	one thread set with CWavFile::SetThreads(), the range is encoded in tiles on that many threads.
+		 *
+		 * \param _bSamples The samples to encode.  Must have as many channels as were passed to Create().
+		 * \param _stFrom The index of the first frame to write.
+		 * \param _stTo The index of the frame after the last frame to write.
+		 * \return Returns true if the frames were encoded and written.
+		 */
+		bool															WriteBlock( const CWavFile::lwblock &_bSamples, size_t _stFrom, size_t _stTo );
+
+		/**
+		 * Encodes a range of planar float frames and appends them to the "data" chunk.  If the source file passed to Create() has more
+		 *	than one thread set with CWavFile::SetThreads(), the range is encoded in tiles on that many threads.
+		 *
+		 * \param _bSamples The samples to encode.  Must have as many channels as were passed to Create().
+		 * \param _stFrom The index of the first frame to write.
+		 * \param _stTo The index of the frame after the last frame to write.
+		 * \return Returns true if the frames were encoded and written.
+		 */
+		bool															WriteBlock( const CWavFile::lwblockf &_bSamples, size_t _stFrom, size_t _stTo );
+
+		/**
+		 * Appends already-encoded frames to the "data" chunk.  The bytes must be in the format written by Create().
+		 *
+		 * \param _pui8Data The encoded frames.
+		 * \param _stSize The number of bytes to which _pui8Data points.  Must be a whole number of frames.
+		 * \return Returns true if the frames were written.  On failure, the "data" chunk is left as it was.
+		 */
+		bool															WriteRaw( const uint8_t * _pui8Data, size_t _stSize );
+
+		/**
+		 * Appends already-encoded frames from a range of another file to the "data" chunk, letting the OS copy or clone the range
+		 *	without it passing through this process where possible.  The bytes must be in the format written by Create().
+		 *
+		 * \param _sfSrc The opened file containing the frames.
+		 * \param _ui64Offset The offset of the frames in _sfSrc.
+		 * \param _ui64Size The number of bytes to copy.  Must be a whole number of frames.
+		 * \return Returns true if the frames were copied.  On failure, the "data" chunk is left as it was.
+		 */
+		bool															WriteRawFrom( CStdFile &_sfSrc, uint64_t _ui64Offset, uint64_t _ui64Size );
+
+		/**
+		 * Appends the "smpl" and "LIST" chunks, patches the "RIFF" and "data" sizes (switching to RF64 if needed), and closes the file.
+		 *
+		 * \return Returns true if the file was completed.  On failure the partial file is deleted.
+		 */
+		bool															Finalize();
+
+		/**
+		 * Gets the number of frames written so far.
+		 *
+		 * \return Returns the number of frames written so far.
+		 */
+		inline uint64_t													Frames() const { return m_ui64Frames; }
+
+
+	protected :
+		// == Members.
+		/** The file being written. */
+		CStdFile														m_sfFile;
+		/** The path of the file being written, or empty once it has been finalized or discarded. */
+		std::u8string													m_sPath;
+		/** The file providing the metadata. */
+		const CWavFile *												m_pwfSource;
+		/** The encoded block, kept between calls to avoid reallocating. */
+		std::vector<uint8_t>											m_vBuffer;
+		/** The encoded tiles of a block when encoding on multiple threads, kept between calls to avoid reallocating. */
+		std::vector<std::vector<uint8_t>>								m_vTiles;
+		/** The arena of the source file whose vBlock and vTiles are swapped into m_vBuffer and m_vTiles until it is returned, or nullptr. */
+		CWavFile::PW_ARENA *											m_paArena;
+		/** The position of the reserved "JUNK" chunk, or 0 if none was reserved. */
+		uint64_t														m_ui64Ds64Pos;
+		/** The position of the "fact" chunk's frame count, or 0 if there is no "fact" chunk. */
+		uint64_t														m_ui64FactPos;
+		/** The position of the "data" chunk's size field. */
+		uint64_t														m_ui64DataSizePos;
+		/** The number of bytes written to the "data" chunk. */
+		uint64_t														m_ui64DataSize;
+		/** The number of frames written. */
+		uint64_t														m_ui64Frames;
+		/** The number of channels being written. */
+		uint16_t														m_uiChannels;
+		/** The bits per sample being written. */
+		uint16_t														m_uiBitsPerSample;
+		/** The format of the samples being written, which is the sub-format of a WAVE_FORMAT_EXTENSIBLE "fmt " chunk. */
+		uint16_t														m_uiFormat;
+
+
+		// == Functions.
+		/**
+		 * Encodes a range of frames in the output format and appends them to a buffer.
+		 *
+		 * \param _ppdSrc One pointer per channel to the samples to encode.  There must be as many channels as were passed to Create().
+		 * \param _stFrom The index of the first frame to encode.
+		 * \param _stTo The index of the frame after the last frame to encode.
+		 * \param _vDst The buffer to which to append the encoded frames.
+		 * \return Returns true if the frames were encoded.
+		 */
+		bool															Encode( const double * const * _ppdSrc, size_t _stFrom, size_t _stTo, std::vector<uint8_t> &_vDst ) const;
+
+		/**
+		 * Encodes a range of float frames in the output format and appends them to a buffer.
+		 *
+		 * \param _ppfSrc One pointer per channel to the samples to encode.  There must be as many channels as were passed to Create().
+		 * \param _stFrom The index of the first frame to encode.
+		 * \param _stTo The index of the frame after the last frame to encode.
+		 * \param _vDst The buffer to which to append the encoded frames.
+		 * \return Returns true if the frames were encoded.
+		 */
+		bool															Encode( const float * const * _ppfSrc, size_t _stFrom, size_t _stTo, std::vector<uint8_t> &_vDst ) const {
+			return CWavFile::BatchF32Encode( _ppfSrc, m_uiChannels, _stFrom, _stTo, static_cast<CWavFile::PW_FORMAT>(m_uiFormat), m_uiBitsPerSample, _vDst );
+		}
+
+		/**
+		 * Encodes a range of double or float frames and appends them to the "data" chunk, in tiles on multiple threads if the source
+		 *	file has them.
+		 *
+		 * \param _vSamples The samples to encode, an lwaudio_t or a CPlanarBuffer.  Must have as many channels as were passed to Create().
+		 * \param _stFrom The index of the first frame to write.
+		 * \param _stTo The index of the frame after the last frame to write.
+		 * \return Returns true if the frames were encoded and written.  On failure, the "data" chunk is left as it was.
+		 */
+		template <typename _tAudio>
+		bool															EncodeAndWrite( const _tAudio &_vSamples, size_t _stFrom, size_t _stTo );
+
+		/**
+		 * Writes a 32-bit value to the file.
+		 *
+		 * \param _ui32Val The value to write.
+		 * \return Returns true if the value was written.
+		 */
+		bool															Write32( uint32_t _ui32Val );
+
+		/**
+		 * Closes the file and, if it was created but not finalized, deletes it so that no partial output is left behind.
+		 */
+		void															Discard();
+
+		/**
+		 * Gives the buffers borrowed from the source file's arena back to it.
+		 */
+		void															ReturnArena();
+
+		/**
+		 * Writes a 64-bit value to the file.
+		 *
+		 * \param _ui64Val The value to write.
+		 * \return Returns true if the value was written.
+		 */
+		bool															Write64( uint64_t _ui64Val ) {
+			return Write32( static_cast<uint32_t>(_ui64Val) ) && Write32( static_cast<uint32_t>(_ui64Val >> 32) );
+		}
+	};
+
+}	// namespace pw